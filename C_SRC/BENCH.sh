@@ -0,0 +1,306 @@
+#!/bin/sh
+
+######################################################################
+#
+# BENCH.SH - Benchmark the Stream Commands Compiled by MAKE.sh
+#
+# USAGE   : BENCH.sh [options]
+# Options : -d dir ..... Directory where the compiled commands are
+#                        (default: the directory MAKE.sh is in)
+#                        If you set it as a relative path, the base
+#                        directory of the relative path is regarded as
+#                        the directory which BENCH.sh is in.
+#           -t cmds .... Commands to benchmark, separated by ","
+#                        (default: valve,qvalve,oobleck,relval,tscat,
+#                         linets)
+#           -n lines ... Number of lines for the throughput tests
+#                        (default: 200000)
+#           -l bytes ... Length of each line including the LF
+#                        (default: 80)
+#           -r rate .... Lines per second for the timing tests
+#                        (default: 1000)
+#           -s secs .... Duration in seconds of each timing test
+#                        (default: 2)
+#           -f fmt ..... Timestamp format of the lines given to tscat
+#                        and relval. "c" (calendar-time), "e" (UNIX-
+#                        epoch time) or "z" (seconds since start)
+#                        (default: z)
+# Output  : One line for each test to the stdout as follows.
+#           * Throughput tests (the input from a regular file and from
+#             a pipe):
+#               thru <cmd> <file|pipe> <lines> <bytes> <secs> <MB/s>
+#                    <lines/s> <CPU-secs>
+#           * Timing tests (valve and tscat only):
+#               late <cmd> <lines> <mean> <p50> <p90> <p99> <max>
+#             The numbers of the timing tests are the lateness in
+#             microseconds of each line arriving, compared with the
+#             ideal schedule. The schedule is anchored at the line which
+#             arrived the earliest relative to it, so the lateness is
+#             never negative.
+#           The line which starts with "#" is a comment.
+# Ret     : $?=0 (when all of the tests finished)
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+######################################################################
+
+
+######################################################################
+# Initial Configuration
+######################################################################
+
+# === Initialize shell environment ===================================
+set -u
+umask 0022
+export LC_ALL=C
+type command >/dev/null 2>&1 && type getconf >/dev/null 2>&1 &&
+export PATH="$(command -p getconf PATH)${PATH+:}${PATH-}"
+export POSIXLY_CORRECT=1 # to make Linux comply with POSIX
+export UNIX_STD=2003     # to make HP-UX comply with POSIX
+
+# === Define the functions for printing usage and error message ======
+print_usage_and_exit () {
+  cat <<-USAGE 1>&2
+	Usage   : ${0##*/} [options]
+	Options : -d dir ..... Directory where the compiled commands are
+	                       (default: the directory MAKE.sh is in)
+	          -t cmds .... Commands to benchmark, separated by ","
+	                       (default: valve,qvalve,oobleck,relval,tscat,
+	                        linets)
+	          -n lines ... Number of lines for the throughput tests
+	                       (default: 200000)
+	          -l bytes ... Length of each line including the LF
+	                       (default: 80)
+	          -r rate .... Lines per second for the timing tests
+	                       (default: 1000)
+	          -s secs .... Duration in seconds of each timing test
+	                       (default: 2)
+	          -f fmt ..... Timestamp format of the lines given to tscat
+	                       and relval (c, e or z, default: z)
+	Version : 2026-10-18 19:40:12 JST
+	USAGE
+  exit 1
+}
+error_exit() {
+  ${2+:} false && echo "${0##*/}: $2" 1>&2
+  exit $1
+}
+exit_trap() {
+  set -- ${1:-} $?  # $? is set as $1 if no argument given
+  trap '' EXIT HUP INT QUIT PIPE ALRM TERM
+  [ -d "${Tmp:-}" ] && rm -rf "$Tmp"
+  trap - EXIT HUP INT QUIT PIPE ALRM TERM
+  exit $1
+}
+
+# === Get my directory path ==========================================
+Homedir=$(d=${0%/*}/; [ "_$d" = "_$0/" ] && d='./'; cd "$d"; pwd)
+
+# === Define the other parameters ====================================
+ALLCMDS='valve,qvalve,oobleck,relval,tscat,linets'
+
+
+
+######################################################################
+# Parse arguments
+######################################################################
+
+# === Get the options ================================================
+# --- initialize option parameters -----------------------------------
+Dir_bin=$Homedir
+Cmds=$ALLCMDS
+Lines=200000
+Linelen=80
+Rate=1000
+Secs=2
+Fmt=z
+#
+# --- get them -------------------------------------------------------
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -[dtnlrsf])  [ $# -ge 2 ] || print_usage_and_exit
+                 opt=${1#-}; s=$2; shift 2                      ;;
+    -[dtnlrsf]*) opt=${1#-}; s=${opt#?}; opt=${opt%"$s"}; shift ;;
+    -*)          print_usage_and_exit                           ;;
+    *)           print_usage_and_exit                           ;;
+  esac
+  case "$opt" in
+    d) case "$s" in /*) Dir_bin=${s%/};; *) Dir_bin=$Homedir/${s%/};; esac
+       [ -d "$Dir_bin" ] || error_exit 1 'Invalid directory by -d option' ;;
+    t) printf '%s\n' "$s" | grep -Eq '^[a-z]+(,[a-z]+)*$' || {
+         error_exit 1 'Invalid command list by -t option'
+       }
+       Cmds=$s                                                            ;;
+    n) printf '%s\n' "$s" | grep -q '^[1-9][0-9]*$' || {
+         error_exit 1 'Invalid number by -n option'
+       }
+       Lines=$s                                                           ;;
+    l) printf '%s\n' "$s" | grep -q '^[1-9][0-9]*$' || {
+         error_exit 1 'Invalid number by -l option'
+       }
+       [ "$s" -ge 32 ] || error_exit 1 'Too short line length by -l option'
+       Linelen=$s                                                         ;;
+    r) printf '%s\n' "$s" | grep -q '^[1-9][0-9]*$' || {
+         error_exit 1 'Invalid number by -r option'
+       }
+       Rate=$s                                                            ;;
+    s) printf '%s\n' "$s" | grep -q '^[1-9][0-9]*$' || {
+         error_exit 1 'Invalid number by -s option'
+       }
+       Secs=$s                                                            ;;
+    f) case "$s" in [cez]) Fmt=$s;; *) print_usage_and_exit;; esac        ;;
+  esac
+done
+
+
+
+######################################################################
+# Functions
+######################################################################
+
+# === Print the current UNIX-time with nanoseconds ===================
+# (linets is used because "date +%N" is not in POSIX)
+now() {
+  echo | "$Dir_bin/linets" -e9 | awk '{print $1}'
+}
+
+# === Generate the lines for the benchmarks ==========================
+# [in] $1 : number of lines
+#      $2 : length of each line including the LF
+#      $3 : timestamp format (""(none), "c", "e" or "z")
+#      $4 : interval between the timestamps in nanoseconds
+gen_lines() {
+  awk -v n="$1" -v len="$2" -v fmt="$3" -v ns="$4" '
+    BEGIN {
+      pad = ""; for (i=0; i<len; i++) {pad = pad "x";}
+      for (k=0; k<n; k++) {
+        t = k*ns; s = int(t/1000000000); d = t - s*1000000000;
+        if      (fmt == "c") {ts = sprintf("20240101%02d%02d%02d.%09d ",
+                                           int(s/3600)%24, int(s/60)%60,
+                                           s%60, d                      );}
+        else if (fmt == "e") {ts = sprintf("%d.%09d ", 1700000000+s, d); }
+        else if (fmt == "z") {ts = sprintf("%d.%09d ", s, d);            }
+        else                 {ts = "";                                   }
+        body = sprintf("%s%d ", ts, k);
+        if (length(body) < len-1) {body = body substr(pad,1,len-1-length(body));}
+        print body;
+      }
+    }'
+}
+
+# === Run a throughput test ==========================================
+# [in] $1 : label (command name)
+#      $2 : input file
+#      $3- : command line to run
+run_thru() {
+  label=$1; infile=$2; cmd=$3; shift 3
+  set -- "$Dir_bin/$cmd" "$@"
+  nl=$(wc -l < "$infile" | tr -d ' ')
+  nb=$(wc -c < "$infile" | tr -d ' ')
+  for mode in file pipe; do
+    t0=$(now)
+    case $mode in
+      file) cpu=$( ("$@" "$infile" >/dev/null 2>&1; times) | sed -n '2p');;
+      pipe) cpu=$( (cat "$infile" | "$@" >/dev/null 2>&1; times) |
+                   sed -n '2p'                                          );;
+    esac
+    t1=$(now)
+    echo "$label $mode $nl $nb $t0 $t1 $cpu" |
+    awk '{ sec = $6 - $5; if (sec <= 0) {sec = 1e-9;}
+           cpu = 0;
+           for (i=7; i<=8; i++) {
+             split($i, a, "m"); sub(/s$/, "", a[2]); cpu += a[1]*60 + a[2];
+           }
+           printf("thru %s %s %d %d %.3f %.2f %.0f %.3f\n",
+                  $1, $2, $3, $4, sec, $4/sec/1000000, $3/sec, cpu); }'
+  done
+}
+
+# === Run a timing test ==============================================
+# [in] $1 : label (command name)
+#      $2 : interval of the ideal schedule in nanoseconds
+#      $3 : input file
+#      $4- : command line to run
+run_late() {
+  label=$1; ns=$2; infile=$3; cmd=$4; shift 4
+  set -- "$Dir_bin/$cmd" "$@"
+  "$@" "$infile" 2>/dev/null | "$Dir_bin/linets" -e9 > "$Tmp/late"
+  awk -v ns="$ns" '
+    { split($1, a, ".");
+      if (NR == 1) {s0 = a[1]; n0 = a[2];}
+      printf("%.3f\n", ((a[1]-s0)*1000000000+(a[2]-n0)-(NR-1)*ns)/1000); }
+  ' "$Tmp/late"                                                         |
+  sort -n                                                               |
+  awk -v label="$label" '
+    { v[NR] = $1; }
+    END {
+      if (NR == 0) {print "# " label ": no output"; exit;}
+      for (i=NR; i>=1; i--) {v[i] -= v[1]; sum += v[i];}
+      printf("late %s %d %.1f %.1f %.1f %.1f %.1f\n", label, NR, sum/NR,
+             v[int(NR*0.50)+(NR*0.50>int(NR*0.50))],
+             v[int(NR*0.90)+(NR*0.90>int(NR*0.90))],
+             v[int(NR*0.99)+(NR*0.99>int(NR*0.99))], v[NR]            );
+    }'
+}
+
+
+
+######################################################################
+# Main
+######################################################################
+
+# === Check the commands =============================================
+[ -x "$Dir_bin/linets" ] || {
+  error_exit 1 "$Dir_bin/linets: Not found. Run MAKE.sh first."
+}
+for cmd in $(echo "$Cmds" | tr ',' ' '); do
+  case ",$ALLCMDS," in *",$cmd,"*) :;; *)
+    error_exit 1 "$cmd: Not a command to benchmark"
+  ;; esac
+  [ -x "$Dir_bin/$cmd" ] || error_exit 1 "$Dir_bin/$cmd: Not found"
+done
+
+# === Make the temporary files =======================================
+trap 'exit_trap' EXIT HUP INT QUIT PIPE ALRM TERM
+Tmp=$(mktemp -d 2>/dev/null) || Tmp=${TMPDIR:-/tmp}/${0##*/}.$$
+[ -d "$Tmp" ] || mkdir -m 700 "$Tmp" || error_exit 1 "Can't make a tmp dir"
+Ns=$((1000000000/Rate))
+Late_n=$((Rate*Secs))
+gen_lines "$Lines"  "$Linelen" ''     0     > "$Tmp/plain"
+gen_lines "$Lines"  "$Linelen" "$Fmt" 0     > "$Tmp/ts0"
+gen_lines "$Lines"  "$Linelen" "$Fmt" 1000  > "$Tmp/ts1us"
+gen_lines "$Late_n" "$Linelen" "$Fmt" "$Ns" > "$Tmp/tsrate"
+gen_lines "$Late_n" "$Linelen" ''     0     > "$Tmp/plainrate"
+
+# === Run the tests ==================================================
+echo "# lines=$Lines linelen=$Linelen rate=$Rate secs=$Secs fmt=$Fmt"
+echo "# thru cmd mode lines bytes secs MB/s lines/s cpu-secs"
+echo "# late cmd lines mean-us p50-us p90-us p99-us max-us"
+for cmd in $(echo "$Cmds" | tr ',' ' '); do
+  case $cmd in
+    valve)   run_thru valve   "$Tmp/plain" valve -l 100%
+             run_late valve   "$Ns" "$Tmp/plainrate" valve -l "${Ns}ns"  ;;
+    qvalve)  run_thru qvalve  "$Tmp/plain" qvalve -l "$Lines"            ;;
+    oobleck) run_thru oobleck "$Tmp/plain" oobleck 0%                    ;;
+    relval)  run_thru relval  "$Tmp/ts1us" relval -"$Fmt" 1ns            ;;
+    tscat)   run_thru tscat   "$Tmp/ts0"   tscat -"$Fmt"Z
+             run_late tscat   "$Ns" "$Tmp/tsrate" tscat -"$Fmt"Z         ;;
+    linets)  run_thru linets  "$Tmp/plain" linets -c9                    ;;
+  esac
+done
+
+
+
+######################################################################
+# Finish
+######################################################################
+
+exit 0
@@ -0,0 +1,57 @@
+/*####################################################################
+#
+# FPBUF.H - Peek at the Read Buffer of a stdio Stream
+#
+# USAGE   : #include "fpbuf.h"
+#           (in the "headers" section of a command's source file)
+# Provides: FP_HAS_RBUF(fp) ... Non-zero if the buffer of the stream for
+#                               reading still has data which the command
+#                               has not taken yet
+# Note    : * It looks into the private members of the FILE structure,
+#             because POSIX has no way to know it. The members are known
+#             only for glibc and the BSD stdio (FreeBSD, NetBSD and macOS).
+#           * On the other C libraries, it is always 0 (unknown). So, the
+#             caller MUST regard 0 as "maybe empty" and still work right
+#             then, just less efficiently (e.g. valve gives up its mmap()
+#             path, and oobleck waits by pselect() as it used to).
+#           * Keep this the only copy. Don't copy it into the commands.
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+#ifndef FPBUF_H
+#define FPBUF_H
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <stdio.h>
+
+/*--- macro functions ----------------------------------------------*/
+/* Does the stdio buffer for reading still have data? (0 if unknown) */
+#if defined(__GLIBC__)
+  #define FP_HAS_RBUF(fp) ((fp)->_IO_read_ptr < (fp)->_IO_read_end)
+#elif defined(__FreeBSD__) || defined(__NetBSD__) || defined(__APPLE__)
+  #define FP_HAS_RBUF(fp) ((fp)->_r > 0)
+#else
+  #define FP_HAS_RBUF(fp) 0
+#endif
+
+
+
+#endif /* FPBUF_H */
@@ -3,6 +3,7 @@
 # GETFILETS - Get Timestamps of Each File
 #
 # USAGE   : getftimes [options] file [file [...]]
+#           getftimes [options] -0
 # Options : -9 ... Prints the timestamps to the nanosecond if supported
 #           -c ... Prints the timestamps in Calendar-time (YYYYMMDDhhmmss)
 #                  in yout timezone (default)
@@ -10,6 +11,14 @@
 #           -I ... Prints the timestamps in ISO8601 format
 #           -u ... Set the date in UTC when -c option is set
 #                  (same as that of date command)
+#           -0 ... Read the NUL-delimited filenames from STDIN instead of
+#                  the arguments (e.g. "find . -print0 | getfilets -0")
+#           -r ... Walk down the directories recursively. The files in
+#                  a directory are printed after the directory itself.
+#                  Symbolic links to directories are not followed.
+#           -j n . Get the timestamps by <n> threads in parallel. The
+#                  results are still printed in the order of the input.
+#                  It is effective on network-backed storages.
 #           -- ... Finishes parsing arguments as options
 # Output  : * Print the following 4 fields by each file
 #             <atime> <mtime> <ctime> <filename>
@@ -19,9 +28,9 @@
 # Retuen  : Return 0 only when timestamps of all files were able to be
 #           gotten.
 #
-# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-04-15
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -42,7 +51,19 @@
 
 /*--- macro constants ----------------------------------------------*/
 #define _POSIX_C_SOURCE 200809L
+#if defined(__linux) || defined(__linux__)
+  #define _GNU_SOURCE /* for statx() */
+#endif
+/* Number of the entries which can be in process at the same time */
+#define RING_SIZ    4096
+/* Number of the formatted seconds to be cached */
+#define TSCACHE_NUM 16
+/* Maximum number of the threads */
+#define THREAD_MAX  256
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -51,14 +72,54 @@
 #include <time.h>
 #include <unistd.h>
 
+/*--- data type definitions ----------------------------------------*/
+typedef struct _fentry_t {
+  char*           pszPath;   /* filepath (malloc()ed)                  */
+  int             iStatus;   /* 0:not yet, 1:succeeded, 2:failed       */
+  time_t          tSec[3];   /* atime, mtime, ctime (second part)      */
+  long            lNsec[3];  /* atime, mtime, ctime (nanosecond part)  */
+} fentry_t;
+typedef struct _pool_t {
+  pthread_mutex_t mu;        /* The mutex variable                     */
+  pthread_cond_t  coWork;    /* Signaled when an entry has been queued */
+  pthread_cond_t  coDone;    /* Signaled when an entry has been done   */
+  fentry_t        aEnt[RING_SIZ]; /* Ring buffer of the entries        */
+  long            lHead;     /* The entry to be printed next           */
+  long            lNext;     /* The entry to be stat()ed next          */
+  long            lTail;     /* The position to be queued next         */
+  int             iFinish;   /* Set 1 when no more entry will come     */
+} pool_t;
+typedef struct _tscache_t {
+  time_t          tSec;      /* The second which has been formatted    */
+  int             iValid;    /* 1 if the szStr is valid                */
+  char            szStr[256];/* The formatted string of the tSec       */
+} tscache_t;
+
+/*--- prototype functions ------------------------------------------*/
+void  queue_entry(char *pszPath);
+void  print_done_entries(int iWait);
+void* stat_worker(void *pvArgs);
+int   get_timestamps(fentry_t *pstEnt);
+void  print_entry(fentry_t *pstEnt);
+char* format_time(time_t tSec, long lNsec, char *pszBuf);
+void  walk_dir(char *pszDir);
+
 /*--- global variables ---------------------------------------------*/
 char* gpszCmdname;
 int   giVerbose;     /* speaks more verbosely by the greater number */
+int   giNanosec;     /* "in nanosec" flag                           */
+int   giNerror;      /* The number of error to get timestamps       */
+int   giThreads;     /* The number of the stat() threads (0:serial) */
+char  gszFmt[256];   /* format for strftime()                       */
+char  gszDummy[256]; /* format for the files failed to stat()       */
+pool_t    gstPool;                /* The pool for the stat() threads*/
+tscache_t gstTscache[TSCACHE_NUM];/* Cache of the formatted seconds */
 
 /*=== Define the functions for printing usage and error ============*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
     "Usage   : %s [options] file [file [...]]\n"
+    "          %s [options] -0\n"
     "Options : -9 ... Prints the timestamps to the nanosecond if supported\n"
     "          -c ... Prints the timestamps in Calendar-time (YYYYMMDDhhmmss)\n"
     "                 in yout timezone (default)\n"
@@ -66,6 +127,14 @@ void print_usage_and_exit(void) {
     "          -I ... Prints the timestamps in ISO8601 format\n"
     "          -u ... Set the date in UTC when -c option is set\n"
     "                 (same as that of date command)\n"
+    "          -0 ... Read the NUL-delimited filenames from STDIN instead of\n"
+    "                 the arguments (e.g. \"find . -print0 | getfilets -0\")\n"
+    "          -r ... Walk down the directories recursively. The files in\n"
+    "                 a directory are printed after the directory itself.\n"
+    "                 Symbolic links to directories are not followed.\n"
+    "          -j n . Get the timestamps by <n> threads in parallel. The\n"
+    "                 results are still printed in the order of the input.\n"
+    "                 It is effective on network-backed storages.\n"
     "          -- ... Finishes parsing arguments as options\n"
     "Output  : * Print the following 4 fields by each file\n"
     "            <atime> <mtime> <ctime> <filename>\n"
@@ -74,7 +143,7 @@ void print_usage_and_exit(void) {
     "          * The latter format is set by -l option.\n"
     "Retuen  : Return 0 only when timestamps of all files were able to be\n"
     "          gotten. \n"
-    "Version : 2025-04-15 14:50:13 JST\n"
+    "Version : 2026-10-18 20:11:05 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -82,7 +151,7 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/tokideli\n"
-    ,gpszCmdname);
+    ,gpszCmdname,gpszCmdname);
   exit(1);
 }
 void error_exit(int iErrno, const char* szFormat, ...) {
@@ -111,18 +180,19 @@ void warning(const char* szFormat, ...) {
 int main(int argc, char *argv[]) {
 
 /*--- Variables ----------------------------------------------------*/
-struct stat stFileinfo;
-struct tm*  pstTm;
-char        szBuf[256];
-char        szAtim[256], szMtim[256], szCtim[256], szFmt[256], szDummy[256];
+pthread_t   tThid[THREAD_MAX]; /* IDs of the stat() threads */
+char*       pszLine;     /* a line (NUL-terminated) read from STDIN */
+size_t      sizLine;     /* size of the buffer of pszLine */
 int         iFmttype;    /* Long option switch */
-int         iNanosec;    /* "in nanosec" flag */
+int         iOpt_0;      /* -0 option flag */
+int         iOpt_r;      /* -r option flag */
 int         i;           /* It means the argument position */
-int         iNerror = 0; /* The number of error to get timestamps */
+char*       psz;         /* all-purpose char* */
 
 /*--- Initialize ---------------------------------------------------*/
 gpszCmdname = argv[0];
 giVerbose   = 0;
+giNerror    = 0;
 for (i=0; *(gpszCmdname+i)!='\0'; i++) {
   if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
 }
@@ -133,16 +203,25 @@ if (setenv("POSIXLY_CORRECT","1",1) < 0) {
 /*=== Parse options ================================================*/
 
 /*--- Set default parameters of the arguments ----------------------*/
-iFmttype = 0; /* 0:YYYYMMDDhhmmss 1:UnixTime 2:ISO8601 */
-iNanosec = 0; /* 0:second only 1:nanosecond */
+iFmttype  = 0; /* 0:YYYYMMDDhhmmss 1:UnixTime 2:ISO8601 */
+giNanosec = 0; /* 0:second only 1:nanosecond */
+giThreads = 0; /* 0:serial */
+iOpt_0    = 0;
+iOpt_r    = 0;
 
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "9cehIuv")) != -1) {
+while ((i=getopt(argc, argv, "09cehIj:ruv")) != -1) {
   switch (i) {
-    case '9': iNanosec = 1;                 break;
-    case 'c': iFmttype = 0;                 break;
-    case 'e': iFmttype = 1;                 break;
-    case 'I': iFmttype = 2;                 break;
+    case '0': iOpt_0    = 1;                break;
+    case '9': giNanosec = 1;                break;
+    case 'c': iFmttype  = 0;                break;
+    case 'e': iFmttype  = 1;                break;
+    case 'I': iFmttype  = 2;                break;
+    case 'j': if (sscanf(optarg,"%d",&giThreads) != 1) {print_usage_and_exit();}
+              if (giThreads<1 || giThreads>THREAD_MAX ) {print_usage_and_exit();}
+              if (giThreads==1) {giThreads=0;}
+                                            break;
+    case 'r': iOpt_r    = 1;                break;
     case 'u': (void)setenv("TZ", "UTC", 1); break;
     case 'v': giVerbose++;                  break;
     case 'h': print_usage_and_exit();
@@ -153,84 +232,354 @@ argc -= optind;
 argv += optind;
 
 /*--- print the usage if no filename has given ---------------------*/
-if (argc < 1) { print_usage_and_exit(); }
+if (iOpt_0==0 && argc <  1) { print_usage_and_exit(); }
+if (iOpt_0==1 && argc >= 1) { print_usage_and_exit(); }
 
 /*--- Warn if use "-9" option on nanosecond timestamp non-supported OS */
 #ifndef st_atime
-if (iNanosec) {
+if (giNanosec) {
   warning("Warning: This OS does't support the nanosec timestamp\n");
 }
 #endif
 
 /*=== Swtich to the long format mode if -l option has been set =====*/
-switch (iFmttype*2+iNanosec) {
-  case  0*2+0: strcpy(szFmt  ,"%Y%m%d%H%M%S"              );
-               strcpy(szDummy,"%-14s %-14s %-14s "        );
+switch (iFmttype*2+giNanosec) {
+  case  0*2+0: strcpy(gszFmt  ,"%Y%m%d%H%M%S"              );
+               strcpy(gszDummy,"%-14s %-14s %-14s "        );
                break;
-  case  0*2+1: strcpy(szFmt  ,"%Y%m%d%H%M%S.%%09ld"       );
-               strcpy(szDummy,"%-24s %-24s %-24s "        );
+  case  0*2+1: strcpy(gszFmt  ,"%Y%m%d%H%M%S.%%09ld"       );
+               strcpy(gszDummy,"%-24s %-24s %-24s "        );
                break;
-  case  1*2+0: strcpy(szFmt  ,"%s"                        );
-               strcpy(szDummy,"%-10s %-10s %-10s "        );
+  case  1*2+0: strcpy(gszFmt  ,"%s"                        );
+               strcpy(gszDummy,"%-10s %-10s %-10s "        );
                break;
-  case  1*2+1: strcpy(szFmt  ,"%s.%%09ld"                 );
-               strcpy(szDummy,"%-20s %-20s %-20s "        );
+  case  1*2+1: strcpy(gszFmt  ,"%s.%%09ld"                 );
+               strcpy(gszDummy,"%-20s %-20s %-20s "        );
                break;
-  case  2*2+0: strcpy(szFmt  ,"%Y-%m-%dT%H:%M:%S%z"       );
-               strcpy(szDummy,"%-24s %-24s %-24s "        );
+  case  2*2+0: strcpy(gszFmt  ,"%Y-%m-%dT%H:%M:%S%z"       );
+               strcpy(gszDummy,"%-24s %-24s %-24s "        );
                break;
-  case  2*2+1: strcpy(szFmt  ,"%Y-%m-%dT%H:%M:%S,%%09ld%z");
-               strcpy(szDummy,"%-34s %-34s %-34s "        );
+  case  2*2+1: strcpy(gszFmt  ,"%Y-%m-%dT%H:%M:%S,%%09ld%z");
+               strcpy(gszDummy,"%-34s %-34s %-34s "        );
                break;
   default: error_exit(1, "Unexpected Error!\n");
 }
 
+/*=== Start the stat() threads if required =========================*/
+if (giThreads > 0) {
+  memset(&gstPool, 0, sizeof(gstPool));
+  if ((i=pthread_mutex_init(&gstPool.mu    , NULL)) != 0) {
+    error_exit(i,"pthread_mutex_init(): %s\n", strerror(i));
+  }
+  if ((i=pthread_cond_init( &gstPool.coWork, NULL)) != 0) {
+    error_exit(i,"pthread_cond_init() #1: %s\n", strerror(i));
+  }
+  if ((i=pthread_cond_init( &gstPool.coDone, NULL)) != 0) {
+    error_exit(i,"pthread_cond_init() #2: %s\n", strerror(i));
+  }
+  for (i=0; i<giThreads; i++) {
+    if ((errno=pthread_create(&tThid[i], NULL, &stat_worker, NULL)) != 0) {
+      error_exit(errno,"pthread_create(): %s\n", strerror(errno));
+    }
+  }
+  if (giVerbose>0) {warning("%d threads started\n", giThreads);}
+}
+
 /*=== Main loop ====================================================*/
-for (i=0; i<argc; i++) {
-  if (stat(argv[i],&stFileinfo)==0) {
-    if (!iNanosec) {
-      pstTm = localtime(&stFileinfo.st_atime);
-      strftime(szAtim, 256, szFmt, pstTm);
-      pstTm = localtime(&stFileinfo.st_mtime);
-      strftime(szMtim, 256, szFmt, pstTm);
-      pstTm = localtime(&stFileinfo.st_ctime);
-      strftime(szCtim, 256, szFmt, pstTm);
-      printf("%s %s %s ",szAtim,szMtim,szCtim);
-    } else         {
-      pstTm = localtime(&stFileinfo.st_atime);
-      strftime(szBuf, 256, szFmt, pstTm);
-      #ifdef st_atime
-        sprintf(szAtim, szBuf, stFileinfo.st_atim.tv_nsec);
-      #else
-        sprintf(szAtim, szBuf,                          0);
-      #endif
-      pstTm = localtime(&stFileinfo.st_mtime);
-      strftime(szBuf, 256, szFmt, pstTm);
-      #ifdef st_mtime
-        sprintf(szMtim, szBuf, stFileinfo.st_mtim.tv_nsec);
-      #else
-        sprintf(szMtim, szBuf,                          0);
-      #endif
-      pstTm = localtime(&stFileinfo.st_ctime);
-      strftime(szBuf, 256, szFmt, pstTm);
-      #ifdef st_ctime
-        sprintf(szCtim, szBuf, stFileinfo.st_ctim.tv_nsec);
-      #else
-        sprintf(szCtim, szBuf,                          0);
-      #endif
-      printf("%s %s %s ",szAtim,szMtim,szCtim);
+if (iOpt_0 == 0) {
+  /*--- from the arguments -----------------------------------------*/
+  for (i=0; i<argc; i++) {
+    if ((psz=strdup(argv[i])) == NULL) {
+      error_exit(errno,"strdup(): %s\n", strerror(errno));
     }
-  } else {
-    if (giVerbose>0) {warning("%s: Failed to get its timestamp\n",argv[i]);}
-    iNerror++;
-    printf(szDummy, "-", "-", "-");
+    queue_entry(psz);
+    if (iOpt_r) {walk_dir(argv[i]);}
+  }
+} else           {
+  /*--- from STDIN (NUL-delimited) ---------------------------------*/
+  pszLine = NULL;
+  sizLine = 0;
+  while (getdelim(&pszLine, &sizLine, '\0', stdin) > 0) {
+    if (pszLine[0] == '\0') {continue;}
+    if ((psz=strdup(pszLine)) == NULL) {
+      error_exit(errno,"strdup(): %s\n", strerror(errno));
+    }
+    queue_entry(psz);
+    if (iOpt_r) {walk_dir(pszLine);}
   }
-  printf("%s\n",argv[i]);
+  if (ferror(stdin)) {error_exit(errno,"getdelim(): %s\n", strerror(errno));}
+  free(pszLine);
+}
+
+/*=== Wait for the stat() threads to finish ========================*/
+if (giThreads > 0) {
+  pthread_mutex_lock(&gstPool.mu);
+  gstPool.iFinish = 1;
+  pthread_cond_broadcast(&gstPool.coWork);
+  pthread_mutex_unlock(&gstPool.mu);
+  print_done_entries(2);
+  for (i=0; i<giThreads; i++) {pthread_join(tThid[i], NULL);}
 }
 
 /*=== Finish =======================================================*/
-if (iNerror>0) {
-  warning("Warning: Couldn't get timestamps of 1 file(s).\n",iNerror);
+if (giNerror>0) {
+  warning("Warning: Couldn't get timestamps of %d file(s).\n",giNerror);
   return 1;
 }
 return 0;}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Queue an entry to get its timestamps ===========================
+ * In the serial mode, the timestamps are gotten and printed at once.
+ * Otherwise, the entry is queued into the ring buffer for the stat()
+ * threads, and the done entries at the head are printed.
+ * [in]  pszPath : Filepath (malloc()ed, and will be free()d by me)  */
+void queue_entry(char *pszPath) {
+
+  /*--- Variables --------------------------------------------------*/
+  fentry_t  stEnt;
+  fentry_t* pstEnt;
+
+  /*--- Serial mode ------------------------------------------------*/
+  if (giThreads == 0) {
+    stEnt.pszPath = pszPath;
+    stEnt.iStatus = get_timestamps(&stEnt);
+    print_entry(&stEnt);
+    free(pszPath);
+    return;
+  }
+
+  /*--- Parallel mode ----------------------------------------------*/
+  /* Make a room in the ring buffer if it is full */
+  if (gstPool.lTail-gstPool.lHead >= RING_SIZ) {print_done_entries(1);}
+  pthread_mutex_lock(&gstPool.mu);
+  pstEnt          = &gstPool.aEnt[gstPool.lTail % RING_SIZ];
+  pstEnt->pszPath = pszPath;
+  pstEnt->iStatus = 0;
+  gstPool.lTail++;
+  pthread_cond_signal(&gstPool.coWork);
+  pthread_mutex_unlock(&gstPool.mu);
+  /* Print the entries already done to keep streaming */
+  print_done_entries(0);
+}
+
+/*=== Print the entries at the head of the ring buffer which are done
+ * [in]  iWait : 0 : Print only the entries already done
+ *               1 : Wait for at least one entry to be done
+ *               2 : Wait for all the entries to be done             */
+void print_done_entries(int iWait) {
+
+  /*--- Variables --------------------------------------------------*/
+  fentry_t* pstEnt;
+
+  /*--- Print the entries in order ---------------------------------*/
+  while (gstPool.lHead < gstPool.lTail) {
+    pstEnt = &gstPool.aEnt[gstPool.lHead % RING_SIZ];
+    pthread_mutex_lock(&gstPool.mu);
+    while (pstEnt->iStatus == 0) {
+      if (iWait == 0) {pthread_mutex_unlock(&gstPool.mu); return;}
+      pthread_cond_wait(&gstPool.coDone, &gstPool.mu);
+    }
+    pthread_mutex_unlock(&gstPool.mu);
+    print_entry(pstEnt);
+    free(pstEnt->pszPath); pstEnt->pszPath=NULL;
+    gstPool.lHead++;
+    if (iWait == 1) {iWait=0;}
+  }
+}
+
+/*=== THREAD : Get the timestamps of the queued entries ============*/
+void* stat_worker(void *pvArgs) {
+
+  /*--- Variables --------------------------------------------------*/
+  fentry_t* pstEnt;
+  int       iStatus;
+
+  /*--- Main loop --------------------------------------------------*/
+  pthread_mutex_lock(&gstPool.mu);
+  while (1) {
+    while (gstPool.lNext >= gstPool.lTail) {
+      if (gstPool.iFinish) {pthread_mutex_unlock(&gstPool.mu); return NULL;}
+      pthread_cond_wait(&gstPool.coWork, &gstPool.mu);
+    }
+    pstEnt = &gstPool.aEnt[gstPool.lNext % RING_SIZ];
+    gstPool.lNext++;
+    pthread_mutex_unlock(&gstPool.mu);
+    iStatus = get_timestamps(pstEnt);
+    pthread_mutex_lock(&gstPool.mu);
+    pstEnt->iStatus = iStatus;
+    pthread_cond_signal(&gstPool.coDone);
+  }
+}
+
+/*=== Get the timestamps of the entry ================================
+ * statx() is used if available because it can request only the time-
+ * stamps, which saves the work of network filesystems.
+ * [in]  pstEnt->pszPath : Filepath
+ * [out] pstEnt->tSec[], lNsec[] : The timestamps
+ * [ret] 1 : succeeded
+ *       2 : failed                                                 */
+int get_timestamps(fentry_t *pstEnt) {
+
+  /*--- Variables --------------------------------------------------*/
+#ifdef STATX_MTIME
+  struct statx stx;
+#else
+  struct stat  stFileinfo;
+#endif
+  int          iStatus;
+
+#ifdef STATX_MTIME
+  /*--- Get them by statx() ----------------------------------------*/
+  if (statx(AT_FDCWD, pstEnt->pszPath, 0,
+            STATX_ATIME|STATX_MTIME|STATX_CTIME, &stx) == 0) {
+    pstEnt->tSec[0]=stx.stx_atime.tv_sec; pstEnt->lNsec[0]=stx.stx_atime.tv_nsec;
+    pstEnt->tSec[1]=stx.stx_mtime.tv_sec; pstEnt->lNsec[1]=stx.stx_mtime.tv_nsec;
+    pstEnt->tSec[2]=stx.stx_ctime.tv_sec; pstEnt->lNsec[2]=stx.stx_ctime.tv_nsec;
+    iStatus = 1;
+  } else {
+    iStatus = 2;
+  }
+#else
+  /*--- Get them by stat() -----------------------------------------*/
+  if (stat(pstEnt->pszPath,&stFileinfo)==0) {
+    pstEnt->tSec[0]=stFileinfo.st_atime;
+    pstEnt->tSec[1]=stFileinfo.st_mtime;
+    pstEnt->tSec[2]=stFileinfo.st_ctime;
+    #ifdef st_atime
+      pstEnt->lNsec[0]=stFileinfo.st_atim.tv_nsec;
+    #else
+      pstEnt->lNsec[0]=0;
+    #endif
+    #ifdef st_mtime
+      pstEnt->lNsec[1]=stFileinfo.st_mtim.tv_nsec;
+    #else
+      pstEnt->lNsec[1]=0;
+    #endif
+    #ifdef st_ctime
+      pstEnt->lNsec[2]=stFileinfo.st_ctim.tv_nsec;
+    #else
+      pstEnt->lNsec[2]=0;
+    #endif
+    iStatus = 1;
+  } else {
+    iStatus = 2;
+  }
+#endif
+  return iStatus;
+}
+
+/*=== Print the timestamps of the entry ============================*/
+void print_entry(fentry_t *pstEnt) {
+
+  /*--- Variables --------------------------------------------------*/
+  char szAtim[256], szMtim[256], szCtim[256];
+
+  /*--- Print ------------------------------------------------------*/
+  if (pstEnt->iStatus == 1) {
+    printf("%s %s %s ",
+           format_time(pstEnt->tSec[0], pstEnt->lNsec[0], szAtim),
+           format_time(pstEnt->tSec[1], pstEnt->lNsec[1], szMtim),
+           format_time(pstEnt->tSec[2], pstEnt->lNsec[2], szCtim) );
+  } else {
+    if (giVerbose>0) {
+      warning("%s: Failed to get its timestamp\n",pstEnt->pszPath);
+    }
+    giNerror++;
+    printf(gszDummy, "-", "-", "-");
+  }
+  printf("%s\n",pstEnt->pszPath);
+}
+
+/*=== Format a timestamp =============================================
+ * The result of localtime() and strftime() is cached for each second,
+ * and the cache is shared by atime, mtime and ctime because they are
+ * often in the same second.
+ * [in]  tSec, lNsec : The timestamp
+ * [out] pszBuf      : The formatted string (256 bytes are required)
+ * [ret] pszBuf                                                     */
+char* format_time(time_t tSec, long lNsec, char *pszBuf) {
+
+  /*--- Variables --------------------------------------------------*/
+  tscache_t* pstC;
+  struct tm* pstTm;
+
+  /*--- Look up the cache, and format the second part if missed ----*/
+  pstC = &gstTscache[(unsigned long)tSec % TSCACHE_NUM];
+  if (!pstC->iValid || pstC->tSec!=tSec) {
+    if ((pstTm=localtime(&tSec)) == NULL) {
+      error_exit(255,"localtime(): returned NULL\n");
+    }
+    strftime(pstC->szStr, 256, gszFmt, pstTm);
+    pstC->tSec   = tSec;
+    pstC->iValid = 1;
+  }
+
+  /*--- Attach the nanosecond part if required ---------------------*/
+  if (giNanosec) {sprintf(pszBuf, pstC->szStr, lNsec);}
+  else           {strcpy( pszBuf, pstC->szStr       );}
+  return pszBuf;
+}
+
+/*=== Walk down the directory and queue the entries in it ============
+ * [in]  pszDir : Path of the directory (nothing is done if it is not a
+ *                directory)                                        */
+void walk_dir(char *pszDir) {
+
+  /*--- Variables --------------------------------------------------*/
+  DIR*           pDir;
+  struct dirent* pstDe;
+  struct stat    stFileinfo;
+  char*          pszPath;
+  char*          psz;
+  size_t         sizDir;
+  int            iIsDir;
+
+  /*--- Open the directory -----------------------------------------*/
+  if ((pDir=opendir(pszDir)) == NULL) {
+    if (errno!=ENOTDIR && giVerbose>0) {
+      warning("%s: %s\n", pszDir, strerror(errno));
+    }
+    return;
+  }
+  sizDir = strlen(pszDir);
+
+  /*--- Queue every entry, and walk down the subdirectories --------*/
+  while ((pstDe=readdir(pDir)) != NULL) {
+    if (strcmp(pstDe->d_name,".")==0 || strcmp(pstDe->d_name,"..")==0) {
+      continue;
+    }
+    if ((pszPath=malloc(sizDir+strlen(pstDe->d_name)+2)) == NULL) {
+      error_exit(errno,"malloc(): %s\n", strerror(errno));
+    }
+    strcpy(pszPath, pszDir);
+    if (sizDir==0 || pszDir[sizDir-1]!='/') {strcat(pszPath, "/");}
+    strcat(pszPath, pstDe->d_name);
+    /* Know whether it is a directory without stat() if possible */
+    #ifdef DT_DIR
+      if (pstDe->d_type != DT_UNKNOWN) {
+        iIsDir = (pstDe->d_type==DT_DIR);
+      } else {
+        iIsDir = (lstat(pszPath,&stFileinfo)==0 && S_ISDIR(stFileinfo.st_mode));
+      }
+    #else
+      iIsDir = (lstat(pszPath,&stFileinfo)==0 && S_ISDIR(stFileinfo.st_mode));
+    #endif
+    if (iIsDir) {
+      if ((psz=strdup(pszPath)) == NULL) {
+        error_exit(errno,"strdup(): %s\n", strerror(errno));
+      }
+      queue_entry(psz);
+      walk_dir(pszPath);
+      free(pszPath);
+    } else {
+      queue_entry(pszPath);
+    }
+  }
+  closedir(pDir);
+}
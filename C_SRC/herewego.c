@@ -102,6 +102,14 @@
 #                        3: Strongest realtime process of this host
 #                       Larger numbers maybe require a privileged user,
 #                       but if failed, it will try the smaller numbers.
+#           -L ........ Lock the memory of this command into the RAM
+#                       after pre-faulting the stack, so that no page
+#                       fault delays it in the realtime mode. A large
+#                       enough "ulimit -l" or a privileged user might
+#                       be required.
+#           -C cpu .... Run this command only on the CPU #cpu (from 0)
+#                       to avoid the migration between CPUs. (for only
+#                       Linux) An isolated CPU gives the best result.
 # Retuen  : Return 0 only when finished successfully
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -DCLOCK_NANOSLEEP_SUPPORT
@@ -112,7 +120,7 @@
 #                  (if it doesn't work)
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
 #
-# Written Shell-Shoccar Japan (@shellshoccarjpn) on 2025-06-06
+# Written Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -133,6 +141,9 @@
 /*=== Initial Setting ==============================================*/
 
 /*--- headers ------------------------------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  #define _GNU_SOURCE /* for sched_setaffinity() */
+#endif
 #include <errno.h>
 #include <limits.h>
 #include <locale.h>
@@ -141,6 +152,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include "timeio.h"
+#include "rtmem.h"
 #include <unistd.h>
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
   #include <sched.h>
@@ -191,6 +204,8 @@ int giFmtType   = 'c'; /* 'c':calendar-time (default)
                       'e':UNIX-epoch-time                           */
 int giVerbose   =  0 ; /* speaks more verbosely by the greater number   */
 int giPrio      =  1 ; /* -p option number (default 1)                  */
+int giCpu       = -1 ; /* -C option number (-1:not pinned)              */
+int giMlock     =  0 ; /* 1 if -L option is given                       */
 
 /*=== Define the functions for printing usage and error ============*/
 
@@ -293,10 +308,18 @@ void print_usage_and_exit(void) {
     "                       3: Strongest realtime process of this host\n"
     "                      Larger numbers maybe require a privileged user,\n"
     "                      but if failed, it will try the smaller numbers.\n"
+    "          -L ........ Lock the memory of this command into the RAM\n"
+    "                      after pre-faulting the stack, so that no page\n"
+    "                      fault delays it in the realtime mode. A large\n"
+    "                      enough \"ulimit -l\" or a privileged user might\n"
+    "                      be required.\n"
+    "          -C cpu .... Run this command only on the CPU #cpu (from 0)\n"
+    "                      to avoid the migration between CPUs. (for only\n"
+    "                      Linux) An isolated CPU gives the best result.\n"
 #endif
     "Retuen  : Return 0 only when finished successfully\n"
     "\n"
-    "Version : 2025-06-06 13:22:47 JST\n"
+    "Version : 2026-10-18 23:03:18 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -351,7 +374,6 @@ struct tm* ptm;             /* a pointer of "tm" structure        */
 char       szTs[LINE_BUF];  /* timestamp to be reported           */
 char       szTim[72];       /* timestamp (year - sec)             */
 char       szDec[21];       /* timestamp (under sec)              */
-char       szTmz[ 7];       /* timestamp (timezone)               */
 
 /*--- Initialize ---------------------------------------------------*/
 if (clock_gettime(CLOCK_REALTIME,&tsT0) != 0) {
@@ -369,7 +391,7 @@ setlocale(LC_CTYPE, "");
 /*=== Parse arguments ==============================================*/
 
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "0369ceIp:uvh")) != -1) {
+while ((i=getopt(argc, argv, "0369ceIp:LC:uvh")) != -1) {
   switch (i) {
     case '0': giTimeResol =  0 ;            break;
     case '3': giTimeResol =  3 ;            break;
@@ -381,6 +403,10 @@ while ((i=getopt(argc, argv, "0369ceIp:uvh")) != -1) {
     #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
       case 'p': if (sscanf(optarg,"%d",&giPrio) != 1) {print_usage_and_exit();}
                                               break;
+      case 'L': giMlock=1;                    break;
+      case 'C': if (sscanf(optarg,"%d",&giCpu) != 1) {print_usage_and_exit();}
+                if (giCpu < 0                       ) {print_usage_and_exit();}
+                                              break;
     #endif
     case 'u': (void)setenv("TZ", "UTC", 1); break;
     case 'v': giVerbose++;                  break;
@@ -431,6 +457,8 @@ if ((gi8Prem>0) && (gi8Intv<=gi8Prem)) {
 
 /*=== Try to make me a realtime process ============================*/
 if (change_to_rtprocess(giPrio)==-1) {print_usage_and_exit();}
+if (giCpu >= 0) {rtmem_pin_cpu(giCpu);}
+if (giMlock   ) {rtmem_lock();        }
 
 /*=== Calculate the time this command should exit ==================*/
 tsadd(tsT0,gi8Mini);
@@ -464,11 +492,9 @@ switch (giFmtType) {
               default: snprintf(szDec,21,".%09ld",tsRep.tv_nsec        );
                        break;
             }
-            ptm = localtime(&tsRep.tv_sec);
-            if (ptm==NULL) {error_exit(255,"localtime(): returned NULL\n");}
-            snprintf(szTs , LINE_BUF, "%04d%02d%02d%02d%02d%02d%s",
-              ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday,
-              ptm->tm_hour     , ptm->tm_min  , ptm->tm_sec , szDec);
+            if (sprint_calendartime(szTs, tsRep.tv_sec, szDec) < 0) {
+              error_exit(255,"localtime(): returned NULL\n");
+            }
             break;
   case 'e':
             switch (giTimeResol) {
@@ -509,14 +535,9 @@ switch (giFmtType) {
               default: snprintf(szDec,21,",%09ld",tsRep.tv_nsec        );
                        break;
             }
-            ptm = localtime(&tsRep.tv_sec);
-            if (ptm==NULL) {error_exit(255,"localtime(): returned NULL\n");}
-            snprintf(szTim, 72, "%04d-%02d-%02dT%02d:%02d:%02d",
-              ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday,
-              ptm->tm_hour     , ptm->tm_min  , ptm->tm_sec  );
-            strftime(szTmz, 6, "%z", ptm);
-            szTmz[6]=0; szTmz[5]=szTmz[4]; szTmz[4]=szTmz[3]; szTmz[3]=':';
-            snprintf(szTs , LINE_BUF, "%s%s%s", szTim, szDec, szTmz);
+            if (sprint_iso8601time(szTs, tsRep.tv_sec, szDec) < 0) {
+              error_exit(255,"localtime(): returned NULL\n");
+            }
             break;
   default : error_exit(255,"Unknown \"giFmtType\"\n");
 }
@@ -47,13 +47,18 @@
 #                       be attatched when using this option.
 #           -u ........ Set the date in UTC when -c option is set
 #                       (same as that of date command)
+# Note    : The relative times (-z, -Z, and the delta-t of -d) are
+#           measured on the monotonic clock, and only the absolute ones
+#           (-c, -e, -I) are read from the system clock. So, a step or
+#           slew of the system clock by NTP etc. never makes them
+#           negative or huge.
 # Retuen  : Return 0 only when finished successfully
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
 #                  (if it doesn't work)
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-04-20
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -83,6 +88,7 @@
 #include <stdarg.h>
 #include <unistd.h>
 #include <time.h>
+#include "timeio.h"
 
 /*--- macro constants ----------------------------------------------*/
 /* Buffer size for a timestamp string */
@@ -111,8 +117,8 @@ int   giFmtType   = 'c'; /* 'c':calendar-time (default)
 int   giTimeResol =  0 ; /* 0:second(def) 3:millisec 6:microsec 9:nanosec */
 int   giDeltaMode =  0 ; /* attach the number of seconds since printing
                             the previous line after the timestamp when >0 */
-tmsp  gtsZero     = {0}; /* Time this command booted                      */
-tmsp  gtsPrev     = {0}; /* Time the previous line has come (-gtsZero)    */
+tmsp  gtsZero     = {0}; /* Time this command booted (CLOCK_MONOTONIC)    */
+tmsp  gtsPrev     = {0}; /* Time the previous line has come (ditto)       */
 int   giHold      =  0 ; /* for read_1line(): 1 if next character exists  */
 int   giNextchar       ; /* for read_1line(): the next character          */
 
@@ -161,8 +167,13 @@ void print_usage_and_exit(void) {
     "                      be attatched when using this option.\n"
     "          -u ........ Set the date in UTC when -c option is set\n"
     "                      (same as that of date command)\n"
+    "Note    : The relative times (-z, -Z, and the delta-t of -d) are\n"
+    "          measured on the monotonic clock, and only the absolute ones\n"
+    "          (-c, -e, -I) are read from the system clock. So, a step or\n"
+    "          slew of the system clock by NTP etc. never makes them\n"
+    "          negative or huge.\n"
     "Retuen  : Return 0 only when finished successfully\n"
-    "Version : 2025-04-20 23:07:12 JST\n"
+    "Version : 2026-10-18 23:11:46 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -215,7 +226,7 @@ int      iFirstline='c';  /* >0 when x-opt and no line come yet     */
 int      i;               /* all-purpose int                        */
 
 /*--- Initialize ---------------------------------------------------*/
-if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+if (clock_gettime(CLOCK_MONOTONIC,&gtsZero) != 0) {
   error_exit(errno,"clock_gettime() at initialize: %s\n",strerror(errno));
 }
 gpszCmdname = argv[0];
@@ -387,6 +398,10 @@ int read_c1st_1line(FILE *fp) {
     error_exit(errno,"read_c1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
+  if (giDeltaMode && clock_gettime(CLOCK_MONOTONIC,&gtsPrev)!=0) {
+    error_exit(errno,"read_c1st_1line(): clock_gettime() #2: %s\n",
+                     strerror(errno)                               );
+  }
   if ((ptm=localtime(&tsNow.tv_sec)) == NULL) {
     error_exit(255,"read_c1st_1line(): localtime(): returned NULL\n");
   }
@@ -408,10 +423,7 @@ int read_c1st_1line(FILE *fp) {
                      tsNow.tv_nsec                            ); break;
     default: error_exit(255,"read_e1st_1line(): Unknown resolution\n");
   }
-  if (giDeltaMode) {
-    printf("0 ");
-    gtsPrev.tv_sec=tsNow.tv_sec; gtsPrev.tv_nsec=tsNow.tv_nsec;
-  }
+  if (giDeltaMode) {printf("0 ");}
   while (putchar(iChar)==EOF) {
     if (errno == EINTR) {continue;}
     error_exit(errno,"read_c1st_1line(): putchar() #1: %s\n",strerror(errno));
@@ -459,6 +471,10 @@ int read_e1st_1line(FILE *fp) {
     error_exit(errno,"read_e1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
+  if (giDeltaMode && clock_gettime(CLOCK_MONOTONIC,&gtsPrev)!=0) {
+    error_exit(errno,"read_e1st_1line(): clock_gettime() #2: %s\n",
+                     strerror(errno)                               );
+  }
   switch (giTimeResol) {
     case 0 : printf("%jd "      ,(intmax_t)tsNow.tv_sec             ); break;
     case 3 : printf("%jd.%03d " ,(intmax_t)tsNow.tv_sec,
@@ -469,10 +485,7 @@ int read_e1st_1line(FILE *fp) {
                                        tsNow.tv_nsec                ); break;
     default: error_exit(255,"read_e1st_1line(): Unknown resolution\n");
   }
-  if (giDeltaMode) {
-    printf("0 ");
-    gtsPrev.tv_sec=tsNow.tv_sec; gtsPrev.tv_nsec=tsNow.tv_nsec;
-  }
+  if (giDeltaMode) {printf("0 ");}
   while (putchar(iChar)==EOF) {
     if (errno == EINTR) {continue;}
     error_exit(errno,"read_e1st_1line(): putchar() #1: %s\n",strerror(errno));
@@ -522,6 +535,10 @@ int read_I1st_1line(FILE *fp) {
     error_exit(errno,"read_I1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
+  if (giDeltaMode && clock_gettime(CLOCK_MONOTONIC,&gtsPrev)!=0) {
+    error_exit(errno,"read_I1st_1line(): clock_gettime() #2: %s\n",
+                     strerror(errno)                               );
+  }
   if ((ptm=localtime(&tsNow.tv_sec)) == NULL) {
     error_exit(255,"read_I1st_1line(): localtime(): returned NULL\n");
   }
@@ -546,10 +563,7 @@ int read_I1st_1line(FILE *fp) {
                      tsNow.tv_nsec                , szTmz     ); break;
     default: error_exit(255,"read_e1st_1line(): Unknown resolution\n");
   }
-  if (giDeltaMode) {
-    printf("0 ");
-    gtsPrev.tv_sec=tsNow.tv_sec; gtsPrev.tv_nsec=tsNow.tv_nsec;
-  }
+  if (giDeltaMode) {printf("0 ");}
   while (putchar(iChar)==EOF) {
     if (errno == EINTR) {continue;}
     error_exit(errno,"read_I1st_1line(): putchar() #1: %s\n",strerror(errno));
@@ -592,7 +606,7 @@ int read_Z1st_1line(FILE *fp) {
   /*--- Reading and writing a line (1st letter of the line) --------*/
   if (giHold) {iChar=giNextchar; giHold=0;} else {iChar=getc(fp);}
   if (iChar == EOF) {return(EOF);}
-  if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+  if (clock_gettime(CLOCK_MONOTONIC,&gtsZero) != 0) {
     error_exit(errno,"read_Z1st_1line(): clock_gettime(): %s\n",
                      strerror(errno)                            );
   }
@@ -630,6 +644,9 @@ int read_Z1st_1line(FILE *fp) {
 
 
 /*=== Write the current timestamp to stdout ==========================
+ * The absolute time is read from CLOCK_REALTIME and the relative ones
+ * from CLOCK_MONOTONIC. When both are required, they are sampled
+ * back-to-back as a pair.
  * [in] giFmtType   : (must be defined as a global variable)
  *      giTimeResol : (must be defined as a global variable)
  *      giDeltaMode : (must be defined as a global variable)
@@ -638,18 +655,22 @@ int read_Z1st_1line(FILE *fp) {
 void print_cur_timestamp(void) {
 
   /*--- Variables --------------------------------------------------*/
-  tmsp        tsNow          ; /* Current time but substructed by gtsZero */
+  tmsp        tsNow          ; /* Current time (CLOCK_REALTIME)           */
+  tmsp        tsMono         ; /* Current time (CLOCK_MONOTONIC)          */
   tmsp        tsDiff         ;
   tmsp        ts             ;
   struct tm  *ptm            ;
   char        szBuf[LINE_BUF];
   char        szDec[21]      ; /* for the Decimal part */
-  char        szTmz[ 7]      ; /* timestamp (timezone) */
 
   /*--- Get the current time ---------------------------------------*/
-  if (clock_gettime(CLOCK_REALTIME,&tsNow) != 0) {
+  if (giFmtType!='z' && clock_gettime(CLOCK_REALTIME,&tsNow)!=0) {
     error_exit(errno,"clock_gettime()#1: %s\n",strerror(errno));
   }
+  if ((giFmtType=='z' || giDeltaMode) &&
+      clock_gettime(CLOCK_MONOTONIC,&tsMono)!=0) {
+    error_exit(errno,"clock_gettime()#2: %s\n",strerror(errno));
+  }
 
   /*--- Print the current timestamp --------------------------------*/
   switch (giFmtType) {
@@ -668,11 +689,10 @@ void print_cur_timestamp(void) {
                 default: snprintf(szDec,21,".%09ld",ts.tv_nsec        );
                          break;
               }
-              ptm = localtime(&ts.tv_sec);
-              if (ptm==NULL) {error_exit(255,"localtime(): returned NULL\n");}
-              printf("%04d%02d%02d%02d%02d%02d%s ",
-                ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday,
-                ptm->tm_hour     , ptm->tm_min  , ptm->tm_sec , szDec);
+              if (sprint_calendartime(szBuf, ts.tv_sec, szDec) < 0) {
+                error_exit(255,"localtime(): returned NULL\n");
+              }
+              printf("%s ", szBuf);
               break;
     case 'I':
               ts.tv_sec=tsNow.tv_sec; ts.tv_nsec=tsNow.tv_nsec;
@@ -689,13 +709,10 @@ void print_cur_timestamp(void) {
                 default: snprintf(szDec,21,",%09ld",ts.tv_nsec        );
                          break;
               }
-              ptm = localtime(&ts.tv_sec);
-              if (ptm==NULL) {error_exit(255,"localtime(): returned NULL\n");}
-              strftime(szTmz, 6, "%z", ptm);
-              szTmz[6]=0; szTmz[5]=szTmz[4]; szTmz[4]=szTmz[3]; szTmz[3]=':';
-              printf("%04d-%02d-%02dT%02d:%02d:%02d%s%s ",
-                ptm->tm_year+1900, ptm->tm_mon+1, ptm->tm_mday,
-                ptm->tm_hour     , ptm->tm_min  , ptm->tm_sec , szDec, szTmz);
+              if (sprint_iso8601time(szBuf, ts.tv_sec, szDec) < 0) {
+                error_exit(255,"localtime(): returned NULL\n");
+              }
+              printf("%s ", szBuf);
               break;
     case 'e':
               ts.tv_sec=tsNow.tv_sec; ts.tv_nsec=tsNow.tv_nsec;
@@ -717,12 +734,12 @@ void print_cur_timestamp(void) {
               printf("%s%s ", szBuf, szDec);
               break;
     case 'z':
-              if ((tsNow.tv_nsec - gtsZero.tv_nsec) < 0) {
-                ts.tv_sec  = tsNow.tv_sec  - gtsZero.tv_sec  -          1;
-                ts.tv_nsec = tsNow.tv_nsec - gtsZero.tv_nsec + 1000000000;
+              if ((tsMono.tv_nsec - gtsZero.tv_nsec) < 0) {
+                ts.tv_sec  = tsMono.tv_sec  - gtsZero.tv_sec  -          1;
+                ts.tv_nsec = tsMono.tv_nsec - gtsZero.tv_nsec + 1000000000;
               } else {
-                ts.tv_sec  = tsNow.tv_sec  - gtsZero.tv_sec ;
-                ts.tv_nsec = tsNow.tv_nsec - gtsZero.tv_nsec;
+                ts.tv_sec  = tsMono.tv_sec  - gtsZero.tv_sec ;
+                ts.tv_nsec = tsMono.tv_nsec - gtsZero.tv_nsec;
               }
               switch (giTimeResol) {
                 case 0 : if (ts.tv_nsec>=500000000L) {ts.tv_sec++;ts.tv_nsec=0;}
@@ -746,14 +763,14 @@ void print_cur_timestamp(void) {
 
   /*--- Print the delta-t if required ------------------------------*/
   if (giDeltaMode) {
-    if ((tsNow.tv_nsec - gtsPrev.tv_nsec) < 0) {
-      tsDiff.tv_sec  = tsNow.tv_sec  - gtsPrev.tv_sec  -          1;
-      tsDiff.tv_nsec = tsNow.tv_nsec - gtsPrev.tv_nsec + 1000000000;
+    if ((tsMono.tv_nsec - gtsPrev.tv_nsec) < 0) {
+      tsDiff.tv_sec  = tsMono.tv_sec  - gtsPrev.tv_sec  -          1;
+      tsDiff.tv_nsec = tsMono.tv_nsec - gtsPrev.tv_nsec + 1000000000;
     } else {
-      tsDiff.tv_sec  = tsNow.tv_sec  - gtsPrev.tv_sec ;
-      tsDiff.tv_nsec = tsNow.tv_nsec - gtsPrev.tv_nsec;
+      tsDiff.tv_sec  = tsMono.tv_sec  - gtsPrev.tv_sec ;
+      tsDiff.tv_nsec = tsMono.tv_nsec - gtsPrev.tv_nsec;
     }
-    gtsPrev.tv_sec=tsNow.tv_sec; gtsPrev.tv_nsec=tsNow.tv_nsec;
+    gtsPrev.tv_sec=tsMono.tv_sec; gtsPrev.tv_nsec=tsMono.tv_nsec;
     switch (giTimeResol) {
       case 0 : if(tsDiff.tv_nsec>=500000000L){tsDiff.tv_sec++;tsDiff.tv_nsec=0;}
                szDec[0]=0;
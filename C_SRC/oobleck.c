@@ -2,8 +2,10 @@
 #
 # OOBLECK - Output Lines Only When the Next Line Does Not Arrive for a While
 #
-# USAGE   : oobleck [-d fd|file] [-p n] holdingtime [file]
-#         : oobleck [-d fd|file] [-p n] controlfile [file]
+# USAGE   : oobleck [-d fd|file] [-m statsfile] [-u] [-p n] [-L] [-C cpu]
+#                   holdingtime [file]
+#         : oobleck [-d fd|file] [-m statsfile] [-u] [-p n] [-L] [-C cpu]
+#                   controlfile [file]
 # Args    : holdingrule . Rule to hold the data from the data source.
 #                         You can specify it by the following two methods.
 #                           a. holding-time
@@ -60,6 +62,26 @@
 #                                three lines when the incoming text data
 #                                lets up for 500ms, you can write
 #                                "3@500ms" as the holdingrule argument.
+#                           c. time-window and holding-time
+#                              * This method is the same as the above
+#                                one, but the former part is a length
+#                                of time instead of a number of lines.
+#                              * The usage is "window@time."
+#                                + "window" is a time with one of the
+#                                  units 's', 'ms', 'us' and 'ns.' The
+#                                  unit cannot be omitted, which is how
+#                                  this command tells the window from
+#                                  the number-of-lines.
+#                              * This command holds all the lines that
+#                                arrived within the window before the
+#                                latest line, however many there are,
+#                                and flushes them all when the holding-
+#                                time has elapsed. The older lines are
+#                                discarded (or drained) every time a new
+#                                line arrives.
+#                              * For example, "200ms@1s" gets all the
+#                                lines in the last 200ms of a burst once
+#                                the data lets up for a second.
 #           controlfile . Filepath to specify the holding-time instead
 #                         of by argument. You can change the parameter
 #                         even when this command is running by updating
@@ -106,6 +128,22 @@
 #                           add "./" before the name, like "./3."
 #                         * When you set another type of string, this
 #                           command regards it as a filename.
+#           -m statsfile  Write a snapshot of the live counters (lines
+#                         passed, dropped and drained, holding timeouts,
+#                         etc.) into the file every second, when SIGUSR1
+#                         comes, and at exit. A regular file always has
+#                         only the latest one, and a named pipe gets a
+#                         line for each snapshot.
+#                         Without this option, a snapshot is written into
+#                         the stderr only when SIGUSR1 comes.
+#           -u .......... Do not flush the held lines if they are exactly
+#                         the same as the ones flushed last time. It saves
+#                         the downstream from redrawing the same content.
+#                         * The lines are compared by their 64-bit hash
+#                           values, not by the bytes themselves.
+#                         * The suppressed lines are regarded as dropped
+#                           ones. So, they are sent to the drain if the
+#                           -d option is set.
 #           [Only some operating systems support the following option]
 #           -p n ........ Process priority setting [0-3] (if possible)
 #                          0: Normal process
@@ -117,11 +155,21 @@
 #                         but if failed, it will try the smaller numbers.
 #                         An administrative privilege might be required to
 #                         use this option.
+#           -L .......... Lock the memory of this command into the RAM
+#                         after pre-faulting the stack, so that no page
+#                         fault delays it in the realtime mode. A large
+#                         enough "ulimit -l" or a privileged user might
+#                         be required.
+#           -C cpu ...... Run this command only on the CPU #cpu (from 0)
+#                         to avoid the migration between CPUs. (for only
+#                         Linux) An isolated CPU gives the best result.
 # Retuen  : Return 0 only when finished successfully
 #
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread -lrt
+#                  (if it doesn't work)
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-01-17
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # The latest version is distributed at the following page.
 # https://github.com/ShellShoccar-jpn/tokideli
@@ -137,6 +185,9 @@
 /*=== Initial Setting ==============================================*/
 
 /*--- headers ------------------------------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  #define _GNU_SOURCE /* for sched_setaffinity() */
+#endif
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
@@ -147,16 +198,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/select.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
   #include <sched.h>
   #include <sys/resource.h>
 #endif
+#include "stats.h"
+#include "rtmem.h"
+#include "fpbuf.h"
 
 /*--- macro constants ----------------------------------------------*/
 #define RINGBUF_NUM_MAX 256
@@ -170,6 +226,17 @@
 #define CTRL_FILE_BUF 64
 /* Unit size of "Elastic Line Buffer" */
 #define ELBUF_SIZE 1024
+/* Parameters of the 64-bit FNV-1a hash (for the -u option) */
+#define HASH_OFFSET 0xcbf29ce484222325ULL
+#define HASH_PRIME  0x00000100000001b3ULL
+#if !defined(CLOCK_MONOTONIC)
+  #define CLOCK_FOR_ME CLOCK_REALTIME /* for HP-UX */
+#elif defined(__sun) || defined(__SunOS)
+  /* CLOCK_MONOTONIC on Solaris requires privillege */
+  #define CLOCK_FOR_ME CLOCK_REALTIME
+#else
+  #define CLOCK_FOR_ME CLOCK_MONOTONIC
+#endif
 
 /*--- data type definitions ----------------------------------------*/
 typedef struct timespec tmsp;
@@ -183,6 +250,16 @@ typedef struct _RINGBUF {
   int             iSize;       /* Size (Number of ELBs)      */
   int             iLatestLine; /* Which Line Is the Last One */
 } ringbuf_t;              /* Bunch of the ELBs (Ring buffer)        */
+typedef struct _WINLINE {
+  elbuf_t         elb;         /* The line (1st chunk of its ELB)     */
+  tmsp            tsArrived;   /* When the line arrived              */
+  struct _WINLINE* pwlNext;    /* The next (newer) line              */
+} winline_t;              /* A line held in the time-window         */
+typedef struct _WINBUF {
+  winline_t*      pwlOldest;   /* The oldest line in the window      */
+  winline_t*      pwlLatest;   /* The latest line in the window      */
+  winline_t*      pwlSpare;    /* Released lines kept for reuse      */
+} winbuf_t;               /* Queue of the lines (Time-window buffer)*/
 typedef struct _thrcom_t {
   pthread_t       tMainth_id;       /* main thread ID                         */
   pthread_mutex_t mu;               /* The mutex variable                     */
@@ -190,6 +267,7 @@ typedef struct _thrcom_t {
   int             iRequested__main; /* Req. received flag (only in mainth)    */
   int             iReceived;        /* Set 1 when the param. has been received*/
   int64_t         i8Param1;         /* int64 variable #1 to sent to the mainth*/
+  int64_t         i8Param2;         /* int64 variable #2 to sent to the mainth*/
   int             iParam1;          /* int variable #1 to sent to the mainth  */
 } thcominfo_t;
 typedef struct _thrmain_t {
@@ -204,14 +282,21 @@ typedef struct _thrmain_t {
 void* param_updater(void* pvArgs);
 void update_holding_time_type_r(char* pszCtrlfile);
 void update_holding_time_type_c(char* pszCtrlfile);
-int parse_holdingrule(char *pszRule, int64_t* pi8Hldtime, int* piNumlin);
+int parse_holdingrule(char *pszRule, int64_t* pi8Hldtime, int* piNumlin,
+                      int64_t* pi8Window                                  );
 int64_t parse_holdingtime(char *pszArg);
+int read_1line_into_elbuf(FILE *fp, elbuf_t* pelbHead, size_t* psizIn);
 int read_1line_into_ringbuf(FILE *fp, ringbuf_t* pstRingbuf);
+int read_1line_into_winbuf(FILE *fp, winbuf_t* pstWinbuf, FILE* fpDrain);
 void flush_elbuf_chain(elbuf_t* pelbHead, FILE* fp);
 void flush_ringbuf(ringbuf_t* pstRingbuf, FILE* fp);
+void flush_held_lines(FILE* fpDrain);
+uint64_t hash_elbuf_chain(elbuf_t* pelbHead, uint64_t ui8Hash, size_t* psiz);
 void release_following_elbufs(elbuf_t* elb);
 int  create_ring_buf(ringbuf_t* pstRingbuf);
 void destroy_ring_buf(ringbuf_t* pstRingbuf);
+void flush_winbuf(winbuf_t* pstWinbuf, FILE* fp);
+void destroy_win_buf(winbuf_t* pstWinbuf);
 int change_to_rtprocess(int iPrio);
 void do_nothing(int iSig, siginfo_t *siInfo, void *pct);
 #ifdef __ANDROID__
@@ -235,8 +320,21 @@ int64_t  gi8Holdtime;     /* Holding time in nanosecond (-1 means infinity)
                            *   sub-th has to write the parameter into the
                            *   gstThCom.i8Param1 instead when the sub-th
                            *   gives the main-th the new parameter.          */
+int64_t  gi8Window = 0;   /* Time-window in nanosecond (0 means the number
+                           * of lines mode, giHoldlines is 0 otherwise)
+                           * - It is global but for only the main-th. The
+                           *   sub-th has to write the parameter into the
+                           *   gstThCom.i8Param2 instead when the sub-th
+                           *   gives the main-th the new parameter.          */
 ringbuf_t gstRingBuf = {0}; /* Ringed Buffer of Elastic Line Buffer          */
+winbuf_t  gstWinBuf  = {0}; /* Time-window Buffer of Elastic Line Buffer     */
+int      giDedup = 0;     /* -u option flag (suppress the same flush)        */
+int      giHashed;        /* Set 1 when gui8LastHash has a valid value       */
+uint64_t gui8LastHash;    /* Hash of the lines flushed last time (for -u)    */
 thcominfo_t gstThCom;      /* Variables for threads communication            */
+char     gcStdiobuf[3][BUFSIZ]; /* Buffers for the stdio streams (for the
+                           * input, the drain file and stdout). They are
+                           * static to be pre-faulted/locked by -L.          */
 
 /*=== Define the functions for printing usage and error ============*/
 
@@ -244,11 +342,13 @@ thcominfo_t gstThCom;      /* Variables for threads communication            */
 void print_usage_and_exit(void) {
   fprintf(stderr,
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
-    "USAGE   : %s [-d fd|file] [-p n] holdingtime [file]\n"
-    "        : %s [-d fd|file] [-p n] controlfile [file]\n"
+    "USAGE   : %s [-d fd|file] [-m statsfile] [-u] [-p n] [-L] [-C cpu]\n"
+    "                  holdingtime [file]\n"
+    "        : %s [-d fd|file] [-m statsfile] [-u] [-p n] [-L] [-C cpu]\n"
+    "                  controlfile [file]\n"
 #else
-    "USAGE   : %s [-d fd|file] holdingtime [file]\n"
-    "        : %s [-d fd|file] controlfile [file]\n"
+    "USAGE   : %s [-d fd|file] [-m statsfile] [-u] holdingtime [file]\n"
+    "        : %s [-d fd|file] [-m statsfile] [-u] controlfile [file]\n"
 #endif
     "Args    : holdingrule . Rule to hold the data from the data source.\n"
     "                        You can specify it by the following two methods.\n"
@@ -306,6 +406,26 @@ void print_usage_and_exit(void) {
     "                               three lines when the incoming text data\n"
     "                               lets up for 500ms, you can write\n"
     "                               \"3@500ms\" as the holdingrule argument.\n"
+    "                          c. time-window and holding-time\n"
+    "                             * This method is the same as the above\n"
+    "                               one, but the former part is a length\n"
+    "                               of time instead of a number of lines.\n"
+    "                             * The usage is \"window@time.\"\n"
+    "                               + \"window\" is a time with one of the\n"
+    "                                 units 's', 'ms', 'us' and 'ns.' The\n"
+    "                                 unit cannot be omitted, which is how\n"
+    "                                 this command tells the window from\n"
+    "                                 the number-of-lines.\n"
+    "                             * This command holds all the lines that\n"
+    "                               arrived within the window before the\n"
+    "                               latest line, however many there are,\n"
+    "                               and flushes them all when the holding-\n"
+    "                               time has elapsed. The older lines are\n"
+    "                               discarded (or drained) every time a new\n"
+    "                               line arrives.\n"
+    "                             * For example, \"200ms@1s\" gets all the\n"
+    "                               lines in the last 200ms of a burst once\n"
+    "                               the data lets up for a second.\n"
     "          controlfile . Filepath to specify the holding-time instead\n"
     "                        of by argument. You can change the parameter\n"
     "                        even when this command is running by updating\n"
@@ -352,6 +472,22 @@ void print_usage_and_exit(void) {
     "                          add \"./\" before the name, like \"./3.\"\n"
     "                        * When you set another type of string, this\n"
     "                          command regards it as a filename.\n"
+    "          -m statsfile  Write a snapshot of the live counters (lines\n"
+    "                        passed, dropped and drained, holding timeouts,\n"
+    "                        etc.) into the file every second, when SIGUSR1\n"
+    "                        comes, and at exit. A regular file always has\n"
+    "                        only the latest one, and a named pipe gets a\n"
+    "                        line for each snapshot.\n"
+    "                        Without this option, a snapshot is written into\n"
+    "                        the stderr only when SIGUSR1 comes.\n"
+    "          -u .......... Do not flush the held lines if they are exactly\n"
+    "                        the same as the ones flushed last time. It saves\n"
+    "                        the downstream from redrawing the same content.\n"
+    "                        * The lines are compared by their 64-bit hash\n"
+    "                          values, not by the bytes themselves.\n"
+    "                        * The suppressed lines are regarded as dropped\n"
+    "                          ones. So, they are sent to the drain if the\n"
+    "                          -d option is set.\n"
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
     "          -p n ........ Process priority setting [0-3] (if possible)\n"
     "                         0: Normal process\n"
@@ -363,8 +499,16 @@ void print_usage_and_exit(void) {
     "                        but if failed, it will try the smaller numbers.\n"
     "                        An administrative privilege might be required to\n"
     "                        use this option.\n"
+    "          -L .......... Lock the memory of this command into the RAM\n"
+    "                        after pre-faulting the stack, so that no page\n"
+    "                        fault delays it in the realtime mode. A large\n"
+    "                        enough \"ulimit -l\" or a privileged user might\n"
+    "                        be required.\n"
+    "          -C cpu ...... Run this command only on the CPU #cpu (from 0)\n"
+    "                        to avoid the migration between CPUs. (for only\n"
+    "                        Linux) An isolated CPU gives the best result.\n"
 #endif
-    "Version : 2025-01-17 13:45:36 JST\n"
+    "Version : 2026-10-18 23:03:18 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -408,13 +552,18 @@ int main(int argc, char *argv[]) {
 sigset_t ssMask;          /* blocking signal list for the main thread*/
 struct sigaction saHup;   /* for signal handler definition (action) */
 char*    pszDrainname;    /* Drain stream name (for the -d option)  */
+char*    pszStatfile;     /* Statistics file (for the -m option)    */
 int      iDrainFd;        /* Drain filedesc. (for the -d option)    */
 int      iPrio;           /* -p option number (default 1)           */
+int      iCpu;            /* -C option number (-1:not pinned)       */
+int      iMlock;          /* 1 if -L option is given                */
 struct stat stCtrlfile;   /* stat for the control file              */
 char     szDummy[2];      /* Dummy string for sscanf()              */
 char    *pszFilename;     /* filepath (for message)                 */
 int      iFd;             /* file descriptor                        */
 tmsp     tsHoldtime;      /* The Holding time                       */
+tmsp     tsTo;            /* The time when the holding time is up   */
+tmsp     tsNow;           /* The time when pselect() timed out      */
 fd_set   fdsRead;         /* for pselect()                          */
 int      iRet;            /* return code                            */
 int      i;               /* all-purpose int                        */
@@ -436,16 +585,27 @@ setlocale(LC_CTYPE, "");
 giVerbose    =    0;
 iDrainFd     =   -1;
 iPrio        =    1;
+iCpu         =   -1;
+iMlock       =    0;
 pszDrainname = NULL;
+pszStatfile  = NULL;
 /*--- Parse options which start with "-" ---------------------------*/
-while ((i=getopt(argc, argv, "d:p:hv")) != -1) {
+while ((i=getopt(argc, argv, "d:m:p:LC:uhv")) != -1) {
   switch (i) {
     case 'd': if (sscanf(optarg,"%d%1s",&iDrainFd,szDummy) != 1) {iDrainFd=-1;}
               if (iDrainFd>=0) {pszDrainname=NULL;} else {pszDrainname=optarg;}
               break;
+    case 'm': pszStatfile = optarg;
+              break;
+    case 'u': giDedup     = 1;
+              break;
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
     case 'p': if (sscanf(optarg,"%d",&iPrio) != 1) {print_usage_and_exit();}
               break;
+    case 'L': iMlock = 1;     break;
+    case 'C': if (sscanf(optarg,"%d",&iCpu) != 1) {print_usage_and_exit();}
+              if (iCpu < 0                       ) {print_usage_and_exit();}
+              break;
 #endif
     case 'v': giVerbose++;    break;
     case 'h': print_usage_and_exit();
@@ -456,16 +616,19 @@ if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
 argc -= optind;
 argv += optind;
 if (argc < 1) {print_usage_and_exit();}
+/*--- Start the statistics thread before any other threads ---------*/
+stats_start(gpszCmdname, pszStatfile);
 /*--- Prepare the thread operation ---------------------------------*/
 memset(&gstThCom, 0, sizeof(gstThCom    ));
 memset(&stMainth, 0, sizeof(thmaininfo_t));
 pthread_cleanup_push(mainth_destructor, &stMainth);
 /*--- Parse the holdingtime argument -------------------------------*/
-i = parse_holdingrule(argv[0], &gi8Holdtime, &giHoldlines);
+i = parse_holdingrule(argv[0], &gi8Holdtime, &giHoldlines, &gi8Window);
 if (i != 0) {
   /* Set the initial parameter, which means "immediately" */
   gi8Holdtime=DEFAULT_HOLDINGTIME ; gstThCom.i8Param1=gi8Holdtime;
   giHoldlines=DEFAULT_HOLDINGLINES; gstThCom.iParam1 =giHoldlines;
+  gi8Window  =                   0; gstThCom.i8Param2=gi8Window  ;
   gstRingBuf.iSize = giHoldlines; gstRingBuf.pelbRing = NULL;
   if (create_ring_buf(&gstRingBuf) > 0) {
     error_exit(errno,"create_ring_buf() in main() #1\n");
@@ -534,10 +697,16 @@ if (argc > 1) {
   print_usage_and_exit();
 }
 
+/*=== Try to make me a realtime process ============================*/
+if (change_to_rtprocess(iPrio)==-1) {print_usage_and_exit();}
+if (iCpu >= 0) {rtmem_pin_cpu(iCpu);}
+if (iMlock   ) {rtmem_prefault(gcStdiobuf,sizeof(gcStdiobuf));
+                rtmem_lock();                                  }
+
 /*=== Main routine =================================================*/
 
 /*--- Switch to the line-buffered mode -----------------------------*/
-if (setvbuf(stdout,NULL,_IOLBF,0)!=0) {
+if (setvbuf(stdout,gcStdiobuf[2],_IOLBF,BUFSIZ)!=0) {
   error_exit(255,"Failed to switch to line-buffered mode\n");
 }
 /*--- Open the input files -----------------------------------------*/
@@ -557,6 +726,9 @@ if (iFd == STDIN_FILENO) {
 } else                   {
   stMainth.fpIn = fdopen(iFd, "r");
 }
+if (setvbuf(stMainth.fpIn,gcStdiobuf[0],_IOFBF,BUFSIZ)!=0) {
+  error_exit(255,"%s: Failed to give the buffer\n",pszFilename);
+}
 /*--- Open the drain file if specified -----------------------------*/
 if (pszDrainname != NULL) {
   while ((iDrainFd=open(pszDrainname,O_WRONLY|O_CREAT,0644))<0) {
@@ -567,14 +739,19 @@ if (pszDrainname != NULL) {
 else if (iDrainFd != -1 ) {stMainth.fpDrain = fdopen(iDrainFd, "w");  }
 else                      {stMainth.fpDrain = NULL;                   }
 if (stMainth.fpDrain) {
-  if (setvbuf(stMainth.fpDrain,NULL,_IOLBF,0)!=0) {
+  if (setvbuf(stMainth.fpDrain,gcStdiobuf[1],_IOLBF,BUFSIZ)!=0) {
     error_exit(255,"Failed to switch to line-buffered mode (drain)\n");
   }
 }
 
 /*--- Play the oobleck (infinite loop) -----------------------------*/
 do {
-  /* 1) Create/Recreate the ring buffer if required */
+  /* 1) Create/Recreate the ring buffer if required (Lines held in the
+        time-window are released when the rule is not a window anymore,
+        and so is the ring buffer when the rule becomes a window.)      */
+  if (gi8Window==0 && gstWinBuf.pwlOldest) {
+    flush_winbuf(&gstWinBuf,stMainth.fpDrain);
+  }
   if (gstRingBuf.iSize != giHoldlines) {
     if (giVerbose>0) {
       warning("RingBuffer will be recreated (size: %d -> %d)\n",
@@ -585,14 +762,16 @@ do {
       destroy_ring_buf(&gstRingBuf);
     }
     gstRingBuf.iSize = giHoldlines;
-    if (create_ring_buf(&gstRingBuf) > 0) {
+    if (giHoldlines>0 && create_ring_buf(&gstRingBuf)>0) {
       error_exit(errno,"create_ring_buf() in main() #2\n");
     }
   }
   /* 2) Read a line from stdin and store it in the EL-buffer */
-  i = read_1line_into_ringbuf(stMainth.fpIn,&gstRingBuf);
+  if (gi8Window == 0) {i=read_1line_into_ringbuf(stMainth.fpIn,&gstRingBuf);}
+  else                {i=read_1line_into_winbuf(stMainth.fpIn,&gstWinBuf,
+                                                stMainth.fpDrain          );}
   /* 3-a) If the stdin is EOF, flush the buffer */
-  if      (i ==  0) {flush_ringbuf(&gstRingBuf,stdout); break;        }
+  if      (i ==  0) {flush_held_lines(stMainth.fpDrain); break;}
   /* 3-b) If some error happens on the stdin, exit */
   else if (i == -1) {error_exit(1,"%s: Reading error\n", pszFilename);}
   /* 3-c) If the stdin is not EOF yet, move on */
@@ -610,34 +789,56 @@ do {
       error_exit(i,"pthread_mutex_unlock() in main(): %s\n", strerror(i));
     }
     if (giVerbose>0) {warning("gi8Holdtime=%ld\n",gi8Holdtime);}
+    if (giVerbose>0) {warning("gi8Window=%ld\n"  ,gi8Window  );}
     gstThCom.iRequested__main = 0;
   }
   /* 5) (If the stdin is not EOF yet,) wait for the next line coming */
   FD_ZERO(     &fdsRead);
   FD_SET( iFd, &fdsRead);
-  if (gi8Holdtime == -1) {
+  if (gi8Window>0 && gi8Holdtime!=0 && FP_HAS_RBUF(stMainth.fpIn)) {
+    /* The next line has already come into the stdio buffer. Take it in
+       now so that the time-window sees when it actually arrived.       */
+    i = 1;
+  } else if (gi8Holdtime == -1) {
     i = pselect(iFd+1, &fdsRead, NULL, NULL, NULL, NULL);
   } else                 {
     tsHoldtime.tv_sec  = gi8Holdtime / 1000000000;
     tsHoldtime.tv_nsec = gi8Holdtime % 1000000000;
+    if (clock_gettime(CLOCK_FOR_ME,&tsTo) != 0) {
+      error_exit(errno,"clock_gettime() #1 in main(): %s\n",strerror(errno));
+    }
     i = pselect(iFd+1, &fdsRead, NULL, NULL, &tsHoldtime, NULL);
+    if (i == 0) {
+      /* Count the timeout with how late it was */
+      if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
+        error_exit(errno,"clock_gettime() #2 in main(): %s\n",strerror(errno));
+      }
+      tsTo.tv_sec  += tsHoldtime.tv_sec ;
+      tsTo.tv_nsec += tsHoldtime.tv_nsec;
+      if (tsTo.tv_nsec >= 1000000000) {tsTo.tv_sec++; tsTo.tv_nsec-=1000000000;}
+      stats_slept(&tsTo,&tsNow);
+    }
   }
   /* 6-a) If the next line has come in time, discard the current line */
   if      ( i>  0                 ) {
     /* If fpDrain is open and the incoming data still continues, flush
        the oldest line now. Otherwise, the oldest line, which should be
        output to the drain, will be lost by the next reading.           */
-    if (stMainth.fpDrain && ((i=fgetc(stMainth.fpIn))!=EOF)) {
+    if (gi8Window==0 && stMainth.fpDrain
+                     && ((i=fgetc(stMainth.fpIn))!=EOF)) {
       ungetc(i, stMainth.fpIn);
       i = (gstRingBuf.iLatestLine+1) % gstRingBuf.iSize;
       flush_elbuf_chain(&gstRingBuf.pelbRing[i], stMainth.fpDrain);
     }
   }
   /* 6-b) If the next line has not come in time, write the line to the stdout */
-  else if ( i== 0                 ) {flush_ringbuf(&gstRingBuf,stdout);}
+  else if ( i== 0                 ) {flush_held_lines(stMainth.fpDrain);}
   /* 6-c) If signal interruption happend, discard the current line, too */
   else if ((i==-1)&&(errno==EINTR)) {
-    if(stMainth.fpDrain){flush_ringbuf(&gstRingBuf,stMainth.fpDrain);}
+    if (stMainth.fpDrain) {
+      if (gi8Window == 0) {flush_ringbuf(&gstRingBuf,stMainth.fpDrain);}
+      else                {flush_winbuf( &gstWinBuf ,stMainth.fpDrain);}
+    }
   }
   /* 6-d) If another error happend, exit */
   else                   {error_exit(errno,"pselect(): %s\n",strerror(errno));}
@@ -711,6 +912,7 @@ return NULL;}
  *       gstThCom.co      : Condition variable to send a signal to the sub-th
  * [out] gstThCom.iParam1 : The new parameter (int)
  *       gstThCom.i8Param1: The new parameter (int64_t)
+ *       gstThCom.i8Param2: The new parameter (int64_t, time-window)
  *       gstThCom.iReceived
  *                        : Set to 0 after confirming that the main thread
  *                          receivedi the request                      */
@@ -723,7 +925,7 @@ void update_holding_time_type_r(char* pszCtrlfile) {
   int              iFd_ctrlfile        ; /* file desc. of the ctrlfile */
   char             szBuf[CTRL_FILE_BUF]; /* parameter string buffer    */
   int              iLen                ; /* length of the parameter str*/
-  int64_t          i8                  ;
+  int64_t          i8, i8W             ;
   int              i,j                 ;
 
   /*--- Set the signal-triggered timer -----------------------------*/
@@ -770,12 +972,14 @@ void update_holding_time_type_r(char* pszCtrlfile) {
     if ((iLen=read(iFd_ctrlfile,szBuf,CTRL_FILE_BUF-1)) < 1) {goto pause;}
     for (i=0;i<iLen;i++) {if(szBuf[i]=='\n'){break;}}
     szBuf[i]='\0';
-    i = parse_holdingrule(szBuf, &i8, &j);
+    i = parse_holdingrule(szBuf, &i8, &j, &i8W);
     if (i != 0                                             ) {goto pause;}
-    if ((gstThCom.i8Param1==i8) && (gstThCom.iParam1==j)   ) {goto pause;}
+    if ((gstThCom.i8Param1==i8) && (gstThCom.iParam1==j)
+                                && (gstThCom.i8Param2==i8W)) {goto pause;}
     /* 2) Update the holding time */
-    gstThCom.i8Param1 = i8;
-    gstThCom.iParam1  =  j;
+    gstThCom.i8Param1 = i8 ;
+    gstThCom.iParam1  =  j ;
+    gstThCom.i8Param2 = i8W;
     if (pthread_kill(gstThCom.tMainth_id, SIGHUP) != 0) {
       error_exit(errno,"pthread_kill() in type_r(): %s\n",strerror(errno));
     }
@@ -809,6 +1013,7 @@ pause:
  *       gstThCom.co      : Condition variable to send a signal to the sub-th
  * [out] gstThCom.iParam1 : The new parameter (int)
  *       gstThCom.i8Param1: The new parameter (int64_t)
+ *       gstThCom.i8Param2: The new parameter (int64_t, time-window)
  *       gstThCom.iReceived
  *                        : Set to 0 after confirming that the main thread
  *                          receivedi the request                      */
@@ -824,7 +1029,7 @@ void update_holding_time_type_c(char* pszCtrlfile) {
   char    szCmdbuf[CTRL_FILE_BUF]  ; /* Buffer for the new parameter*/
   struct pollfd fdsPoll[1]         ;
   char*   psz                      ;
-  int64_t i8                       ;
+  int64_t i8, i8W                  ;
   int     i, j, k                  ;
 
   /*--- Initialize the buffer for the parameter --------------------*/
@@ -905,15 +1110,17 @@ void update_holding_time_type_c(char* pszCtrlfile) {
       }
     }
     memcpy(szCmdbuf, szBuf1+j, i-j);
-    j = parse_holdingrule(szBuf1, &i8, &k);
+    j = parse_holdingrule(szBuf1, &i8, &k, &i8W);
     if (j != 0                                          ) {
       szCmdbuf[0]='\0'; continue; /* Invalid rule string */
     }
-    if ((gstThCom.i8Param1==i8) && (gstThCom.iParam1==k)) {
+    if ((gstThCom.i8Param1==i8) && (gstThCom.iParam1==k)
+                                && (gstThCom.i8Param2==i8W)) {
       szCmdbuf[0]='\0'; continue; /* Parameters do not change */
     }
-    gstThCom.i8Param1 = i8;
-    gstThCom.iParam1  =  k;
+    gstThCom.i8Param1 = i8 ;
+    gstThCom.iParam1  =  k ;
+    gstThCom.i8Param2 = i8W;
     if (pthread_kill(gstThCom.tMainth_id, SIGHUP) != 0) {
       error_exit(errno,"pthread_kill() in type_c(): %s\n",strerror(errno));
     }
@@ -976,32 +1183,52 @@ void update_holding_time_type_c(char* pszCtrlfile) {
  * [in] pszRule    : The string to be parsed as a "holdingrule"
  *      pi8Hldtime : The pointer to get the parsed holdingtime part
  *      piNumlin   : The pointer to get the parsed number-of-lines part
+ *                   (0 when the former part is a time-window)
+ *      pi8Window  : The pointer to get the parsed time-window part
+ *                   (0 when the former part is a number-of-lines)
  * [ret] ==0       : Succeed in parsing the parameters
  *       ==1       : Argument error (e.g. null pointer)
  *       ==2       : Invalid rule string
- * [note] the values of {pi8Hldtime,piNumlin} will be overwritten
- *        whether the parsing succeeds or not.                      */
-int parse_holdingrule(char *pszRule, int64_t* pi8Hldtime, int* piNumlin) {
+ * [note] the values of {pi8Hldtime,piNumlin,pi8Window} will be
+ *        overwritten whether the parsing succeeds or not.          */
+int parse_holdingrule(char *pszRule, int64_t* pi8Hldtime, int* piNumlin,
+                      int64_t* pi8Window                                  ) {
 
   /*--- Definitions ------------------------------------------------*/
-  char* psz;
+  char   szWindow[CTRL_FILE_BUF];
+  char*  psz;
+  size_t siz;
+  char   c;
 
   /*--- Validate the arguments -------------------------------------*/
   if (! pszRule   ) {return 1;}
   if (! pi8Hldtime) {return 1;}
   if (! piNumlin  ) {return 1;}
+  if (! pi8Window ) {return 1;}
 
   /*--- Parse ------------------------------------------------------*/
+  *pi8Window = 0;
   if ((psz=strchr(pszRule,'@')) != NULL){
-    if (sscanf(pszRule,"%d",piNumlin) != 1) {return 2;}
+    if (sscanf(pszRule,"%d%c",piNumlin,&c)!=2 || c!='@') {
+      /* The former part must be a time-window if it is not a number.
+         It has to have a unit (every unit ends with 's') so that
+         "1@..." will not be regarded as a 1-second window.        */
+      *piNumlin = 0;
+      siz       = (size_t)(psz-pszRule);
+      if (siz<1 || siz>=CTRL_FILE_BUF) {return 2;}
+      memcpy(szWindow, pszRule, siz); szWindow[siz]='\0';
+      if (szWindow[siz-1] != 's'     ) {return 2;}
+      if ((*pi8Window=parse_holdingtime(szWindow)) <= 0) {return 2;}
+    }
     psz++;
   }else{
     *piNumlin =       1;
     psz       = pszRule;
   }
   *pi8Hldtime = parse_holdingtime(psz);
-  if (*piNumlin<1 || RINGBUF_NUM_MAX<*piNumlin) {return 2;}
-  if (*pi8Hldtime <= -2                       ) {return 2;}
+  if (*pi8Window==0 && (*piNumlin<1 || RINGBUF_NUM_MAX<*piNumlin)) {
+                                                  return 2;}
+  if (*pi8Hldtime <= -2                          ) {return 2;}
 
   /*--- Finish successfully ----------------------------------------*/
   return 0;
@@ -1064,38 +1291,28 @@ int64_t parse_holdingtime(char *pszArg) {
   return -2;
 }
 
-/*=== Read one line into the ELB ring buffer =========================
- * [in] fp         : Filehandle for read
- *      pstRingbuf : Pointer of the ELB ring buffer
- *                   This argument must have the correct iSize and
- *                   iLatestLine members.
+/*=== Read one line into an EL-buffer chain ==========================
+ * [in]  fp       : Filehandle for read
+ *       pelbHead : Pointer of the head of the EL-buffer chain
+ * [out] psizIn   : Number of the bytes read (0 means nothing has come)
  * [ret]  1 : Finished reading with '\n'
  *        0 : Finished reading due to EOF
  *       -1 : Finished reading due to an file error                 */
-int read_1line_into_ringbuf(FILE *fp, ringbuf_t* pstRingbuf) {
+int read_1line_into_elbuf(FILE *fp, elbuf_t* pelbHead, size_t* psizIn) {
 
   /*--- Variables --------------------------------------------------*/
   elbuf_t* pelbCurrent;
   elbuf_t* pelbNew;
-  int      iNextLine;
   int      iRet;
+  size_t   sizIn;
 
-  /*--- Validate the arguments -------------------------------------*/
-  if (! fp        ) {error_exit(1,"read_1line_into_ringbuf(): fp is NULL\n");}
-  if (! pstRingbuf) {error_exit(1,"read_1line_into_ringbuf(): RB is NULL\n");}
-  if (! pstRingbuf->pelbRing) {
-    error_exit(1,"read_1line_into_ringbuf(): pstRingbuf->pelbRing is NULL\n");}
-  if (pstRingbuf->iLatestLine < 0) {
-    error_exit(1,"read_1line_into_ringbuf(): pstRingbuf->iLatestLine is <0\n");}
-  if (pstRingbuf->iSize <= pstRingbuf->iLatestLine) {
-    error_exit(1,"read_1line_into_ringbuf(): pstRingbuf->iSize is larger\n");}
-
-  /*--- Write a line string data into one of the EL-buffer chains --*/
+  /*--- Write a line string data into the EL-buffer chain ----------*/
   iRet        = -2;
-  iNextLine   = (pstRingbuf->iLatestLine+1) % pstRingbuf->iSize;
-  pelbCurrent = &pstRingbuf->pelbRing[iNextLine];
+  pelbCurrent = pelbHead;
+  sizIn       = 0;
   while (fgets(pelbCurrent->szBuf, sizeof(pelbCurrent->szBuf), fp)) {
     pelbCurrent->sSize = strlen(pelbCurrent->szBuf);
+    sizIn += pelbCurrent->sSize;
     if (pelbCurrent->sSize < sizeof(pelbCurrent->szBuf)-1) {
       if (pelbCurrent->szBuf[pelbCurrent->sSize-1] == '\n') {iRet= 1; break;}
       if (feof(  fp)                                      ) {iRet= 0; break;}
@@ -1115,21 +1332,136 @@ int read_1line_into_ringbuf(FILE *fp, ringbuf_t* pstRingbuf) {
     }
     pelbCurrent = pelbCurrent->pelbNext;
   }
-
-  /*--- Increment the "iLatestLine" only if any data has come ------*/
-  if (iRet >= -1) { /* "iRet>=-1" means that this function has
-                       already received one or more bytes.     */
-    pstRingbuf->iLatestLine = iNextLine;
-  } else {
+  if (iRet == -2) { /* "iRet==-2" means that nothing has come. */
     if      (feof(  fp)) {iRet= 0;}
     else if (ferror(fp)) {iRet=-1;}
     else                 {
       error_exit(1,"read_1line_into_elbuf(): Unexpected error #2\n");}
   }
+  if (sizIn > 0) {
+    stats_add(ST_BYTES_IN,sizIn);
+    stats_add(ST_LINES_IN,(iRet==1));
+  }
 
   /*--- Truncate the EL-buffer chain if the line data is shorter ---*/
   release_following_elbufs(pelbCurrent);
 
+  /*--- Return -----------------------------------------------------*/
+  *psizIn = sizIn;
+  return iRet;
+}
+
+/*=== Read one line into the ELB ring buffer =========================
+ * [in] fp         : Filehandle for read
+ *      pstRingbuf : Pointer of the ELB ring buffer
+ *                   This argument must have the correct iSize and
+ *                   iLatestLine members.
+ * [ret]  1 : Finished reading with '\n'
+ *        0 : Finished reading due to EOF
+ *       -1 : Finished reading due to an file error                 */
+int read_1line_into_ringbuf(FILE *fp, ringbuf_t* pstRingbuf) {
+
+  /*--- Variables --------------------------------------------------*/
+  elbuf_t* pelbCurrent;
+  int      iNextLine;
+  int      iRet;
+  int      iHeld;
+  size_t   sizIn;
+
+  /*--- Validate the arguments -------------------------------------*/
+  if (! fp        ) {error_exit(1,"read_1line_into_ringbuf(): fp is NULL\n");}
+  if (! pstRingbuf) {error_exit(1,"read_1line_into_ringbuf(): RB is NULL\n");}
+  if (! pstRingbuf->pelbRing) {
+    error_exit(1,"read_1line_into_ringbuf(): pstRingbuf->pelbRing is NULL\n");}
+  if (pstRingbuf->iLatestLine < 0) {
+    error_exit(1,"read_1line_into_ringbuf(): pstRingbuf->iLatestLine is <0\n");}
+  if (pstRingbuf->iSize <= pstRingbuf->iLatestLine) {
+    error_exit(1,"read_1line_into_ringbuf(): pstRingbuf->iSize is larger\n");}
+
+  /*--- Write a line string data into one of the EL-buffer chains --*/
+  iNextLine   = (pstRingbuf->iLatestLine+1) % pstRingbuf->iSize;
+  pelbCurrent = &pstRingbuf->pelbRing[iNextLine];
+  iHeld       = (pelbCurrent->sSize > 0); /* still holding an old line? */
+  iRet        = read_1line_into_elbuf(fp, pelbCurrent, &sizIn);
+
+  /*--- Increment the "iLatestLine" only if any data has come ------*/
+  if (sizIn > 0) {
+    pstRingbuf->iLatestLine = iNextLine;
+    if (iHeld) {stats_add(ST_DROPPED,1);} /* the old line was overwritten */
+  }
+
+  /*--- Return -----------------------------------------------------*/
+  return iRet;
+}
+
+/*=== Read one line into the time-window buffer ======================
+ * [notice] The lines which arrived earlier than the window before the
+ *          new one are released from the head of the queue. They are
+ *          written into fpDrain if it is given, or dropped otherwise.
+ * [in] fp         : Filehandle for read
+ *      pstWinbuf  : Pointer of the time-window buffer
+ *      fpDrain    : File handle for the drain (NULL means nothing)
+ *      gi8Window  : The time-window (in nanosecond)
+ * [ret]  1 : Finished reading with '\n'
+ *        0 : Finished reading due to EOF
+ *       -1 : Finished reading due to an file error                 */
+int read_1line_into_winbuf(FILE *fp, winbuf_t* pstWinbuf, FILE* fpDrain) {
+
+  /*--- Variables --------------------------------------------------*/
+  winline_t* pwlNew;
+  winline_t* pwl;
+  tmsp       tsOldest; /* Lines arrived before it will be released */
+  int        iRet;
+  size_t     sizIn;
+
+  /*--- Validate the arguments -------------------------------------*/
+  if (! fp       ) {error_exit(1,"read_1line_into_winbuf(): fp is NULL\n");}
+  if (! pstWinbuf) {error_exit(1,"read_1line_into_winbuf(): WB is NULL\n");}
+
+  /*--- Get a line buffer (reuse a released one if exists) ---------*/
+  if (pstWinbuf->pwlSpare) {
+    pwlNew              = pstWinbuf->pwlSpare;
+    pstWinbuf->pwlSpare = pwlNew->pwlNext;
+  } else {
+    if ((pwlNew=(winline_t*)malloc(sizeof(winline_t))) == NULL) {
+      error_exit(1,"Memory is not enough.\n");
+    }
+    pwlNew->elb.pelbNext = NULL;
+  }
+  pwlNew->elb.sSize = 0;
+  pwlNew->pwlNext   = NULL;
+
+  /*--- Read a line into it ----------------------------------------*/
+  iRet = read_1line_into_elbuf(fp, &pwlNew->elb, &sizIn);
+  if (sizIn == 0) {
+    pwlNew->pwlNext     = pstWinbuf->pwlSpare;
+    pstWinbuf->pwlSpare = pwlNew;
+    return iRet;
+  }
+  if (clock_gettime(CLOCK_FOR_ME,&pwlNew->tsArrived) != 0) {
+    error_exit(errno,"clock_gettime() in read_1line_into_winbuf(): %s\n",
+               strerror(errno));
+  }
+
+  /*--- Enqueue it as the latest line ------------------------------*/
+  if (pstWinbuf->pwlLatest) {pstWinbuf->pwlLatest->pwlNext = pwlNew;}
+  else                      {pstWinbuf->pwlOldest          = pwlNew;}
+  pstWinbuf->pwlLatest = pwlNew;
+
+  /*--- Release the lines which have gone out of the window --------*/
+  tsOldest.tv_sec  = pwlNew->tsArrived.tv_sec  - gi8Window/1000000000;
+  tsOldest.tv_nsec = pwlNew->tsArrived.tv_nsec - gi8Window%1000000000;
+  if (tsOldest.tv_nsec < 0) {tsOldest.tv_sec--; tsOldest.tv_nsec+=1000000000;}
+  while ((pwl=pstWinbuf->pwlOldest) != pwlNew) {
+    if (  (pwl->tsArrived.tv_sec >  tsOldest.tv_sec  )
+        ||(pwl->tsArrived.tv_sec == tsOldest.tv_sec  &&
+           pwl->tsArrived.tv_nsec>= tsOldest.tv_nsec)) {break;}
+    flush_elbuf_chain(&pwl->elb, fpDrain);
+    pstWinbuf->pwlOldest = pwl->pwlNext;
+    pwl->pwlNext         = pstWinbuf->pwlSpare;
+    pstWinbuf->pwlSpare  = pwl;
+  }
+
   /*--- Return -----------------------------------------------------*/
   return iRet;
 }
@@ -1139,23 +1471,25 @@ int read_1line_into_ringbuf(FILE *fp, ringbuf_t* pstRingbuf) {
  *          chunks of every elb. (The top chunk will remain) And,
  *          sets the sSize of the first chunk to 0.
  * [in] pelbHead : Pointer of the head of the EL-buffer chain
- *      fp       : File handle to output                            */
+ *      fp       : File handle to output (NULL means dropping it)   */
 void flush_elbuf_chain(elbuf_t* pelbHead, FILE* fp) {
 
   /*--- Variables --------------------------------------------------*/
   elbuf_t* pelbCurrent;
+  size_t   sizOut;
 
   /*--- Validate the arguments -------------------------------------*/
   if (! pelbHead) {error_exit(1,"flush_1elbuf_chain(): pelbHead is NULL\n");}
-  if (!       fp) {error_exit(1,"flush_1elbuf_chain(): fp is NULL\n"      );}
 
   /*--- Flush the EL-buffer chain and initialize it ----------------*/
   pelbCurrent = pelbHead;
+  sizOut      = 0;
   do {
     if (pelbCurrent->sSize == 0) {break;}
-    if (fputs(pelbCurrent->szBuf, fp) == EOF) {
+    if (fp && fputs(pelbCurrent->szBuf, fp)==EOF) {
       error_exit(errno,"Write error: %s\n",strerror(errno));
     }
+    sizOut += pelbCurrent->sSize;
     /* Flush the next buffer if all of the following conditions are satisfied.
      *   a. The size of the current buffer is full.
      *   b. The current buffer is not terminated with "\n."
@@ -1164,6 +1498,12 @@ void flush_elbuf_chain(elbuf_t* pelbHead, FILE* fp) {
     if (pelbCurrent->szBuf[pelbCurrent->sSize-1] == '\n' ) {break;}
     pelbCurrent = pelbCurrent->pelbNext;
   } while (pelbCurrent);
+  if (sizOut > 0) {
+    if      (fp == stdout) {stats_add(ST_BYTES_OUT,sizOut);
+                            stats_add(ST_LINES_OUT,1     );}
+    else if (fp == NULL  ) {stats_add(ST_DROPPED  ,1     );}
+    else                   {stats_add(ST_DRAINED  ,1     );}
+  }
   pelbHead->sSize = 0;
   release_following_elbufs(pelbHead);
 
@@ -1176,7 +1516,7 @@ void flush_elbuf_chain(elbuf_t* pelbHead, FILE* fp) {
  *          chunks of every elb chain. (The top chunk will remain) And,
  *          sets the sSize of the first chunk to 0.
  * [in] pstRingbuf : Pointer of the ring buffer
- *      fp         : File handle to output                          */
+ *      fp         : File handle to output (NULL means dropping them)*/
 void flush_ringbuf(ringbuf_t* pstRingbuf, FILE* fp) {
 
   /*--- Variables --------------------------------------------------*/
@@ -1184,7 +1524,6 @@ void flush_ringbuf(ringbuf_t* pstRingbuf, FILE* fp) {
 
   /*--- Validate the arguments -------------------------------------*/
   if (! pstRingbuf) {error_exit(1,"flush_ringbuf(): pstRingbuf is NULL\n");}
-  if (!         fp) {error_exit(1,"flush_ringbuf(): fp is NULL\n"        );}
 
   /*--- Flush the buffered line data and initialize all ELB chains -*/
   i = pstRingbuf->iLatestLine + 1;
@@ -1197,6 +1536,113 @@ void flush_ringbuf(ringbuf_t* pstRingbuf, FILE* fp) {
   return;
 }
 
+/*=== Flush the held lines to the stdout =============================
+ * [notice] If the -u option is set and the lines are the same as the
+ *          ones flushed last time, they are not written into the stdout
+ *          but dropped, or drained if the drain is open.
+ * [in] fpDrain      : File handle for the drain (NULL means nothing)
+ *      giDedup      : -u option flag
+ *      gi8Window    : Which buffer holds the lines (0 means the ring)
+ *      gstRingBuf   : The ring buffer
+ *      gstWinBuf    : The time-window buffer
+ *      gui8LastHash : Hash of the lines flushed last time
+ *      giHashed     : Whether the gui8LastHash is valid or not        */
+void flush_held_lines(FILE* fpDrain) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint64_t   ui8Hash;
+  size_t     siz;
+  winline_t* pwl;
+  FILE*      fp;
+  int        i;
+
+  /*--- Hash the held lines in the order to be written -------------*/
+  fp = stdout;
+  if (giDedup) {
+    ui8Hash = HASH_OFFSET;
+    siz     = 0;
+    if (gi8Window == 0) {
+      for (i=1; i<=gstRingBuf.iSize; i++) {
+        ui8Hash = hash_elbuf_chain(
+          &gstRingBuf.pelbRing[(gstRingBuf.iLatestLine+i)%gstRingBuf.iSize],
+          ui8Hash, &siz                                                    );
+      }
+    } else {
+      for (pwl=gstWinBuf.pwlOldest; pwl; pwl=pwl->pwlNext) {
+        ui8Hash = hash_elbuf_chain(&pwl->elb, ui8Hash, &siz);
+      }
+    }
+    if (siz > 0) {
+      if (giHashed && ui8Hash==gui8LastHash) {
+        if (giVerbose>0) {warning("The same lines are suppressed\n");}
+        fp = fpDrain;
+      }
+      gui8LastHash = ui8Hash;
+      giHashed     = 1;
+    }
+  }
+
+  /*--- Flush ------------------------------------------------------*/
+  if (gi8Window == 0) {flush_ringbuf(&gstRingBuf,fp);}
+  else                {flush_winbuf( &gstWinBuf ,fp);}
+
+  /*--- Finish -----------------------------------------------------*/
+  return;
+}
+
+/*=== Hash an EL-buffer chain ========================================
+ * [in]  pelbHead : Pointer of the head of the EL-buffer chain
+ *       ui8Hash  : The hash value to be continued (HASH_OFFSET first)
+ * [out] psiz     : The size of the line is added to it
+ * [ret] The hash value updated with the line (64-bit FNV-1a)       */
+uint64_t hash_elbuf_chain(elbuf_t* pelbHead, uint64_t ui8Hash, size_t* psiz) {
+
+  /*--- Variables --------------------------------------------------*/
+  elbuf_t*       pelbCurrent;
+  unsigned char* puc;
+  unsigned char* pucEnd;
+
+  /*--- Hash the chain in the same way as flush_elbuf_chain() ------*/
+  for (pelbCurrent=pelbHead; pelbCurrent; pelbCurrent=pelbCurrent->pelbNext) {
+    if (pelbCurrent->sSize == 0) {break;}
+    puc    = (unsigned char*)pelbCurrent->szBuf;
+    pucEnd = puc + pelbCurrent->sSize;
+    while (puc < pucEnd) {ui8Hash = (ui8Hash ^ *puc++) * HASH_PRIME;}
+    *psiz += pelbCurrent->sSize;
+    if (pelbCurrent->sSize < sizeof(pelbCurrent->szBuf)-1) {break;}
+    if (pelbCurrent->szBuf[pelbCurrent->sSize-1] == '\n' ) {break;}
+  }
+
+  /*--- Return -----------------------------------------------------*/
+  return ui8Hash;
+}
+
+/*=== Flush the lines in the time-window buffer to a file ============
+ * [notice] After flishing, the lines are kept in the spare list for
+ *          the reuse.
+ * [in] pstWinbuf : Pointer of the time-window buffer
+ *      fp        : File handle to output (NULL means dropping them) */
+void flush_winbuf(winbuf_t* pstWinbuf, FILE* fp) {
+
+  /*--- Variables --------------------------------------------------*/
+  winline_t* pwl;
+
+  /*--- Validate the arguments -------------------------------------*/
+  if (! pstWinbuf) {error_exit(1,"flush_winbuf(): pstWinbuf is NULL\n");}
+
+  /*--- Flush the lines from the oldest one ------------------------*/
+  while ((pwl=pstWinbuf->pwlOldest) != NULL) {
+    flush_elbuf_chain(&pwl->elb, fp);
+    pstWinbuf->pwlOldest = pwl->pwlNext;
+    pwl->pwlNext         = pstWinbuf->pwlSpare;
+    pstWinbuf->pwlSpare  = pwl;
+  }
+  pstWinbuf->pwlLatest = NULL;
+
+  /*--- Finish -----------------------------------------------------*/
+  return;
+}
+
 /*=== Release the memory for the EL-buffers except the 1st chunk =====
  * [notice] This function releases ONLY CHUNKS FOLLOWING THE 1ST one.
  *          The 1st chunk of the EL-buffer, which is specified with the
@@ -1290,6 +1736,39 @@ void destroy_ring_buf(ringbuf_t* pstRingbuf) {
   return;
 }
 
+/*=== Free memory of the time-window buffer ==========================
+ * [in] pstWinbuf : The pointer of the time-window buffer to be released */
+void destroy_win_buf(winbuf_t* pstWinbuf) {
+
+  /*--- Variables --------------------------------------------------*/
+  winline_t* pwl;
+  winline_t* pwlNext;
+  int        i;
+
+  /*--- Log --------------------------------------------------------*/
+  if (giVerbose>1) {warning("Enter destroy_win_buf()\n");}
+
+  /*--- Validate the argument --------------------------------------*/
+  if (pstWinbuf == NULL) { return; }
+
+  /*--- Release both of the held lines and the spare ones ----------*/
+  for (i=0; i<2; i++) {
+    pwl = (i==0) ? pstWinbuf->pwlOldest : pstWinbuf->pwlSpare;
+    while (pwl != NULL) {
+      pwlNext = pwl->pwlNext;
+      release_following_elbufs(&pwl->elb);
+      free(pwl);
+      pwl = pwlNext;
+    }
+  }
+  pstWinbuf->pwlOldest = NULL;
+  pstWinbuf->pwlLatest = NULL;
+  pstWinbuf->pwlSpare  = NULL;
+
+  /*--- Return successfully ----------------------------------------*/
+  return;
+}
+
 /*=== Try to make me a realtime process ==============================
  * [in]  iPrio : 0:will not change (just return normally)
  *               1:minimum priority
@@ -1376,10 +1855,13 @@ void term_this_thread(int iSig, siginfo_t *siInfo, void *pct) {pthread_exit(0);}
  * nanosleep().
  * [in]  stTh.i8Param1       : The new parameter the sub-th gave
  * [out] gi8Holdtime         : The new parameter the sub-th gave
+ *       giHoldlines         : The new parameter the sub-th gave
+ *       gi8Window           : The new parameter the sub-th gave
  * [out] gstThCom.iRequested : set to 1 to notify the main-th of the request */
 void recv_param_application_req(int iSig, siginfo_t *siInfo, void *pct) {
   gi8Holdtime            = gstThCom.i8Param1;
   giHoldlines            = gstThCom.iParam1 ;
+  gi8Window              = gstThCom.i8Param2;
   gstThCom.iRequested__main = 1;
   return;
 }
@@ -1422,6 +1904,7 @@ void mainth_destructor(void* pvMainth) {
   /*--- Destroy the ring buffer ------------------------------------*/
   if (giVerbose>0) {warning("RingBuf is destroied\n");}
   destroy_ring_buf(&gstRingBuf);
+  destroy_win_buf( &gstWinBuf );
 
   /*--- Close files ------------------------------------------------*/
   if (pstMainth->fpIn    != NULL) {
@@ -2,19 +2,27 @@
 #
 # PTW - Pseudo Terminal Wrapper
 #
-# USAGE   : ptw [-f] command [argument [...]]
+# USAGE   : ptw [-f] [-w usec] command [argument [...]]
 # Options : -f ... Forcibly wrap the command in a PTY even though the
 #                  command is placed at the end of the pipeline.
 #                  Originally, it isn't necessary to use a PTY because
 #                  the command placed at the end has a TTY-connected
 #                  STDOUT.
+#           -w usec
+#                  Coalescing window in microseconds. The data from the
+#                  command are held for at most "usec" microseconds, or
+#                  until 64KB has accumulated, and then written at once.
+#                  It reduces the write() calls to STDOUT when the
+#                  command prints many short lines, in exchange for the
+#                  bounded latency. With -v, the achieved batching ratio
+#                  (reads per write) is reported at exit.
 # Retuen  : The return value will be decided by the wrapped command
 #           when PTY wrapping has succeed. However, return a non-zero
 #           number by this wrapper when failed.
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2024-06-23
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -34,11 +42,14 @@
 
 /*=== Initial Setting ==============================================*/
 /*--- macro constants ----------------------------------------------*/
-#define BUFSIZE 8192
+#define BUFSIZE     8192    /* initial size of the transceiver buffer  */
+#define BUFSIZE_MAX 1048576 /* the buffer can grow up to this size     */
+#define COALESCE_SIZ 65536  /* flush size for the coalescing window    */
 /*#define RAWMODE_FOR_MASTER*//*set raw mode for master (probably unnecessary)*/
 /*--- headers ------------------------------------------------------*/
 #ifdef __linux__
   #define _XOPEN_SOURCE 600
+  #define _GNU_SOURCE       /* for splice() */
 #endif
 #include <errno.h>
 #include <stdio.h>
@@ -49,7 +60,11 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/select.h>
 #include <signal.h>
+#include <stdint.h>
+#include <time.h>
 #include <sys/wait.h>
 #if (defined(__unix__) || defined(unix)) && !defined(USG)
   #include <sys/param.h> /* get OS identification macro */
@@ -62,31 +77,53 @@
 #if !defined(TABDLY) && defined(OXTABS)
   #define TABDLY OXTABS /* for classiic BSD */
 #endif
+#if !defined(CLOCK_MONOTONIC)
+  #define CLOCK_FOR_ME CLOCK_REALTIME /* for HP-UX */
+#elif defined(__sun) || defined(__SunOS)
+  /* CLOCK_MONOTONIC on Solaris requires privillege */
+  #define CLOCK_FOR_ME CLOCK_REALTIME
+#else
+  #define CLOCK_FOR_ME CLOCK_MONOTONIC
+#endif
+/*--- data type definitions ----------------------------------------*/
+typedef struct timespec tmsp;
 /*--- prototype functions ------------------------------------------*/
 #ifdef RAWMODE_FOR_MASTER
   void restore_master_termios(void);
 #endif
+int  wait_for_input(int iFd, tmsp *ptsDeadline);
+void write_all(char *pszBuf, int iLen);
 /*--- global variables ---------------------------------------------*/
 char*    gpszCmdname;     /* The name of this command                        */
 int      giVerbose;       /* speaks more verbosely by the greater number     */
 int      giForciblepty;   /* set 1 or more to use PTY forcibly               */
 int      giFd1m, giFd1s;  /* PTY file descriptors                            */
+intmax_t gjReads;         /* number of reads from the PTY master             */
+intmax_t gjWrites;        /* number of writes to STDOUT                      */
 struct termios gstTermm;  /* stdin terimios for master                       */
 
 /*=== Define the functions for printing usage and error ============*/
 /*--- exit with usage ----------------------------------------------*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
-    "USAGE   : %s [-f] command [argument [...]]\n"
+    "USAGE   : %s [-f] [-w usec] command [argument [...]]\n"
     "Options : -f ... Forcibly wrap the command in a PTY even though the\n"
     "                 command is placed at the end of the pipeline.\n"
     "                 Originally, it isn't necessary to use a PTY because\n"
     "                 the command placed at the end has a TTY-connected\n"
     "                 STDOUT.\n"
+    "          -w usec\n"
+    "                 Coalescing window in microseconds. The data from the\n"
+    "                 command are held for at most \"usec\" microseconds, or\n"
+    "                 until 64KB has accumulated, and then written at once.\n"
+    "                 It reduces the write() calls to STDOUT when the\n"
+    "                 command prints many short lines, in exchange for the\n"
+    "                 bounded latency. With -v, the achieved batching ratio\n"
+    "                 (reads per write) is reported at exit.\n"
     "Retuen  : The return value will be decided by the wrapped command\n"
     "          when PTY wrapping has succeed. However, return a non-zero\n"
     "          number by this wrapper when failed.\n"
-    "Version : 2024-06-23 13:28:01 JST\n"
+    "Version : 2026-10-18 15:42:30 JST\n"
     "          (POSIX C language with \"POSIX centric\" programming)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -132,8 +169,16 @@ int    iStdinIsATTY;      /* 1 if stdin is a TTY                    */
 struct termios stTerms;   /* PTY slave terimios                     */
 struct winsize stWsizem;  /* stdin window size for master           */
 pid_t    pidMS;           /* PID (master or slave)                  */
-char   szTran[BUFSIZE];   /* for master-slave transceiver           */
-int    i, j, k, l;        /* all-purpose int                        */
+char*  pszTran;           /* buffer for master-slave transceiver    */
+int    iBufsiz;           /* current size of the pszTran            */
+int    iPend;             /* size of the data held in the pszTran   */
+int    iWindow;           /* -w option number (0 means disabled)    */
+tmsp   tsDeadline;        /* time to flush the held data            */
+#ifdef SPLICE_F_MOVE
+  int  iSplice;           /* 1 if splice() is used for transceiving */
+  struct stat stStdout;   /* stat for STDOUT                        */
+#endif
+int    i, j;              /* all-purpose int                        */
 char*  psz;               /* all-purpose char*                      */
 #ifdef __OpenBSD__
   struct sigaction saIgnr;  /* for ignoring SIGHUP during preparation */
@@ -146,16 +191,20 @@ for (i=0; *(gpszCmdname+i)!='\0'; i++) {
 }
 giFd1m=-1;
 giFd1s=-1;
+iWindow=0;
 /*=== Parse arguments ==============================================*/
 #if !defined(__linux__)
-while ((i=getopt(argc, argv,  "fvh")) != -1) {
+while ((i=getopt(argc, argv,  "fw:vh")) != -1) {
 #else
 /* To make Linux complieant POSIX, "+" is required at the head of
    optstring on getopt() for only Linux                            */
-while ((i=getopt(argc, argv, "+fvh")) != -1) {
+while ((i=getopt(argc, argv, "+fw:vh")) != -1) {
 #endif
   switch (i) {
     case 'f': giForciblepty=1; break;
+    case 'w': if (sscanf(optarg,"%d",&iWindow) != 1) {print_usage_and_exit();}
+              if (iWindow < 0                      ) {print_usage_and_exit();}
+              break;
     case 'v': giVerbose++;     break;
     case 'h': print_usage_and_exit();
     default : print_usage_and_exit();
@@ -325,10 +374,57 @@ if (isatty(STDOUT_FILENO) == 1) {
 #endif
 
 /*=== Transceive data from/to the PTY ==============================*/
+/*--- Prepare the buffer -------------------------------------------*/
+iBufsiz = (iWindow>0) ? COALESCE_SIZ : BUFSIZE;
+iPend   = 0;
+if ((pszTran=(char*)malloc(iBufsiz)) == NULL) {
+  error_exit(errno,"malloc() for the buffer: %s\n", strerror(errno));
+}
+/*--- Decide whether to use splice() -------------------------------*/
+#ifdef SPLICE_F_MOVE
+  /* splice() can move the data from the PTY master into STDOUT in the
+     kernel without copying them through the user space, but only when
+     STDOUT is a pipe. Otherwise, read() and write() are used.         */
+  /* The coalescing window requires the data to be held in the user
+     space, so splice() is not used with the -w option.                */
+  iSplice = 0;
+  if (fstat(STDOUT_FILENO, &stStdout) < 0) {
+    error_exit(errno,"fstat() on STDOUT: %s\n", strerror(errno));
+  }
+  if (S_ISFIFO(stStdout.st_mode) && iWindow==0) {
+    iSplice = 1;
+    if (giVerbose > 0) {warning("STDOUT is a pipe. I'll try splice().\n");}
+  }
+#endif
 /*--- Transceive ---------------------------------------------------*/
 iRet = 0;
 while (1) {
-  j = (int)read(giFd1m, szTran, BUFSIZE);
+  /* Flush the held data if no more data come within the window */
+  if (iPend > 0) {
+    if (wait_for_input(giFd1m, &tsDeadline) == 0) {
+      write_all(pszTran, iPend);
+      iPend = 0;
+      continue;
+    }
+  }
+  #ifdef SPLICE_F_MOVE
+    if (iSplice) {
+      j = (int)splice(giFd1m, NULL, STDOUT_FILENO, NULL, BUFSIZE_MAX,
+                      SPLICE_F_MOVE);
+      if (j<0 && errno==EINVAL) {
+        /* Some kernels don't support splice() on a PTY */
+        if (giVerbose > 0) {
+          warning("splice() on mono RX: unsupported, so use read()\n");
+        }
+        iSplice = 0;
+        continue;
+      }
+    } else {
+      j = (int)read(giFd1m, pszTran+iPend, iBufsiz-iPend);
+    }
+  #else
+    j = (int)read(giFd1m, pszTran+iPend, iBufsiz-iPend);
+  #endif
   if (j <0) {
     if (errno != EIO) {
       error_exit(errno,"read() on mono RX: %s\n", strerror(errno));
@@ -340,6 +436,7 @@ while (1) {
     j = 0;
   }
   if (j==0) {
+    if (iPend > 0) {write_all(pszTran, iPend); iPend=0;}
     #ifndef __OpenBSD__
       break;
     #else
@@ -360,15 +457,45 @@ while (1) {
       return iRet;
     #endif
   }
-  k = j;
-  while (k > 0) {
-    l = (int)write(STDOUT_FILENO, szTran+j-k, k);
-    if (l < 0) {error_exit(errno,"write() on mono RX: %s\n",strerror(errno));}
-    k -= l;
+  gjReads++;
+  #ifdef SPLICE_F_MOVE
+    if (iSplice) {gjWrites++; continue;} /* The data have been already written */
+  #endif
+  if (iWindow > 0) {
+    /* Hold the data till the window closes or the buffer is filled */
+    if (iPend == 0) {
+      if (clock_gettime(CLOCK_FOR_ME, &tsDeadline) != 0) {
+        error_exit(errno,"clock_gettime(): %s\n", strerror(errno));
+      }
+      tsDeadline.tv_sec  += iWindow / 1000000;
+      tsDeadline.tv_nsec += (long)(iWindow % 1000000) * 1000;
+      if (tsDeadline.tv_nsec >= 1000000000) {
+        tsDeadline.tv_sec++; tsDeadline.tv_nsec -= 1000000000;
+      }
+    }
+    iPend += j;
+    if (iPend >= iBufsiz) {write_all(pszTran, iPend); iPend=0;}
+    continue;
+  }
+  write_all(pszTran, j);
+  /* A full buffer suggests that the command is chatty. So, enlarge the
+     buffer to reduce the number of the system calls.                   */
+  if (j==iBufsiz && iBufsiz<BUFSIZE_MAX) {
+    if ((psz=(char*)realloc(pszTran, iBufsiz*2)) == NULL) {
+      error_exit(errno,"realloc() for the buffer: %s\n", strerror(errno));
+    }
+    pszTran  = psz;
+    iBufsiz *= 2;
+    if (giVerbose > 1) {warning("buffer size is enlarged to %d\n", iBufsiz);}
   }
 }
 /*--- Close the PTY ------------------------------------------------*/
 close(giFd1m); giFd1m=-1;
+free(pszTran);
+if (giVerbose > 0) {
+  warning("%jd reads, %jd writes (batching ratio %.2f)\n", gjReads, gjWrites,
+          (gjWrites>0) ? (double)gjReads/gjWrites : 0.0);
+}
 
 /*=== Wait for the child to exit ===================================*/
 if (wait(&i) < 0) {error_exit(errno,"wait(): %s\n", strerror(errno));}
@@ -393,3 +520,50 @@ return iRet;}
     }
   }
 #endif
+
+/*=== Wait for the input data till the deadline ======================
+ * [in]  iFd         : File descriptor to wait for
+ *       ptsDeadline : Deadline (by CLOCK_FOR_ME) to give up waiting
+ * [ret] 1 : Some data (or EOF) have arrived
+ *       0 : The deadline has come                                  */
+int wait_for_input(int iFd, tmsp *ptsDeadline) {
+
+  /*--- Variables --------------------------------------------------*/
+  fd_set         fdsRead; /* fd set for select()                     */
+  struct timeval tvLeft;  /* time left till the deadline             */
+  tmsp           tsNow;   /* current time                            */
+  int            i;       /* all-purpose int                         */
+
+  /*--- Wait -------------------------------------------------------*/
+  while (1) {
+    if (clock_gettime(CLOCK_FOR_ME, &tsNow) != 0) {
+      error_exit(errno,"clock_gettime(): %s\n", strerror(errno));
+    }
+    tvLeft.tv_sec  = ptsDeadline->tv_sec - tsNow.tv_sec;
+    i              = (int)(ptsDeadline->tv_nsec - tsNow.tv_nsec);
+    if (i < 0) {tvLeft.tv_sec--; i+=1000000000;}
+    tvLeft.tv_usec = i / 1000;
+    if (tvLeft.tv_sec < 0) {tvLeft.tv_sec=0; tvLeft.tv_usec=0;}
+    FD_ZERO(&fdsRead);
+    FD_SET(iFd, &fdsRead);
+    i = select(iFd+1, &fdsRead, NULL, NULL, &tvLeft);
+    if (i >  0          ) {return 1;}
+    if (i == 0          ) {return 0;}
+    if (errno != EINTR  ) {error_exit(errno,"select(): %s\n",strerror(errno));}
+  }
+}
+
+/*=== Write all the data into STDOUT =================================
+ * [in]  pszBuf : Data to write
+ *       iLen   : Size of the data                                  */
+void write_all(char *pszBuf, int iLen) {
+  int i;
+  while (iLen > 0) {
+    i = (int)write(STDOUT_FILENO, pszBuf, iLen);
+    if (i < 0) {error_exit(errno,"write() on mono RX: %s\n",strerror(errno));}
+    pszBuf += i;
+    iLen   -= i;
+  }
+  gjWrites++;
+  return;
+}
@@ -2,8 +2,14 @@
 #
 # QVALVE - Quantitative Valve for the UNIX Pipeline
 #
-# USAGE   : qvalve [-c|-l] [-t] [-1] [-p n] quantity [file [...]]
-#           qvalve [-c|-l] [-t] [-1] [-p n] controlfile [file [...]]
+# USAGE   : qvalve [-c|-l] [-t] [-1] [-m statsfile] [-S statusfile] [-p n]
+#                  [-L] [-C cpu] quantity [file [...]]
+#           qvalve [-c|-l] [-t] [-1] [-m statsfile] [-S statusfile] [-p n]
+#                  [-L] [-C cpu] controlfile [file [...]]
+#           qvalve [-c|-l] [-1] [-m statsfile] [-S statusfile] [-p n]
+#                  [-L] [-C cpu] -s creditfile [file [...]]
+#           qvalve -o output [-o output [...]] [-b rr|ll] [other options]
+#                  {quantity|controlfile|-s creditfile} [file [...]]
 # Args    : quantity ...  * Quantity this command allows to pass through.
 #                         * The quantity is the number of bytes (for the
 #                           -c option) or lines (for the -l option).
@@ -96,6 +102,10 @@
 #           -l .......... * The unit of the quantity will be set to
 #                           "line."
 #                         * The -c option will be disabled by this option.
+#                         * The lines are counted by the block read, and
+#                           all the lines the quantity allows are written
+#                           at once. So, it can pass lines as fast as the
+#                           memory bandwidth when enough quantity is left.
 #           -t .......... * Terminate this command when the control file
 #                           is closed. After the termination, the standard
 #                           I/O pipeline will be destroyed, and the
@@ -116,6 +126,89 @@
 #                           outputting the incoming data.
 #                         * This option might work as a starter of the
 #                           system embedding this command.
+#                         * With the -o option, every output gets it.
+#           -o output ... * Distribute the lines to the outputs instead of
+#                           the stdout (fan-out). Give this option once for
+#                           each output. Each line goes to only one of them.
+#                         * When you set an integer, this command regards
+#                           it as a file descriptor number. Otherwise, it
+#                           is a filepath (e.g. a named pipe). Add "./"
+#                           before a numerical filename, like "./3."
+#                         * A regular file given by the filepath is
+#                           truncated (made if not exists) at start, as
+#                           ">" does. A file descriptor is used as it is.
+#                         * The unit of the quantity is always "line" with
+#                           this option (-c is ignored), and the quantity
+#                           is shared by all the outputs. So, the quantity,
+#                           controlfile or creditfile governs the total
+#                           throughput of them.
+#                         * The lines assigned to an output are written at
+#                           once by writev(). An output which is not read
+#                           blocks the others when its pipe is full.
+#           -b policy ... * The policy to choose the output for each line
+#                           (for the -o option)
+#                             "rr" .. (Default) Round-robin
+#                             "ll" .. Least-loaded. The line goes to the
+#                                     output whose pipe is filled the least
+#                                     (the bytes unread / the size of the
+#                                     pipe), counting the lines assigned
+#                                     just before. So, slower readers get
+#                                     fewer lines.
+#           -m statsfile  * Write a snapshot of the live counters (bytes,
+#                           lines, times waiting for the quantity, etc.)
+#                           into the file every second, when SIGUSR1
+#                           comes, and at exit.
+#                         * A regular file always has only the latest
+#                           one, and a named pipe gets a line for each
+#                           snapshot.
+#                         * Without this option, a snapshot is written
+#                           into the stderr only when SIGUSR1 comes.
+#           -s creditfile * Get the quantity from the credit counter in
+#                           the creditfile instead of the quantity or
+#                           controlfile argument. Other processes can
+#                           give this command credits (the quantity) by
+#                           only an atomic addition to the counter with
+#                           no text parsing, so it is for giving credits
+#                           thousands of times per second.
+#                         * The creditfile is a 64-byte regular file,
+#                           which this command makes if not exists.
+#                           Processes have to mmap() it with MAP_SHARED.
+#                           The layout is the following (native endian).
+#                             offset  0: char[8]  "QVCREDIT" (magic)
+#                             offset  8: uint64_t credit counter
+#                             offset 16: uint32_t wake-up sequence
+#                             offset 20: uint32_t waiting flag
+#                             offset 24: uint32_t termination flag
+#                         * To give n credits, add n to the credit
+#                           counter atomically. Then, only when the
+#                           waiting flag is not 0, increment the wake-up
+#                           sequence and wake this command up by
+#                           FUTEX_WAKE on it (Linux). On other systems,
+#                           this command checks the counter every 1ms
+#                           while waiting, and no wake-up is needed.
+#                         * Setting the termination flag to 1 works as
+#                           the "t" command (and wake this command up).
+#                         * The remaining credits stay in the file
+#                           after this command exits.
+#                         * The -t option cannot be used with this option.
+#                           Set the termination flag instead.
+#           -S statusfile * Keep the accounting of the quantity in the
+#                           statusfile, which is a 64-byte regular file
+#                           (re-created at start) to mmap() or read. The
+#                           layout is the following (native endian).
+#                             offset  0: char[8]  "QVSTATUS" (magic)
+#                             offset  8: uint64_t quantity remaining
+#                             offset 16: uint64_t quantity consumed
+#                             offset 24: uint64_t time blocked waiting
+#                                                 for quantity (in ns)
+#                             offset 32: uint64_t times blocked
+#                             offset 40: uint32_t unit (0:byte 1:line)
+#                             offset 44: uint32_t process ID
+#                         * Each field is updated by a plain memory store
+#                           and costs no system call. With the -s option,
+#                           the quantity remaining is what was left in
+#                           the creditfile the last time this command
+#                           took credits.
 #           -p n ........ * Process priority setting [0-3] (if possible)
 #                            0: Normal process
 #                            1: Weakest realtime process (default)
@@ -126,11 +219,19 @@
 #                           but if failed, it will try the smaller numbers.
 #                         * An administrative privilege might be required to
 #                           use this option.
+#           -L .......... * Lock the memory of this command into the RAM
+#                           after pre-faulting the stack, so that no page
+#                           fault delays it in the realtime mode. A large
+#                           enough "ulimit -l" or a privileged user might
+#                           be required.
+#           -C cpu ...... * Run this command only on the CPU #cpu (from 0)
+#                           to avoid the migration between CPUs. (for only
+#                           Linux) An isolated CPU gives the best result.
 # Retuen  : Return 0 only when finished successfully
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-03-13
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -151,6 +252,9 @@
 /*=== Initial Setting ==============================================*/
 
 /*--- headers ------------------------------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  #define _GNU_SOURCE /* for sched_setaffinity() */
+#endif
 #include <limits.h>
 #include <errno.h>
 #include <stdio.h>
@@ -161,6 +265,8 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
 #include <time.h>
 #include <fcntl.h>
 #include <pthread.h>
@@ -171,16 +277,56 @@
   #include <sched.h>
   #include <sys/resource.h>
 #endif
+#include <sys/mman.h>
+#if defined(__linux__)
+  #include <sys/syscall.h>
+  #include <linux/futex.h>
+#endif
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  #include <arm_neon.h>
+#endif
+#include "stats.h"
+#include "rtmem.h"
 
 /*--- macro constants ----------------------------------------------*/
 /* Interval time of looking at the parameter on the control file */
 #define FREAD_ITRVL_SEC  0
 #define FREAD_ITRVL_USEC 100000
 #define FREAD_ITRVL_NSEC 100000000
-/* Buffer size for the read_1line() */
-#define LINE_BUF 1024
+/* Buffer size for reading blocks in the line mode */
+#define LINE_BUF 65536
+/* Max number of the iovecs for a writev() to an output (-o option) */
+#if defined(IOV_MAX) && IOV_MAX < 64
+  #define FANOUT_IOV IOV_MAX
+#else
+  #define FANOUT_IOV 64
+#endif
+/* Size of a pipe assumed when the OS doesn't tell it (-o option) */
+#define FANOUT_PIPE_DEFAULT 65536
 /* Buffer size for the control file */
 #define CTRL_FILE_BUF 64
+/* The magic string at the top of the creditfile */
+#define CREDIT_MAGIC "QVCREDIT"
+/* Max time to wait for credits without checking the flags (in ms) */
+#define CREDIT_WAIT_MSEC 100
+/* Polling interval to wait for credits without futex (in ns) */
+#define CREDIT_POLL_NSEC 1000000
+/* The magic string at the top of the statusfile */
+#define STATUS_MAGIC "QVSTATUS"
+/* Store a value into a field of the statusfile */
+#if defined(__ATOMIC_RELAXED)
+  #define STATUS_STORE(p,v) __atomic_store_n((p),(v),__ATOMIC_RELAXED)
+#else
+  #define STATUS_STORE(p,v) (*(volatile __typeof__(*(p))*)(p)=(v))
+#endif
+/* The clock for measuring the blocked time */
+#if defined(CLOCK_MONOTONIC)
+  #define CLOCK_FOR_ME CLOCK_MONOTONIC
+#else
+  #define CLOCK_FOR_ME CLOCK_REALTIME
+#endif
 
 /*--- data type definitions ----------------------------------------*/
 typedef struct timespec tmsp;
@@ -191,6 +337,33 @@ typedef struct _thrcom_t {
   size_t          sizQty;           /* The quantity counter                   */
   int             iTerm_req;        /* Request flag to terminate this command */
 } thcominfo_t;
+typedef struct _creditch_t {
+  char            szMagic[8];       /* CREDIT_MAGIC (not terminated by NUL)   */
+  uint64_t        ui8Credit;        /* The credit counter                     */
+  uint32_t        ui4Seq;           /* Wake-up sequence (futex word)          */
+  uint32_t        ui4Waiting;       /* 1 while this command is waiting        */
+  uint32_t        ui4Term;          /* Set 1 to terminate this command        */
+  char            cPad[36];         /* Padding to be 64 bytes                 */
+} creditch_t;
+typedef struct _status_t {
+  char            szMagic[8];       /* STATUS_MAGIC (not terminated by NUL)   */
+  uint64_t        ui8Remaining;     /* Quantity remaining                     */
+  uint64_t        ui8Consumed;      /* Quantity consumed                      */
+  uint64_t        ui8Blocked_ns;    /* Time blocked waiting for the quantity  */
+  uint64_t        ui8Blocked_num;   /* Times blocked                          */
+  uint32_t        ui4Unit;          /* 0:byte 1:line                          */
+  uint32_t        ui4Pid;           /* Process ID                             */
+  char            cPad[16];         /* Padding to be 64 bytes                 */
+} status_t;
+typedef struct _fanout_t {
+  int             iFd;              /* File descriptor of the output          */
+  char*           pszName;          /* Name of the output (for message)       */
+  int             iIsPipe;          /* 1 if the output is a pipe              */
+  size_t          sizPipe;          /* Size of the pipe                       */
+  size_t          sizLoad;          /* Bytes unread + bytes assigned just now */
+  int             iIovnum;          /* The number of the iovecs to write      */
+  struct iovec    iov[FANOUT_IOV];  /* The lines assigned to the output       */
+} fanout_t;
 typedef struct _thrmain_t {
   pthread_t       tSubth_id;        /* sub thread ID                          */
   int             iMu_isready;      /* Set 1 when mu has been initialized     */
@@ -204,7 +377,22 @@ void update_periodic_time_type_r(char* pszCtrlfile);
 void update_periodic_time_type_c(char* pszCtrlfile);
 int parse_quantity(char* pszArg, size_t* psiz);
 int change_to_rtprocess(int iPrio);
-int read_1line(FILE *fp);
+int pass_lines(int iFd);
+size_t count_lf(const char* pc, size_t siz);
+size_t find_nth_lf(const char* pc, size_t siz, size_t sizNth);
+void write_all(int iFd, const char* pc, size_t siz);
+void open_outputs(void);
+int fanout_lines(const char* pc, size_t siz);
+int least_loaded_output(void);
+void measure_load(fanout_t* pstOut);
+void flush_output(fanout_t* pstOut);
+size_t take_quantity(size_t sizWant);
+void open_creditch(char* pszCreditfile);
+size_t take_credits(size_t sizWant);
+void wait_for_credits(uint32_t ui4Seq);
+void open_statusfile(char* pszStatusfile, int iUnit);
+void status_remaining(uint64_t ui8Remaining);
+void status_blocked(tmsp* ptsFrom);
 void term_request(int iSig, siginfo_t *siInfo, void *pct);
 void do_nothing(int iSig, siginfo_t *siInfo, void *pct);
 #ifdef __ANDROID__
@@ -220,6 +408,15 @@ struct stat gstCtrlfile;  /* stat for the control file                       */
 int      giRecovery;      /* 0:normal 1:Recovery mode                        */
 int      giVerbose;       /* speaks more verbosely by the greater number     */
 thcominfo_t gstThCom;     /* Variables for threads communication             */
+creditch_t* gpstCredit;   /* The mmap'd creditfile (NULL unless -s)          */
+status_t* gpstStatus;     /* The mmap'd statusfile (NULL unless -S)          */
+uint64_t gui8Consumed;    /* Quantity consumed (for the statusfile)          */
+fanout_t* gpstOut;        /* The outputs (NULL unless -o)                    */
+int      giOutnum;        /* The number of the outputs                       */
+int      giPolicy;        /* -b option (0:round-robin 1:least-loaded)        */
+char     gcStdiobuf[3][BUFSIZ]; /* Buffers for the stdio streams (for stdin,
+                           * the other input files and stdout). They are
+                           * static to be pre-faulted/locked by -L.          */
 
 /*=== Define the functions for printing usage and error ============*/
 
@@ -227,11 +424,23 @@ thcominfo_t gstThCom;     /* Variables for threads communication             */
 void print_usage_and_exit(void) {
   fprintf(stderr,
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
-    "USAGE   : %s [-c|-l] [-t] [-p n] quantity [file [...]]\n"
-    "          %s [-c|-l] [-t] [-p n] controlfile [file [...]]\n"
+    "USAGE   : %s [-c|-l] [-t] [-1] [-m statsfile] [-S statusfile] [-p n]\n"
+    "                 [-L] [-C cpu] quantity [file [...]]\n"
+    "          %s [-c|-l] [-t] [-1] [-m statsfile] [-S statusfile] [-p n]\n"
+    "                 [-L] [-C cpu] controlfile [file [...]]\n"
+    "          %s [-c|-l] [-1] [-m statsfile] [-S statusfile] [-p n]\n"
+    "                 [-L] [-C cpu] -s creditfile [file [...]]\n"
+    "          %s -o output [-o output [...]] [-b rr|ll] [other options]\n"
+    "                 {quantity|controlfile|-s creditfile} [file [...]]\n"
 #else
-    "USAGE   : %s [-c|-l] [-t] quantity [file [...]]\n"
-    "          %s [-c|-l] [-t] controlfile [file [...]]\n"
+    "USAGE   : %s [-c|-l] [-t] [-1] [-m statsfile] [-S statusfile]\n"
+    "                 quantity [file [...]]\n"
+    "          %s [-c|-l] [-t] [-1] [-m statsfile] [-S statusfile]\n"
+    "                 controlfile [file [...]]\n"
+    "          %s [-c|-l] [-1] [-m statsfile] [-S statusfile]\n"
+    "                 -s creditfile [file [...]]\n"
+    "          %s -o output [-o output [...]] [-b rr|ll] [other options]\n"
+    "                 {quantity|controlfile|-s creditfile} [file [...]]\n"
 #endif
     "Args    : quantity ...  * Quantity this command allows to pass through.\n"
     "                        * The quantity is the number of bytes (for the\n"
@@ -325,6 +534,10 @@ void print_usage_and_exit(void) {
     "          -l .......... * The unit of the quantity will be set to\n"
     "                          \"line.\"\n"
     "                        * The -c option will be disabled by this option.\n"
+    "                        * The lines are counted by the block read, and\n"
+    "                          all the lines the quantity allows are written\n"
+    "                          at once. So, it can pass lines as fast as the\n"
+    "                          memory bandwidth when enough quantity is left.\n"
     "          -t .......... * Terminate this command when the control file\n"
     "                          is closed. After the termination, the standard\n"
     "                          I/O pipeline will be destroyed, and the\n"
@@ -345,6 +558,89 @@ void print_usage_and_exit(void) {
     "                          outputting the incoming data.\n"
     "                        * This option might work as a starter of the\n"
     "                          system embedding this command.\n"
+    "                        * With the -o option, every output gets it.\n"
+    "          -o output ... * Distribute the lines to the outputs instead of\n"
+    "                          the stdout (fan-out). Give this option once for\n"
+    "                          each output. Each line goes to only one of them.\n"
+    "                        * When you set an integer, this command regards\n"
+    "                          it as a file descriptor number. Otherwise, it\n"
+    "                          is a filepath (e.g. a named pipe). Add \"./\"\n"
+    "                          before a numerical filename, like \"./3.\"\n"
+    "                        * A regular file given by the filepath is\n"
+    "                          truncated (made if not exists) at start, as\n"
+    "                          \">\" does. A file descriptor is used as it is.\n"
+    "                        * The unit of the quantity is always \"line\" with\n"
+    "                          this option (-c is ignored), and the quantity\n"
+    "                          is shared by all the outputs. So, the quantity,\n"
+    "                          controlfile or creditfile governs the total\n"
+    "                          throughput of them.\n"
+    "                        * The lines assigned to an output are written at\n"
+    "                          once by writev(). An output which is not read\n"
+    "                          blocks the others when its pipe is full.\n"
+    "          -b policy ... * The policy to choose the output for each line\n"
+    "                          (for the -o option)\n"
+    "                            \"rr\" .. (Default) Round-robin\n"
+    "                            \"ll\" .. Least-loaded. The line goes to the\n"
+    "                                    output whose pipe is filled the least\n"
+    "                                    (the bytes unread / the size of the\n"
+    "                                    pipe), counting the lines assigned\n"
+    "                                    just before. So, slower readers get\n"
+    "                                    fewer lines.\n"
+    "          -m statsfile  * Write a snapshot of the live counters (bytes,\n"
+    "                          lines, times waiting for the quantity, etc.)\n"
+    "                          into the file every second, when SIGUSR1\n"
+    "                          comes, and at exit.\n"
+    "                        * A regular file always has only the latest\n"
+    "                          one, and a named pipe gets a line for each\n"
+    "                          snapshot.\n"
+    "                        * Without this option, a snapshot is written\n"
+    "                          into the stderr only when SIGUSR1 comes.\n"
+    "          -s creditfile * Get the quantity from the credit counter in\n"
+    "                          the creditfile instead of the quantity or\n"
+    "                          controlfile argument. Other processes can\n"
+    "                          give this command credits (the quantity) by\n"
+    "                          only an atomic addition to the counter with\n"
+    "                          no text parsing, so it is for giving credits\n"
+    "                          thousands of times per second.\n"
+    "                        * The creditfile is a 64-byte regular file,\n"
+    "                          which this command makes if not exists.\n"
+    "                          Processes have to mmap() it with MAP_SHARED.\n"
+    "                          The layout is the following (native endian).\n"
+    "                            offset  0: char[8]  \"QVCREDIT\" (magic)\n"
+    "                            offset  8: uint64_t credit counter\n"
+    "                            offset 16: uint32_t wake-up sequence\n"
+    "                            offset 20: uint32_t waiting flag\n"
+    "                            offset 24: uint32_t termination flag\n"
+    "                        * To give n credits, add n to the credit\n"
+    "                          counter atomically. Then, only when the\n"
+    "                          waiting flag is not 0, increment the wake-up\n"
+    "                          sequence and wake this command up by\n"
+    "                          FUTEX_WAKE on it (Linux). On other systems,\n"
+    "                          this command checks the counter every 1ms\n"
+    "                          while waiting, and no wake-up is needed.\n"
+    "                        * Setting the termination flag to 1 works as\n"
+    "                          the \"t\" command (and wake this command up).\n"
+    "                        * The remaining credits stay in the file\n"
+    "                          after this command exits.\n"
+    "                        * The -t option cannot be used with this option.\n"
+    "                          Set the termination flag instead.\n"
+    "          -S statusfile * Keep the accounting of the quantity in the\n"
+    "                          statusfile, which is a 64-byte regular file\n"
+    "                          (re-created at start) to mmap() or read. The\n"
+    "                          layout is the following (native endian).\n"
+    "                            offset  0: char[8]  \"QVSTATUS\" (magic)\n"
+    "                            offset  8: uint64_t quantity remaining\n"
+    "                            offset 16: uint64_t quantity consumed\n"
+    "                            offset 24: uint64_t time blocked waiting\n"
+    "                                                for quantity (in ns)\n"
+    "                            offset 32: uint64_t times blocked\n"
+    "                            offset 40: uint32_t unit (0:byte 1:line)\n"
+    "                            offset 44: uint32_t process ID\n"
+    "                        * Each field is updated by a plain memory store\n"
+    "                          and costs no system call. With the -s option,\n"
+    "                          the quantity remaining is what was left in\n"
+    "                          the creditfile the last time this command\n"
+    "                          took credits.\n"
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
     "          -p n ........ * Process priority setting [0-3] (if possible)\n"
     "                           0: Normal process\n"
@@ -356,9 +652,17 @@ void print_usage_and_exit(void) {
     "                          but if failed, it will try the smaller numbers.\n"
     "                        * An administrative privilege might be required to\n"
     "                          use this option.\n"
+    "          -L .......... * Lock the memory of this command into the RAM\n"
+    "                          after pre-faulting the stack, so that no page\n"
+    "                          fault delays it in the realtime mode. A large\n"
+    "                          enough \"ulimit -l\" or a privileged user might\n"
+    "                          be required.\n"
+    "          -C cpu ...... * Run this command only on the CPU #cpu (from 0)\n"
+    "                          to avoid the migration between CPUs. (for only\n"
+    "                          Linux) An isolated CPU gives the best result.\n"
 #endif
     "Retuen  : Return 0 only when finished successfully\n"
-    "Version : 2025-03-13 21:55:01 JST\n"
+    "Version : 2026-10-18 23:35:52 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -366,7 +670,7 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/tokideli\n"
-    ,gpszCmdname,gpszCmdname);
+    ,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname);
   exit(1);
 }
 
@@ -404,14 +708,18 @@ sigset_t ssMask;          /* blocking signal list for the main thread*/
 int      iUnit;           /* 0:character 1:line 2-:undefined        */
 int      iOpt_1;          /* -1 option flag (default 0)             */
 int      iPrio;           /* -p option number (default 1)           */
+int      iCpu;            /* -C option number (-1:not pinned)       */
+int      iMlock;          /* 1 if -L option is given                */
 int      iRet;            /* return code                            */
-int      iRet_r1l;        /* return value by read_1line()           */
 char    *pszPath;         /* filepath on arguments                  */
 char    *pszFilename;     /* filepath (for message)                 */
+char    *pszStatfile;     /* statistics file (for the -m option)    */
+char    *pszCreditfile;   /* creditfile (for the -s option)         */
+char    *pszStatusfile;   /* statusfile (for the -S option)         */
 int      iFileno;         /* file# of filepath                      */
 int      iFd;             /* file descriptor                        */
 size_t   siz;             /* all-purpose size_t                     */
-int      i, j;            /* all-purpose int                        */
+int      i;               /* all-purpose int                        */
 thmaininfo_t stMainth;    /* Variables required in handler functions*/
 
 /*--- Initialize ---------------------------------------------------*/
@@ -430,20 +738,50 @@ setlocale(LC_CTYPE, "");
 iUnit     =0;
 iOpt_1    =0;
 iPrio     =1;
+iCpu      =-1;
+iMlock    =0;
 giOpt_t   =0;
 giVerbose =0;
 giRecovery=1;
+pszStatfile=NULL;
+pszCreditfile=NULL;
+pszStatusfile=NULL;
+gpstOut   =NULL;
+giOutnum  =0;
+giPolicy  =0;
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "cl1tp:vh")) != -1) {
+while ((i=getopt(argc, argv, "cl1to:b:m:p:LC:s:S:vh")) != -1) {
   switch (i) {
     case 'c': iUnit   = 0;    break;
     case 'l': iUnit   = 1;    break;
     case '1': iOpt_1  = 1;    break;
     case 't': giOpt_t = 1;    break;
+    case 'o': if (gpstOut == NULL) {
+                /* the outputs can't be more than the arguments */
+                if ((gpstOut=calloc(argc,sizeof(fanout_t))) == NULL) {
+                  error_exit(errno,"calloc() in main(): %s\n",strerror(errno));
+                }
+              }
+              gpstOut[giOutnum++].pszName = optarg;
+              break;
+    case 'b': if      (strcmp(optarg,"rr")==0) {giPolicy = 0;          }
+              else if (strcmp(optarg,"ll")==0) {giPolicy = 1;          }
+              else                             {print_usage_and_exit();}
+              break;
+    case 'm': pszStatfile = optarg;
+              break;
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
     case 'p': if (sscanf(optarg,"%d",&iPrio) != 1) {print_usage_and_exit();}
               break;
+    case 'L': iMlock = 1;     break;
+    case 'C': if (sscanf(optarg,"%d",&iCpu) != 1) {print_usage_and_exit();}
+              if (iCpu < 0                       ) {print_usage_and_exit();}
+              break;
 #endif
+    case 's': pszCreditfile = optarg;
+              break;
+    case 'S': pszStatusfile = optarg;
+              break;
     case 'v': giVerbose++;    break;
     case 'h': print_usage_and_exit();
     default : print_usage_and_exit();
@@ -452,13 +790,28 @@ while ((i=getopt(argc, argv, "cl1tp:vh")) != -1) {
 argc -= optind-1;
 argv += optind  ;
 if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
-if (argc < 2) {print_usage_and_exit();}
+if (argc < 2 && pszCreditfile==NULL) {print_usage_and_exit();}
+if (giOpt_t   && pszCreditfile!=NULL) {print_usage_and_exit();}
+if (giOutnum > 0) {iUnit = 1;} /* a line must not be split into outputs */
+/*--- Start the statistics thread before any other threads ---------*/
+stats_start(gpszCmdname, pszStatfile);
 /*--- Prepare the thread operation ---------------------------------*/
 memset(&gstThCom, 0, sizeof(gstThCom    ));
 memset(&stMainth, 0, sizeof(thmaininfo_t));
 pthread_cleanup_push(mainth_destructor, &stMainth);
+/*--- Open the statusfile ------------------------------------------*/
+if (pszStatusfile != NULL) {open_statusfile(pszStatusfile, iUnit);}
+/*--- Open the outputs ---------------------------------------------*/
+if (giOutnum > 0) {open_outputs();}
 /*--- Parse the periodic time --------------------------------------*/
-i = parse_quantity(argv[0], &siz);
+if (pszCreditfile != NULL) {
+  /* The quantity comes from the creditfile (no quantity argument) */
+  open_creditch(pszCreditfile);
+  i   = 1;
+  siz = 0;
+} else {
+  i = parse_quantity(argv[0], &siz);
+}
 if (i <= 0) {
   /* Set the initial parameter, the Quantity is zero. */
   gstThCom.sizQty=0;
@@ -512,9 +865,12 @@ if (i <= 0) {
   }
 } else {
   gstThCom.sizQty = siz;
+  status_remaining(siz);
+}
+if (pszCreditfile == NULL) {
+  argc--;
+  argv++;
 }
-argc--;
-argv++;
 
 /*=== Switch buffer mode ===========================================*/
 switch (iUnit) {
@@ -524,7 +880,7 @@ switch (iUnit) {
             }
             break;
   case 1:
-            if (setvbuf(stdout,NULL,_IOLBF,0)!=0) {
+            if (setvbuf(stdout,gcStdiobuf[2],_IOLBF,BUFSIZ)!=0) {
               error_exit(255,"Failed to switch to line-buffered mode\n");
             }
             break;
@@ -532,20 +888,26 @@ switch (iUnit) {
             error_exit(255,"main() #1: Invalid unit type\n");
             break;
 }
+if (setvbuf(stdin,gcStdiobuf[0],_IOFBF,BUFSIZ)!=0) {
+  error_exit(255,"Failed to give stdin the buffer\n");
+}
 
 /*=== Try to make me a realtime process ============================*/
 if (change_to_rtprocess(iPrio)==-1) {print_usage_and_exit();}
+if (iCpu >= 0) {rtmem_pin_cpu(iCpu);}
+if (iMlock   ) {rtmem_prefault(gcStdiobuf,sizeof(gcStdiobuf));
+                rtmem_lock();                                  }
 
 /*=== Output the starter charater/line when -1 is enabled ==========*/
-if (iOpt_1 && putchar('\n')==EOF) {
+if (iOpt_1 && gpstOut==NULL && putchar('\n')==EOF) {
   error_exit(errno, "putchar() in main() #0: %s\n", strerror(errno));
 }
+for (i=0; iOpt_1 && i<giOutnum; i++) {write_all(gpstOut[i].iFd, "\n", 1);}
 
 /*=== Each file loop ===============================================*/
 iRet          =  0;
 iFileno       =  0;
 iFd           = -1;
-iRet_r1l      =  0;
 while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
 
   /*--- Open one of the input files --------------------------------*/
@@ -567,6 +929,9 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
     if (feof(stdin)) {clearerr(stdin);} /* Reset EOF condition when stdin */
   } else                   {
     stMainth.fpIn = fdopen(iFd, "r");
+    if (setvbuf(stMainth.fpIn,gcStdiobuf[1],_IOFBF,BUFSIZ)!=0) {
+      error_exit(255,"%s: Failed to give the buffer\n",pszFilename);
+    }
   }
 
   /*--- Reading and writing loop -----------------------------------*/
@@ -574,31 +939,14 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
     case 0:
               errno = 0;
               while ((i=getc(stMainth.fpIn)) != EOF) {
-                if ((j=pthread_mutex_lock(&gstThCom.mu))                != 0) {
-                  error_exit(j,
-                             "pthread_mutex_lock() in main() #1: %s\n",
-                             strerror(j)                               );
-                }
-                while (gstThCom.sizQty==0 && gstThCom.iTerm_req==0) {
-                  if ((j=pthread_cond_wait(&gstThCom.co, &gstThCom.mu)) != 0) {
-                    error_exit(j,
-                               "pthread_cond_wait() in main() #1: %s\n",
-                               strerror(j)                              );
-                  }
-                }
-                gstThCom.sizQty--;
-                if ((j=pthread_mutex_unlock(&gstThCom.mu))              != 0) {
-                  error_exit(j,
-                             "pthread_mutex_unlock() in main() #1: %s\n",
-                             strerror(j)                                 );
-                }
-                if (gstThCom.iTerm_req) {mainth_destructor(&stMainth);
-                                         return(iRet);                }
+                if (take_quantity(1) == 0) {mainth_destructor(&stMainth);
+                                            return(iRet);                }
                 while (putchar(i)==EOF) {
                   error_exit(errno,
                              "putchar() in main() #1: %s\n",
                              strerror(errno)                );
                 }
+                stats_pass(1,(i=='\n'));
               }
               if (ferror(stMainth.fpIn) && errno==EINTR) {
                 mainth_destructor(&stMainth);
@@ -606,39 +954,14 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
               }
               break;
     case 1:
-              errno = 0;
-              while ((i=getc(stMainth.fpIn)) != EOF) {
-                if ((j=pthread_mutex_lock(&gstThCom.mu))                != 0) {
-                  error_exit(j,
-                             "pthread_mutex_lock() in main() #2: %s\n",
-                             strerror(j)                               );
-                }
-                while (gstThCom.sizQty==0 && gstThCom.iTerm_req==0) {
-                  if ((j=pthread_cond_wait(&gstThCom.co, &gstThCom.mu)) != 0) {
-                    error_exit(j,
-                               "pthread_cond_wait() in main() #2: %s\n",
-                               strerror(j)                              );
-                  }
-                }
-                gstThCom.sizQty--;
-                if ((j=pthread_mutex_unlock(&gstThCom.mu))              != 0) {
-                  error_exit(j,
-                             "pthread_mutex_unlock() in main() #2: %s\n",
-                             strerror(j)                                 );
-                }
-                if (gstThCom.iTerm_req) {mainth_destructor(&stMainth);
-                                         return(iRet);                }
-                while (putchar(i)==EOF) {
-                  error_exit(errno,
-                             "putchar() in main() #2: %s\n",
-                             strerror(errno)                );
-                }
-                if (read_1line(stMainth.fpIn) != 0) {break;}
-              }
-              if (ferror(stMainth.fpIn) && errno==EINTR) {
+              if ((i=pass_lines(fileno(stMainth.fpIn))) == 0) {
                 mainth_destructor(&stMainth);
                 return(iRet);
               }
+              if (i < 0) {
+                warning("%s: %s\n",pszFilename,strerror(errno));
+                iRet = 1;
+              }
               break;
     default:
               error_exit(255,"main(): Invalid unit type\n");
@@ -658,6 +981,595 @@ return(iRet);}
 
 
 
+/*####################################################################
+# Quantity Consumer
+####################################################################*/
+
+/*=== Take the quantity to pass the data through =====================
+ * Wait until any quantity is left, and take it.
+ * [in]  sizWant : The quantity wanted (>=1)
+ * [ret] >0 : The quantity taken (<=sizWant)
+ *       =0 : This command has been requested to terminate          */
+size_t take_quantity(size_t sizWant) {
+
+  /*--- Variables --------------------------------------------------*/
+  tmsp   ts;
+  size_t siz;
+  int    i;
+
+  /*--- Take it from the creditfile in the -s mode -----------------*/
+  if (gpstCredit != NULL) {return take_credits(sizWant);}
+
+  /*--- Take it from the counter the sub-th updates ----------------*/
+  if ((i=pthread_mutex_lock(&gstThCom.mu))                != 0) {
+    error_exit(i,"pthread_mutex_lock() in take_quantity(): %s\n",strerror(i));
+  }
+  if (gstThCom.sizQty==0 && gstThCom.iTerm_req==0 && gpstStatus) {
+    clock_gettime(CLOCK_FOR_ME, &ts);
+  }
+  while (gstThCom.sizQty==0 && gstThCom.iTerm_req==0) {
+    stats_add(ST_SLEEPS,1);
+    if ((i=pthread_cond_wait(&gstThCom.co, &gstThCom.mu)) != 0) {
+      error_exit(i,"pthread_cond_wait() in take_quantity(): %s\n",
+                 strerror(i)                                      );
+    }
+    if (gstThCom.sizQty>0 || gstThCom.iTerm_req) {status_blocked(&ts);}
+  }
+  siz = (gstThCom.sizQty<sizWant) ? gstThCom.sizQty : sizWant;
+  gstThCom.sizQty -= siz;
+  if (gpstStatus) {
+    gui8Consumed += siz;
+    STATUS_STORE(&gpstStatus->ui8Consumed , gui8Consumed   );
+    STATUS_STORE(&gpstStatus->ui8Remaining, gstThCom.sizQty);
+  }
+  if ((i=pthread_mutex_unlock(&gstThCom.mu))              != 0) {
+    error_exit(i,"pthread_mutex_unlock() in take_quantity(): %s\n",
+               strerror(i)                                         );
+  }
+  return (gstThCom.iTerm_req) ? 0 : siz;
+}
+
+
+
+/*####################################################################
+# Line Engine (-l option)
+####################################################################*/
+
+/*=== Pass the lines through as the quantity allows ==================
+ * Read a block, count the LFs in it, take the quantity for all of the
+ * lines at once, and write the span of the lines taken by one write()
+ * (or distribute it to the outputs for the -o option).
+ * A line is counted when its first char comes, as the char mode does,
+ * so the rest of the line goes without any quantity.
+ * [in]  iFd : File descriptor of the input file
+ * [ret] 1 : Reached the EOF
+ *       0 : This command has been requested to terminate
+ *      -1 : Failed to read (see errno)                             */
+int pass_lines(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  static char cBuf[LINE_BUF]; /* buffer for reading a block         */
+  ssize_t     sizRead;        /* the size of the block              */
+  size_t      sizPos;         /* the top of the rest in the block   */
+  size_t      sizSpan;        /* the size of the span to write      */
+  size_t      sizLf;          /* the number of LFs in the rest      */
+  size_t      sizWant;        /* the number of lines in the rest    */
+  size_t      sizTaken;       /* the number of lines allowed        */
+  int         iMidline;       /* 1 when the current line is allowed */
+  int         iMidout;        /* the output the current line goes to*/
+  const char* pc;
+
+  /*--- Reading and writing loop -----------------------------------*/
+  iMidline = 0;
+  iMidout  = 0;
+  while (1) {
+    /* 1) Read a block */
+    if ((sizRead=read(iFd,cBuf,LINE_BUF)) < 0) {
+      if (errno != EINTR    ) {return -1;}
+      if (gstThCom.iTerm_req) {return  0;}
+      continue;
+    }
+    if (sizRead == 0) {return 1;}
+    /* 2) Write the lines in the block */
+    sizPos = 0;
+    while (sizPos < (size_t)sizRead) {
+      if (iMidline) {
+        /* the rest of the line which has already been allowed */
+        pc = memchr(cBuf+sizPos, '\n', (size_t)sizRead-sizPos);
+        sizSpan  = (pc) ? (size_t)(pc-cBuf)+1-sizPos
+                        : (size_t)sizRead    -sizPos;
+        iMidline = (pc) ? 0 : 1;
+        write_all((gpstOut) ? gpstOut[iMidout].iFd : STDOUT_FILENO,
+                  cBuf+sizPos, sizSpan                                );
+        stats_pass(sizSpan, (pc) ? 1 : 0);
+        sizPos  += sizSpan;
+        continue;
+      }
+      /* the lines which begin in the rest of the block */
+      sizLf   = count_lf(cBuf+sizPos, (size_t)sizRead-sizPos);
+      sizWant = sizLf + ((cBuf[sizRead-1]!='\n') ? 1 : 0);
+      if ((sizTaken=take_quantity(sizWant)) == 0) {return 0;}
+      if (sizTaken > sizLf) {
+        sizSpan  = (size_t)sizRead-sizPos; /* incl. the unfinished one */
+        iMidline = 1;
+      } else if (sizTaken == sizLf && cBuf[sizRead-1]=='\n') {
+        sizSpan  = (size_t)sizRead-sizPos;
+      } else {
+        /* (The unfinished line is not allowed even if sizTaken==sizLf.
+            e.g. "ab\ncd" with the quantity 1 must pass only "ab\n".)    */
+        sizSpan  = find_nth_lf(cBuf+sizPos, (size_t)sizRead-sizPos, sizTaken);
+      }
+      if (gpstOut) {iMidout = fanout_lines(cBuf+sizPos, sizSpan);        }
+      else         {write_all(STDOUT_FILENO, cBuf+sizPos, sizSpan);}
+      stats_pass(sizSpan, (sizTaken>sizLf) ? sizLf : sizTaken);
+      sizPos += sizSpan;
+    }
+  }
+}
+
+/*=== Count the LFs in the buffer ====================================
+ * SSE2 (x86-64) or NEON (AArch64) counts 16 bytes at a time, and each
+ * byte counter is summed up before it overflows (every 255 blocks).
+ * Other CPUs use memchr(), which the C library usually optimizes.
+ * [in]  pc  : The buffer
+ *       siz : The size of the buffer
+ * [ret] The number of the LFs                                      */
+size_t count_lf(const char* pc, size_t siz) {
+
+  /*--- Variables --------------------------------------------------*/
+  size_t      sizCnt; /* the number of LFs found                    */
+  size_t      i;
+#if defined(__SSE2__)
+  __m128i     m128Lf, m128Acc;
+  int         j;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  uint8x16_t  u8x16Lf, u8x16Acc;
+  int         j;
+#else
+  const char* pcLf;
+#endif
+
+  /*--- Count the LFs ----------------------------------------------*/
+  sizCnt = 0;
+  i      = 0;
+#if defined(__SSE2__)
+  m128Lf = _mm_set1_epi8('\n');
+  while (i+16 <= siz) {
+    m128Acc = _mm_setzero_si128();
+    for (j=0; j<255 && i+16<=siz; j++, i+=16) {
+      m128Acc = _mm_sub_epi8(m128Acc,
+                  _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pc+i)),
+                                 m128Lf                                  ));
+    }
+    m128Acc = _mm_sad_epu8(m128Acc, _mm_setzero_si128());
+    sizCnt += (size_t)_mm_cvtsi128_si32(m128Acc)
+            + (size_t)_mm_extract_epi16(m128Acc, 4);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  u8x16Lf = vdupq_n_u8('\n');
+  while (i+16 <= siz) {
+    u8x16Acc = vdupq_n_u8(0);
+    for (j=0; j<255 && i+16<=siz; j++, i+=16) {
+      u8x16Acc = vsubq_u8(u8x16Acc,
+                   vceqq_u8(vld1q_u8((const uint8_t*)(pc+i)), u8x16Lf));
+    }
+    sizCnt += (size_t)vaddlvq_u8(u8x16Acc);
+  }
+#else
+  while ((pcLf=memchr(pc+i, '\n', siz-i)) != NULL) {
+    sizCnt++;
+    i = (size_t)(pcLf-pc) + 1;
+  }
+  return sizCnt;
+#endif
+  for (; i<siz; i++) {sizCnt += (pc[i]=='\n');}
+  return sizCnt;
+}
+
+/*=== Find the n-th LF in the buffer =================================
+ * [in]  pc     : The buffer
+ *       siz    : The size of the buffer
+ *       sizNth : n (>=1, and the buffer MUST have n LFs or more)
+ * [ret] The size from the top of the buffer to the n-th LF (incl.) */
+size_t find_nth_lf(const char* pc, size_t siz, size_t sizNth) {
+  const char* pcLf;
+  size_t      i;
+
+  i = 0;
+  while (sizNth-- > 0) {
+    pcLf = memchr(pc+i, '\n', siz-i);
+    i    = (size_t)(pcLf-pc) + 1;
+  }
+  return i;
+}
+
+/*=== Write all of the data into the file ============================
+ * [in] iFd : File descriptor to write into
+ *      pc  : The data
+ *      siz : The size of the data                                  */
+void write_all(int iFd, const char* pc, size_t siz) {
+  ssize_t sizWritten;
+
+  while (siz > 0) {
+    if ((sizWritten=write(iFd,pc,siz)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write() in write_all(): %s\n",strerror(errno));
+    }
+    pc  += sizWritten;
+    siz -= (size_t)sizWritten;
+  }
+}
+
+
+
+/*####################################################################
+# Fan-out (-o option)
+####################################################################*/
+
+/*=== Open the outputs ===============================================
+ * The name of each output has been set into gpstOut[].pszName.     */
+void open_outputs(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stOut;
+  fanout_t*   pst;
+  char        szDummy[2];
+  int         iByPath;     /* 1 if the output is given by the path   */
+  int         i;
+#if defined(F_GETPIPE_SZ)
+  int         iSize;
+#endif
+
+  /*--- Open each output -------------------------------------------*/
+  for (i=0; i<giOutnum; i++) {
+    pst = &gpstOut[i];
+    if (sscanf(pst->pszName,"%d%1s",&pst->iFd,szDummy) != 1) {pst->iFd=-1;}
+    iByPath = (pst->iFd < 0) ? 1 : 0;
+    if (iByPath) {
+      /* (It blocks until a reader comes when it is a named pipe) */
+      while ((pst->iFd=open(pst->pszName,O_WRONLY|O_CREAT,0644)) < 0) {
+        if (errno == EINTR) {continue;}
+        error_exit(errno,"%s: %s\n",pst->pszName,strerror(errno));
+      }
+    }
+    if (fstat(pst->iFd,&stOut) < 0) {
+      error_exit(errno,"%s: %s\n",pst->pszName,strerror(errno));
+    }
+    /* A regular file given by the path is truncated, like ">" does.
+       (O_TRUNC is not used to leave other types of files as they are) */
+    if (iByPath && S_ISREG(stOut.st_mode) && ftruncate(pst->iFd,0) < 0) {
+      error_exit(errno,"%s: %s\n",pst->pszName,strerror(errno));
+    }
+    pst->iIsPipe = S_ISFIFO(stOut.st_mode) ? 1 : 0;
+    pst->sizPipe = FANOUT_PIPE_DEFAULT;
+#if defined(F_GETPIPE_SZ)
+    if (pst->iIsPipe && (iSize=fcntl(pst->iFd,F_GETPIPE_SZ)) > 0) {
+      pst->sizPipe = (size_t)iSize;
+    }
+#endif
+    if (giVerbose>0) {
+      warning("output #%d: %s (fd %d, %s, %lu bytes)\n",
+              i, pst->pszName, pst->iFd, (pst->iIsPipe) ? "pipe" : "not pipe",
+              (unsigned long)pst->sizPipe                                     );
+    }
+  }
+}
+
+/*=== Distribute the lines to the outputs ============================
+ * Choose the output for each line by the policy, gather the lines for
+ * each output into the iovecs, and write them by one writev() for each
+ * output.
+ * [in]  pc  : The top of the lines (It MUST be the top of a line)
+ *       siz : The size of the lines (The last one can be unfinished)
+ * [ret] The index of the output which the last line has gone to    */
+int fanout_lines(const char* pc, size_t siz) {
+
+  /*--- Variables --------------------------------------------------*/
+  static int  iNext = 0; /* the next output for the round-robin     */
+  fanout_t*   pst;
+  const char* pcLf;
+  size_t      sizLine;
+  int         iOut;
+  int         i;
+
+  /*--- Know how loaded the outputs are now (least-loaded) ---------*/
+  if (giPolicy == 1) {
+    for (i=0; i<giOutnum; i++) {measure_load(&gpstOut[i]);}
+  }
+
+  /*--- Assign each line to an output ------------------------------*/
+  iOut = 0;
+  while (siz > 0) {
+    pcLf    = memchr(pc, '\n', siz);
+    sizLine = (pcLf) ? (size_t)(pcLf-pc)+1 : siz;
+    if (giPolicy == 1) {
+      iOut  = least_loaded_output();
+    } else             {
+      iOut  = iNext;
+      iNext = (iNext+1 < giOutnum) ? iNext+1 : 0;
+    }
+    pst = &gpstOut[iOut];
+    if (pst->iIovnum > 0 &&
+        (const char*)pst->iov[pst->iIovnum-1].iov_base
+                    +pst->iov[pst->iIovnum-1].iov_len  == pc) {
+      /* join it to the previous line when they are next to each other */
+      pst->iov[pst->iIovnum-1].iov_len += sizLine;
+    } else                                                    {
+      if (pst->iIovnum == FANOUT_IOV) {flush_output(pst);}
+      pst->iov[pst->iIovnum].iov_base = (void*)pc;
+      pst->iov[pst->iIovnum].iov_len  = sizLine;
+      pst->iIovnum++;
+    }
+    pst->sizLoad += sizLine;
+    pc           += sizLine;
+    siz          -= sizLine;
+  }
+
+  /*--- Write them -------------------------------------------------*/
+  for (i=0; i<giOutnum; i++) {flush_output(&gpstOut[i]);}
+  return iOut;
+}
+
+/*=== Choose the least-loaded output =================================
+ * The load is the ratio of sizLoad to the size of the pipe, and the
+ * ratios are compared by the cross-multiplication.
+ * [ret] The index of the output                                    */
+int least_loaded_output(void) {
+  int iMin;
+  int i;
+
+  iMin = 0;
+  for (i=1; i<giOutnum; i++) {
+    if ((uint64_t)gpstOut[i   ].sizLoad * (uint64_t)gpstOut[iMin].sizPipe <
+        (uint64_t)gpstOut[iMin].sizLoad * (uint64_t)gpstOut[i   ].sizPipe  ) {
+      iMin = i;
+    }
+  }
+  return iMin;
+}
+
+/*=== Measure the bytes unread in the output =========================
+ * Only a pipe tells it by FIONREAD (even on the writing side, at least
+ * on Linux). The other types of outputs are regarded as empty.
+ * [in] pstOut : The output                                         */
+void measure_load(fanout_t* pstOut) {
+  int iUnread;
+
+  pstOut->sizLoad = 0;
+  if (! pstOut->iIsPipe) {return;}
+  if (ioctl(pstOut->iFd,FIONREAD,&iUnread)==0 && iUnread>0) {
+    pstOut->sizLoad = (size_t)iUnread;
+  }
+}
+
+/*=== Write the lines assigned to the output =========================
+ * [in] pstOut : The output                                         */
+void flush_output(fanout_t* pstOut) {
+  struct iovec* piov;
+  int           iIovnum;
+  ssize_t       sizWritten;
+
+  piov    = pstOut->iov;
+  iIovnum = pstOut->iIovnum;
+  while (iIovnum > 0) {
+    if ((sizWritten=writev(pstOut->iFd,piov,iIovnum)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"%s: writev(): %s\n",pstOut->pszName,strerror(errno));
+    }
+    /* skip the iovecs written, and cut the one written partially */
+    while (iIovnum>0 && (size_t)sizWritten>=piov->iov_len) {
+      sizWritten -= (ssize_t)piov->iov_len;
+      piov++;
+      iIovnum--;
+    }
+    if (iIovnum > 0) {
+      piov->iov_base  = (char*)piov->iov_base + sizWritten;
+      piov->iov_len  -= (size_t)sizWritten;
+    }
+  }
+  pstOut->iIovnum = 0;
+}
+
+
+
+/*####################################################################
+# Credit Channel (-s option)
+####################################################################*/
+
+#if defined(__ATOMIC_SEQ_CST)
+/*=== Open and map the creditfile ====================================
+ * [in]  pszCreditfile : Filepath of the creditfile
+ * [out] gpstCredit    : The mapped creditfile                      */
+void open_creditch(char* pszCreditfile) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stFile;
+  int         iFd;
+
+  /*--- Open the file and make it 64 bytes if new ------------------*/
+  if ((iFd=open(pszCreditfile,O_RDWR|O_CREAT,0666)) < 0) {
+    error_exit(errno,"%s: %s\n",pszCreditfile,strerror(errno));
+  }
+  if (fstat(iFd,&stFile) < 0) {
+    error_exit(errno,"fstat() in open_creditch(): %s\n",strerror(errno));
+  }
+  if (! S_ISREG(stFile.st_mode)) {
+    error_exit(1,"%s: Not a regular file\n",pszCreditfile);
+  }
+  if (stFile.st_size == 0) {
+    if (ftruncate(iFd,sizeof(creditch_t)) < 0) {
+      error_exit(errno,"ftruncate() in open_creditch(): %s\n",
+                 strerror(errno)                            );
+    }
+  } else if (stFile.st_size < (off_t)sizeof(creditch_t)) {
+    error_exit(1,"%s: Too small for a creditfile\n",pszCreditfile);
+  }
+
+  /*--- Map it -----------------------------------------------------*/
+  gpstCredit = (creditch_t*)mmap(NULL, sizeof(creditch_t),
+                                 PROT_READ|PROT_WRITE, MAP_SHARED, iFd, 0);
+  if (gpstCredit == MAP_FAILED) {
+    error_exit(errno,"mmap() in open_creditch(): %s\n",strerror(errno));
+  }
+  close(iFd);
+
+  /*--- Write or check the magic -----------------------------------*/
+  if (stFile.st_size == 0) {memcpy(gpstCredit->szMagic,CREDIT_MAGIC,8);}
+  if (memcmp(gpstCredit->szMagic,CREDIT_MAGIC,8) != 0) {
+    error_exit(1,"%s: Not a creditfile\n",pszCreditfile);
+  }
+  __atomic_store_n(&gpstCredit->ui4Waiting, 0, __ATOMIC_SEQ_CST);
+  if (giVerbose>0) {
+    warning("creditfile is ready (%llu credits)\n",
+            (unsigned long long)gpstCredit->ui8Credit);
+  }
+}
+
+/*=== Take credits from the creditfile ===============================
+ * [in]  sizWant : The number of credits wanted (>=1)
+ * [ret] >0 : The number of credits taken (<=sizWant)
+ *       =0 : The termination flag has been set                     */
+size_t take_credits(size_t sizWant) {
+
+  /*--- Variables --------------------------------------------------*/
+  uint64_t ui8Cur;  /* the current value of the counter             */
+  uint64_t ui8Take; /* credits to take                              */
+  uint32_t ui4Seq;  /* the wake-up sequence before waiting          */
+  tmsp     ts;      /* the time when starting to wait               */
+  int      iBlocked;/* 1 after waiting                              */
+
+  /*--- Loop until getting credits ---------------------------------*/
+  iBlocked = 0;
+  while (1) {
+    /* 1) Take credits if left */
+    ui8Cur = __atomic_load_n(&gpstCredit->ui8Credit, __ATOMIC_ACQUIRE);
+    while (ui8Cur > 0) {
+      if (__atomic_load_n(&gpstCredit->ui4Term, __ATOMIC_RELAXED)) {return 0;}
+      ui8Take = (ui8Cur<(uint64_t)sizWant) ? ui8Cur : (uint64_t)sizWant;
+      if (__atomic_compare_exchange_n(&gpstCredit->ui8Credit, &ui8Cur,
+                                      ui8Cur-ui8Take, 0, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE                   )) {
+        if (gpstStatus) {
+          if (iBlocked) {status_blocked(&ts);}
+          gui8Consumed += ui8Take;
+          STATUS_STORE(&gpstStatus->ui8Consumed , gui8Consumed   );
+          STATUS_STORE(&gpstStatus->ui8Remaining, ui8Cur-ui8Take );
+        }
+        return (size_t)ui8Take;
+      }
+    }
+    if (__atomic_load_n(&gpstCredit->ui4Term, __ATOMIC_RELAXED)) {
+      if (iBlocked) {status_blocked(&ts);}
+      return 0;
+    }
+    if (gpstStatus && !iBlocked) {
+      STATUS_STORE(&gpstStatus->ui8Remaining, 0);
+      clock_gettime(CLOCK_FOR_ME, &ts);
+      iBlocked = 1;
+    }
+    /* 2) Tell the givers I'm waiting, and make sure no credit came
+          in the meantime (The giver adds credits before checking the
+          waiting flag, so either of us will notice the other.)      */
+    ui4Seq = __atomic_load_n(&gpstCredit->ui4Seq, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&gpstCredit->ui4Waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&gpstCredit->ui8Credit, __ATOMIC_SEQ_CST) == 0 &&
+        __atomic_load_n(&gpstCredit->ui4Term  , __ATOMIC_SEQ_CST) == 0   ) {
+      stats_add(ST_SLEEPS,1);
+      wait_for_credits(ui4Seq);
+    }
+    __atomic_store_n(&gpstCredit->ui4Waiting, 0, __ATOMIC_SEQ_CST);
+  }
+}
+
+/*=== Sleep until a giver wakes me up ================================
+ * It also wakes up after CREDIT_WAIT_MSEC even if no one wakes me up
+ * so that a giver who forgot the wake-up cannot stop me forever.
+ * [in]  ui4Seq : The wake-up sequence before deciding to sleep     */
+void wait_for_credits(uint32_t ui4Seq) {
+  tmsp ts;
+#if defined(__linux__) && defined(SYS_futex)
+  ts.tv_sec  = CREDIT_WAIT_MSEC/1000;
+  ts.tv_nsec = (CREDIT_WAIT_MSEC%1000)*1000000;
+  if (syscall(SYS_futex,&gpstCredit->ui4Seq,FUTEX_WAIT,ui4Seq,&ts,NULL,0)<0) {
+    if (errno!=EAGAIN && errno!=EINTR && errno!=ETIMEDOUT) {
+      error_exit(errno,"futex() in wait_for_credits(): %s\n",strerror(errno));
+    }
+  }
+#else
+  ts.tv_sec  = 0;
+  ts.tv_nsec = CREDIT_POLL_NSEC;
+  nanosleep(&ts, NULL);
+#endif
+}
+#else
+void open_creditch(char* pszCreditfile) {
+  error_exit(1,"-s option is not supported on this compiler\n");
+}
+size_t take_credits(size_t sizWant) {return 0;}
+void wait_for_credits(uint32_t ui4Seq) {return;}
+#endif
+
+
+
+/*####################################################################
+# Status File (-S option)
+####################################################################*/
+
+/*=== Create and map the statusfile ==================================
+ * [in]  pszStatusfile : Filepath of the statusfile
+ *       iUnit         : 0:byte 1:line
+ * [out] gpstStatus    : The mapped statusfile                      */
+void open_statusfile(char* pszStatusfile, int iUnit) {
+
+  /*--- Variables --------------------------------------------------*/
+  int iFd;
+
+  /*--- Create the file with the size of the record ----------------*/
+  if ((iFd=open(pszStatusfile,O_RDWR|O_CREAT|O_TRUNC,0666)) < 0) {
+    error_exit(errno,"%s: %s\n",pszStatusfile,strerror(errno));
+  }
+  if (ftruncate(iFd,sizeof(status_t)) < 0) {
+    error_exit(errno,"ftruncate() in open_statusfile(): %s\n",strerror(errno));
+  }
+
+  /*--- Map it and write the fixed fields --------------------------*/
+  gpstStatus = (status_t*)mmap(NULL, sizeof(status_t),
+                               PROT_READ|PROT_WRITE, MAP_SHARED, iFd, 0);
+  if (gpstStatus == MAP_FAILED) {
+    error_exit(errno,"mmap() in open_statusfile(): %s\n",strerror(errno));
+  }
+  close(iFd);
+  gpstStatus->ui4Unit = (uint32_t)iUnit;
+  gpstStatus->ui4Pid  = (uint32_t)getpid();
+  memcpy(gpstStatus->szMagic, STATUS_MAGIC, 8);
+}
+
+/*=== Write the quantity remaining into the statusfile ===============
+ * [in]  ui8Remaining : The quantity remaining                      */
+void status_remaining(uint64_t ui8Remaining) {
+  if (gpstStatus == NULL) {return;}
+  STATUS_STORE(&gpstStatus->ui8Remaining, ui8Remaining);
+}
+
+/*=== Add the time blocked until now into the statusfile =============
+ * This is called only after waiting, so it is not on the hot path.
+ * [in]  ptsFrom : The time when starting to wait                   */
+void status_blocked(tmsp* ptsFrom) {
+  tmsp    ts;
+  int64_t i8;
+
+  if (gpstStatus == NULL) {return;}
+  clock_gettime(CLOCK_FOR_ME, &ts);
+  i8 = (int64_t)(ts.tv_sec -ptsFrom->tv_sec )*1000000000
+     +          (ts.tv_nsec-ptsFrom->tv_nsec);
+  if (i8 < 0) {i8 = 0;}
+  STATUS_STORE(&gpstStatus->ui8Blocked_ns , gpstStatus->ui8Blocked_ns +i8);
+  STATUS_STORE(&gpstStatus->ui8Blocked_num, gpstStatus->ui8Blocked_num+1 );
+  *ptsFrom = ts;
+}
+
+
+
 /*####################################################################
 # Subthread (Parameter Updater)
 ####################################################################*/
@@ -782,6 +1694,7 @@ void update_periodic_time_type_r(char* pszCtrlfile) {
       gstThCom.sizQty = (UINT_MAX-gstThCom.sizQty < siz) ? UINT_MAX
                                                          : gstThCom.sizQty+siz;
     }
+    status_remaining(gstThCom.sizQty);
     if ((k=pthread_cond_signal( &gstThCom.co)) != 0) {
       error_exit(k,"pthread_cond_signal() in type_r(): %s\n" , strerror(k));
     }
@@ -927,6 +1840,7 @@ void update_periodic_time_type_c(char* pszCtrlfile) {
       gstThCom.sizQty = (UINT_MAX-gstThCom.sizQty < siz) ? UINT_MAX
                                                          : gstThCom.sizQty+siz;
     }
+    status_remaining(gstThCom.sizQty);
     if ((j=pthread_cond_signal( &gstThCom.co)) != 0) {
       error_exit(j,"pthread_cond_signal() in type_c(): %s\n" , strerror(j));
     }
@@ -1139,44 +2053,6 @@ int change_to_rtprocess(int iPrio) {
   return 0;
 }
 
-/*=== Read and write only one line ===================================
- * [in] fp            : Filehandle for read
- * [ret] 0   : Finished reading/writing due to '\n'
- *       1   : Finished reading/writing due to '\n', which is the last
- *             char of the file
- *       EOF : Finished reading/writing due to EOF              */
-int read_1line(FILE *fp) {
-
-  /*--- Variables --------------------------------------------------*/
-  char       szBuf[LINE_BUF]; /* Buffer for reading 1-line */
-  int        iChar;           /* Buffer for reading 1-char */
-  int        iLen;            /* Actual size of string in the buffer */
-
-  /*--- Read/Write a string until the "\n." ------------------------*/
-  while (fgets(szBuf,LINE_BUF,fp) != NULL) {
-    if (fputs(szBuf,stdout) < 0) {
-      error_exit(errno,"fputs() #R1L-1: %s\n",strerror(errno));
-    }
-    iLen = strnlen(szBuf, LINE_BUF);
-    if (szBuf[iLen-1] == '\n') {
-      iChar=getc(fp);
-      if (iChar==EOF) {return 1;}
-      if (ungetc(iChar,fp)==EOF) {
-        error_exit(errno,"ungetc() #R1L-2: %s\n",strerror(errno));
-      }
-      return 0;
-    }
-    if (iLen < LINE_BUF-1) {
-      iChar=getc(fp);
-      if (iChar==EOF) {return EOF;}
-      while (putchar(iChar)==EOF) {
-        error_exit(errno,"putchar() #R1L-3: %s\n",strerror(errno));
-      }
-    }
-  }
-  return EOF;
-}
-
 /*=== SIGNALHANDLER : Set the termination flag =======================
  * This function is for the main-th. to stop getc() blocking (!SA_RESTART)
  * or pthread_cond_wait() blocking. And then, the main-th. will terminate
@@ -2,7 +2,7 @@
 #
 # RELVAL - Limit the Flow Rate of the UNIX Pipeline Like a Relief Valve
 #
-# USAGE   : relval [-c|-e|-z] [-ku] [-d fd|file] ratelimit [file [...]]
+# USAGE   : relval [-c|-e|-z] [-ku] [-d fd|file] [-m statsfile] ratelimit [file [...]]
 # Args    : file ........ Filepath to be sent ("-" means STDIN)
 #                         The file MUST be a textfile and MUST have
 #                         a timestamp at the first field to make the
@@ -73,14 +73,22 @@
 #                           add "./" before the name, like "./3."
 #                         * When you set another type of string, this
 #                           command regards it as a filename.
+#           -m statsfile  Write a snapshot of the live counters (lines
+#                         passed, dropped and drained, etc.) into the
+#                         file every second, when SIGUSR1 comes, and at
+#                         exit. A regular file always has only the latest
+#                         one, and a named pipe gets a line for each
+#                         snapshot.
+#                         Without this option, a snapshot is written into
+#                         the stderr only when SIGUSR1 comes.
 #
 # Return  : Return 0 only when finished successfully
 #
-# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread -lrt
 #                  (if it doesn't work)
-# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-04-15
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -102,10 +110,6 @@
 /*=== Initial Setting ==============================================*/
 
 /*--- headers ------------------------------------------------------*/
-#if defined(__linux) || defined(__linux__)
-  /* This definition is for strptime() on Linux */
-  #define _XOPEN_SOURCE 700
-#endif
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
@@ -117,6 +121,8 @@
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include "timeio.h"
+#include "stats.h"
 
 /*--- headers ------------------------------------------------------*/
 /* Buffer size for the control file */
@@ -130,8 +136,6 @@ typedef struct timespec tmsp;
 /*--- prototype functions ------------------------------------------*/
 int     erase_stale_items_in_the_ring_buffer(
           int iBufsize, tmsp* ptsBuf, int iLast, tmsp tsRef);
-int     parse_calendartime(char* pszTime, tmsp *ptsTime);
-int     parse_unixtime(char* pszTime, tmsp *ptsTime);
 int     read_1st_field_as_a_timestamp(FILE *fp, char *pszTime);
 int     read_and_drain_a_line(FILE *fp, FILE *fpDrain);
 int     read_and_write_a_line(FILE *fp);
@@ -150,7 +154,8 @@ char*   gpszCmdname; /* The name of this command                    */
 /*--- exit with usage ----------------------------------------------*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
-    " USAGE   : %s [-c|-e|-z] [-ku] [-d fd|file] ratelimit [file [...]]\n"
+    " USAGE   : %s [-c|-e|-z] [-ku] [-d fd|file] [-m statsfile] ratelimit\n"
+    "                                                         [file [...]]\n"
     " Args    : file ........ Filepath to be sent (\"-\" means STDIN)\n"
     "                         The file MUST be a textfile and MUST have\n"
     "                         a timestamp at the first field to make the\n"
@@ -221,8 +226,16 @@ void print_usage_and_exit(void) {
     "                           add \"./\" before the name, like \"./3.\"\n"
     "                         * When you set another type of string, this\n"
     "                           command regards it as a filename.\n"
+    "           -m statsfile  Write a snapshot of the live counters (lines\n"
+    "                         passed, dropped and drained, etc.) into the\n"
+    "                         file every second, when SIGUSR1 comes, and at\n"
+    "                         exit. A regular file always has only the latest\n"
+    "                         one, and a named pipe gets a line for each\n"
+    "                         snapshot.\n"
+    "                         Without this option, a snapshot is written into\n"
+    "                         the stderr only when SIGUSR1 comes.\n"
     "\n"
-    "Version : 2025-04-15 14:55:29 JST\n"
+    "Version : 2026-10-18 19:30:12 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "USP-NCNT prj. / Shell-Shoccar Japan (@shellshoccarjpn),\n"
@@ -281,6 +294,7 @@ char*   psz;            /* all-purpose char pointer                 */
 char*   pszDrainname;   /* Filename for Drain                       */
 char*   pszFilename;    /* filepath (for message)                   */
 char*   pszPath;        /* filepath on arguments                    */
+char*   pszStatfile;    /* Statistics file (for the -m option)      */
 FILE*   fp;             /* file handle                              */
 FILE*   fpDrain;        /* file handle for the drain                */
 tmsp    tsTime;         /* Parsed time for the 1st field            */
@@ -307,9 +321,10 @@ iDrainFd     = -1;
 iMaxlines    =  1;
 iKeepTs      =  0;
 pszDrainname = NULL;
+pszStatfile  = NULL;
 
 /*--- Parse options which start with "-" ---------------------------*/
-while((i=getopt(argc, argv, "cezukd:hv")) != -1) {
+while((i=getopt(argc, argv, "cezukd:m:hv")) != -1) {
   switch(i){
     case 'c': iMode=0;                      break;
     case 'e': iMode=1;                      break;
@@ -319,6 +334,7 @@ while((i=getopt(argc, argv, "cezukd:hv")) != -1) {
     case 'd': if (sscanf(optarg,"%d%1s",&iDrainFd,szDummy) != 1) {iDrainFd=-1;}
               if (iDrainFd>=0) {pszDrainname=NULL;} else {pszDrainname=optarg;}
               break;
+    case 'm': pszStatfile=optarg;           break;
     case 'v': giVerbose++;                  break;
     case 'h': print_usage_and_exit();
     default : print_usage_and_exit();
@@ -344,6 +360,9 @@ argv++;
 
 /*=== Pre-Operation of the each file loop ==========================*/
 
+/*--- Start the statistics thread ----------------------------------*/
+stats_start(gpszCmdname, pszStatfile);
+
 /*--- Open the drain file if specified -----------------------------*/
 if (pszDrainname != NULL) {
   while ((iDrainFd=open(pszDrainname,O_WRONLY|O_CREAT,0644))<0) {
@@ -495,6 +514,7 @@ while (argc > 0 || iFileno == 0) {
                             if (fputs(szTime, stdout) == EOF) {
                               error_exit(1, "Access error at the stdout\n");
                             }
+                            stats_add(ST_BYTES_OUT, strlen(szTime));
                           }
                           switch (read_and_write_a_line(fp)) {
                             case  1: /* expected LF */
@@ -631,6 +651,7 @@ while (argc > 0 || iFileno == 0) {
                             if (fputs(szTime, stdout) == EOF) {
                               error_exit(1, "Access error at the stdout\n");
                             }
+                            stats_add(ST_BYTES_OUT, strlen(szTime));
                           }
                           switch (read_and_write_a_line(fp)) {
                             case  1: /* expected LF */
@@ -691,160 +712,6 @@ return(iRet);}
 ####################################################################*/
 
 
-/*=== Parse a local calendar time ====================================
- * [in]  pszTime : calendar-time string in the localtime
- *                 (/[0-9]{11,20}(\.[0-9]{1,9})?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_calendartime(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szDate[21], szNsec[10], szDate2[26];
-  int  i, j, k;            /* +-- 0:(reading integer part)          */
-  char c;                  /* +-- 1:finish reading without_decimals */
-  int  iStatus = 0; /* <--------- 2:to_be_started reading decimals  */
-  struct tm tmDate;
-
-  /*--- Separate pszTime into date and nanoseconds -----------------*/
-  for (i=0; i<20; i++) {
-    c = pszTime[i];
-    if      (('0'<=c) && (c<='9')     ) {szDate[i]=c;                       }
-    else if (c=='.'                   ) {szDate[i]=0; iStatus=2; i++; break;}
-    else if (c==0 || c==' ' || c=='\t') {szDate[i]=0; iStatus=1;      break;}
-    else                                {if (giVerbose>0) {
-                                           warning("%c: Unexpected chr. in "
-                                                   "the integer part\n",c);
-                                         }
-                                         return 0;
-                                        }
-  }
-  if ((iStatus==0) && (i==20)) {
-    switch (pszTime[20]) {
-      case '.': szDate[20]=0; iStatus=2; i++; break;
-      case  0 : szDate[20]=0; iStatus=1;      break;
-      default : warning("The integer part of the timestamp is too big "
-                        "as a calendar-time\n",c);
-                return 0;
-    }
-  }
-  switch (iStatus) {
-    case 1 : strcpy(szNsec,"000000000");
-             break;
-    case 2 : j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      (('0'<=c) && (c<='9')     ) {szNsec[k]=c; k++;}
-               else if (c==0 || c==' ' || c=='\t') {break;           }
-               else                                {
-                 if (giVerbose>0) {
-                   warning("%c: Unexpected chr. in the decimal part\n",c);
-                 }
-                 return 0;
-               }
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    default: warning("Unexpected error in parse_calendartime(), "
-                     "maybe a bug?\n");
-             return 0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  i = strlen(szDate)-10;
-  if (i<=0) {return 0;}
-  k =0; for (j=0; j<i; j++) {szDate2[k]=szDate[j];k++;} /* Y */
-  szDate2[k]='-'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* m */
-  szDate2[k]='-'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* d */
-  szDate2[k]='T'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* H */
-  szDate2[k]=':'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* M */
-  szDate2[k]=':'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* S */
-  szDate2[k] = 0;
-  memset(&tmDate, 0, sizeof(tmDate));
-  if(! strptime(szDate2, "%Y-%m-%dT%H:%M:%S", &tmDate)) {return 0;}
-  ptsTime->tv_sec = mktime(&tmDate);
-  ptsTime->tv_nsec = atol(szNsec);
-
-  return 1;
-}
-
-
-/*=== Parse a UNIX-time ==============================================
- * [in]  pszTime : UNIX-time string (/[0-9]{1,19}(\.[0-9]{1,9})?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_unixtime(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szSec[20], szNsec[10];
-  int  i, j, k;            /* +-- 0:(reading integer part)          */
-  char c;                  /* +-- 1:finish reading without_decimals */
-  int  iStatus = 0; /* <--------- 2:to_be_started reading decimals  */
-
-  /*--- Separate pszTime into seconds and nanoseconds --------------*/
-  for (i=0; i<19; i++) {
-    c = pszTime[i];
-    if      (('0'<=c) && (c<='9')     ) {szSec[i]=c;                       }
-    else if (c=='.'                   ) {szSec[i]=0; iStatus=2; i++; break;}
-    else if (c==0 || c==' ' || c=='\t') {szSec[i]=0; iStatus=1;      break;}
-    else                                {if (giVerbose>0) {
-                                           warning("%c: Unexpected chr. in "
-                                                   "the integer part\n",c);
-                                         }
-                                         return 0;
-                                        }
-  }
-  if ((iStatus==0) && (i==19)) {
-    switch (pszTime[19]) {
-      case '.': szSec[19]=0; iStatus=2; i++; break;
-      case  0 : szSec[19]=0; iStatus=1;      break;
-      default : warning("The integer part of the timestamp is too big "
-                        "as a UNIX-time\n");
-                return 0;
-    }
-  }
-  switch (iStatus) {
-    case 1 : strcpy(szNsec,"000000000");
-             break;
-    case 2 : j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      (('0'<=c) && (c<='9')     ) {szNsec[k]=c; k++;}
-               else if (c==0 || c==' ' || c=='\t') {break;           }
-               else                                {
-                 if (giVerbose>0) {
-                   warning("%c: Unexpected chr. in the decimal part\n",c);
-                 }
-                 return 0;
-               }
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    default: warning("Unexpected error in parse_unixtime(), maybe a bug?\n");
-             return 0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  ptsTime->tv_sec = (time_t)atoll(szSec);
-  if (ptsTime->tv_sec<0) {
-    ptsTime->tv_sec = (sizeof(time_t)>=8) ? LLONG_MAX : LONG_MAX;
-  }
-  ptsTime->tv_nsec = atol(szNsec);
-
-  return 1;
-}
-
-
 /*=== Read and write only one line having a timestamp ================
  * [in] fp      : Filehandle for read
  *      pszTime : Pointer for the string buffer to get the timestamp on
@@ -861,18 +728,22 @@ int read_1st_field_as_a_timestamp(FILE *fp, char *pszTime) {
 
   /*--- Variables --------------------------------------------------*/
   int        iTslen = 0; /* length of the timestamp string          */
+  int        iNum   = 0; /* number of bytes read                    */
   int        iChar;
 
   /*--- Reading and writing a line ---------------------------------*/
   while (1) {
     iChar = getc(fp);
+    if (iChar != EOF) {iNum++;}
     switch (iChar) {
       case ' ' :
       case '\t':
                  pszTime[iTslen  ] = iChar;
                  pszTime[iTslen+1] = 0;
+                 stats_add(ST_BYTES_IN, iNum);
                  return 1;
       case EOF :
+                 stats_add(ST_BYTES_IN, iNum);
                  if         (feof(  fp)) {
                    if (iTslen==0) {
                      return -1;
@@ -891,6 +762,9 @@ int read_1st_field_as_a_timestamp(FILE *fp, char *pszTime) {
                    return -4;
                  }
       case '\n':
+                 stats_add(ST_BYTES_IN, iNum);
+                 stats_add(ST_LINES_IN, 1   );
+                 stats_add(ST_DROPPED , 1   );
                  return 0;
       default  :
                  if (iTslen>32) {                                 continue;}
@@ -912,12 +786,15 @@ int read_and_drain_a_line(FILE *fp, FILE *fpDrain) {
 
   /*--- Variables --------------------------------------------------*/
   int        iChar;
+  size_t     siz = 0;  /* number of bytes read                      */
 
   /*--- Reading and writing a line ---------------------------------*/
+  stats_add(ST_DRAINED, 1);
   while (1) {
     iChar = getc(fp);
     switch (iChar) {
       case EOF :
+                 stats_add(ST_BYTES_IN, siz);
                  if (feof(  fp)) {return -1;}
                  if (ferror(fp)) {return -2;}
                  else            {return -3;}
@@ -926,12 +803,15 @@ int read_and_drain_a_line(FILE *fp, FILE *fpDrain) {
                    error_exit(errno,"write error #1: %s\n",
                               strerror(errno));
                  }
+                 stats_add(ST_BYTES_IN, siz+1);
+                 stats_add(ST_LINES_IN, 1    );
                  return 1;
       default  :
                  if (putc(iChar, fpDrain)==EOF) {
                    error_exit(errno,"write error #2: %s\n",
                               strerror(errno));
                  }
+                 siz++;
                  break;
     }
   }
@@ -950,12 +830,14 @@ int read_and_write_a_line(FILE *fp) {
 
   /*--- Variables --------------------------------------------------*/
   int        iChar;
+  size_t     siz = 0;  /* number of bytes passed through            */
 
   /*--- Reading and writing a line ---------------------------------*/
   while (1) {
     iChar = getc(fp);
     switch (iChar) {
       case EOF :
+                 stats_pass(siz, 0);
                  if (feof(  fp)) {return -1;}
                  if (ferror(fp)) {return -2;}
                  else            {return -3;}
@@ -964,12 +846,14 @@ int read_and_write_a_line(FILE *fp) {
                    error_exit(errno,"stdout write error #1: %s\n",
                               strerror(errno));
                  }
+                 stats_pass(siz+1, 1);
                  return 1;
       default  :
                  if (putchar(iChar)==EOF) {
                    error_exit(errno,"stdout write error #2: %s\n",
                               strerror(errno));
                  }
+                 siz++;
                  break;
     }
   }
@@ -988,18 +872,24 @@ int skip_over_a_line(FILE *fp) {
 
   /*--- Variables --------------------------------------------------*/
   int        iChar;
+  size_t     siz = 0;  /* number of bytes thrown away               */
 
   /*--- Reading and writing a line ---------------------------------*/
+  stats_add(ST_DROPPED, 1);
   while (1) {
     iChar = getc(fp);
     switch (iChar) {
       case EOF :
+                 stats_add(ST_BYTES_IN, siz);
                  if (feof(  fp)) {return -1;}
                  if (ferror(fp)) {return -2;}
                  else            {return -3;}
       case '\n':
+                 stats_add(ST_BYTES_IN, siz+1);
+                 stats_add(ST_LINES_IN, 1    );
                  return 1;
       default  :
+                 siz++;
                  break;
     }
   }
@@ -0,0 +1,192 @@
+/*####################################################################
+#
+# RTMEM.H - Memory Locking and CPU Pinning for the Realtime Modes
+#
+# USAGE   : #include "rtmem.h"
+#           (in the "headers" section of a command's source file)
+# Provides: rtmem_lock() ...... Pre-fault the stack and lock all of the
+#                               memory of the process into the RAM
+#           rtmem_prefault() .. Touch every page of a buffer
+#           rtmem_pin_cpu() ... Make the calling thread (and the threads
+#                               it creates later) run only on the CPU
+# Requires: The including source file MUST define the following ones.
+#             int  giVerbose;
+#             void warning(const char* szFormat, ...);
+#           And it MUST define _GNU_SOURCE before including any header
+#           on Linux to use rtmem_pin_cpu().
+# Note    : * A page fault in the middle of the main loop costs from some
+#             microseconds (minor) up to some milliseconds (major), and
+#             it comes just after a sleep in the worst case, that is, it
+#             looks like an oversleep. Locking the memory removes them,
+#             and pinning the process to a CPU removes the latency of the
+#             migration between CPUs. The result can be seen on the
+#             "oversleep_us", "minflt" and "majflt" fields of the
+#             statistics (stats.h).
+#           * MCL_FUTURE is requested only when the process can lock an
+#             unlimited amount of memory. Otherwise, an allocation after
+#             locking would fail when it exceeds RLIMIT_MEMLOCK. So, the
+#             memory which is mapped later (e.g. the buffer which stdio
+#             allocates at the first I/O on a stream) is not locked then.
+#             So, the commands give their stdio streams static buffers by
+#             setvbuf() and touch them with rtmem_prefault() before
+#             calling rtmem_lock().
+#           * The functions never exit the process. They just return the
+#             errno and report it only in the verbose mode, like the
+#             "-p" option does.
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+#ifndef RTMEM_H
+#define RTMEM_H
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#if defined(__linux) || defined(__linux__)
+  #include <sched.h>
+#endif
+
+/*--- macro constants ----------------------------------------------*/
+/* Size of the stack to be pre-faulted (It should be enough for the
+   deepest call in the main loop of the commands here)              */
+#define RTMEM_STACK_PREFAULT (256*1024)
+/* Size of a page assumed when sysconf() doesn't tell it */
+#define RTMEM_PAGE_DEFAULT 4096
+/* Attribute for the functions here (Commands don't use all of them) */
+#if defined(__GNUC__)
+  #define RTMEM_FUNC     static __attribute__((unused))
+  #define RTMEM_NOINLINE static __attribute__((unused,noinline))
+#else
+  #define RTMEM_FUNC     static
+  #define RTMEM_NOINLINE static
+#endif
+
+/*--- things the including file has to define ----------------------*/
+extern int giVerbose;
+void warning(const char* szFormat, ...);
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Get the page size ==============================================
+ * [ret] The size of a page in bytes                                */
+RTMEM_FUNC size_t rtmem_pagesize(void) {
+  long lSize;
+
+  lSize = sysconf(_SC_PAGESIZE);
+  return (lSize > 0) ? (size_t)lSize : RTMEM_PAGE_DEFAULT;
+}
+
+/*=== Touch every page of a buffer ===================================
+ * The buffer is only read and written back, so its contents are kept.
+ * [in] pv  : The top of the buffer
+ *      siz : The size of the buffer                                */
+RTMEM_FUNC void rtmem_prefault(void *pv, size_t siz) {
+  volatile char *pc;
+  size_t         sizPage, siz1;
+
+  if (pv == NULL || siz == 0) {return;}
+  pc      = (volatile char*)pv;
+  sizPage = rtmem_pagesize();
+  for (siz1=0; siz1<siz; siz1+=sizPage) {pc[siz1] = pc[siz1];}
+  pc[siz-1] = pc[siz-1];
+}
+
+/*=== Pre-fault the stack ============================================
+ * This function must not be inlined so that its frame is surely put
+ * below the frame of the caller.                                   */
+RTMEM_NOINLINE void rtmem_prefault_stack(void) {
+  volatile char cStack[RTMEM_STACK_PREFAULT];
+  size_t        sizPage, siz1;
+
+  sizPage = rtmem_pagesize();
+  for (siz1=0; siz1<sizeof(cStack); siz1+=sizPage) {cStack[siz1] = 0;}
+}
+
+/*=== Pre-fault the stack and lock the memory ========================
+ * [ret] 0 : Succeeded
+ *       >0: Failed (errno)                                         */
+RTMEM_FUNC int rtmem_lock(void) {
+  struct rlimit rlInfo;
+  int           iFlags;
+  int           iErrno;
+
+  rtmem_prefault_stack();
+  iFlags = MCL_CURRENT;
+  if (geteuid() == 0) {
+    iFlags |= MCL_FUTURE;
+  } else if (getrlimit(RLIMIT_MEMLOCK,&rlInfo)==0 &&
+             rlInfo.rlim_cur==RLIM_INFINITY         ) {
+    iFlags |= MCL_FUTURE;
+  }
+  if (mlockall(iFlags) != 0) {
+    iErrno = errno;
+    if (giVerbose>0) {warning("\"-L\": mlockall(): %s\n",strerror(iErrno));}
+    return iErrno;
+  }
+  if (giVerbose>0) {
+    warning("\"-L\": succeeded%s\n",
+            (iFlags & MCL_FUTURE) ? "" : " (without MCL_FUTURE)");
+  }
+  return 0;
+}
+
+/*=== Make the calling thread run only on the CPU ====================
+ * The threads which have already been created (e.g. the statistics
+ * thread) are not pinned, so they don't disturb the main loop.
+ * [in]  iCpu : The CPU number (from 0)
+ * [ret] 0 : Succeeded
+ *       >0: Failed (errno)                                         */
+RTMEM_FUNC int rtmem_pin_cpu(int iCpu) {
+#if (defined(__linux) || defined(__linux__)) && defined(CPU_SET)
+  cpu_set_t csMask;
+  int       iErrno;
+
+  if (iCpu < 0 || iCpu >= CPU_SETSIZE) {
+    if (giVerbose>0) {warning("\"-C\": %d: invalid CPU number\n",iCpu);}
+    return EINVAL;
+  }
+  CPU_ZERO(&csMask);
+  CPU_SET(iCpu, &csMask);
+  if (sched_setaffinity(0, sizeof(csMask), &csMask) != 0) {
+    iErrno = errno;
+    if (giVerbose>0) {warning("\"-C\": sched_setaffinity(): %s\n",
+                              strerror(iErrno)                     );}
+    return iErrno;
+  }
+  if (giVerbose>0) {warning("\"-C\": pinned to CPU %d\n",iCpu);}
+  return 0;
+#else
+  if (giVerbose>0) {warning("\"-C\": not supported on this host\n");}
+  return ENOSYS;
+#endif
+}
+
+
+
+#endif /* RTMEM_H */
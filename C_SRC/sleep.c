@@ -2,13 +2,32 @@
 #
 # SLEEP - Sleep Command Which Supported Non-Integer Numbers
 #
-# USAGE   : sleep seconds
+# USAGE   : sleep [-s spintime] seconds
 # Args    : seconds ... The number of second to sleep for. You can
 #                       give not only an integer number but also a
-#                       non-integer number here.
+#                       non-integer number here. It is read exactly
+#                       up to nanosecond.
+#                       You can also give a unit after the number.
+#                       Available units are 's', 'ms', 'us', 'ns'.
+# Options : -s spintime Spend the last "spintime" of the sleeping time
+#                       by busy-waiting instead of sleeping. It makes
+#                       the time more precise by avoiding the wake-up
+#                       latency of the OS, but it uses the CPU during
+#                       the spintime. The format is the same as the
+#                       argument "seconds" (e.g. "200us").
+# Note    : * The end of the sleep is fixed as an absolute time on the
+#             monotonic clock when this command starts. So, neither
+#             signals which interrupt the sleep nor changes of the
+#             system clock stretch or cut the sleeping time.
 # Retuen  : Return 0 only when succeeded to sleep
 #
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -DCLOCK_NANOSLEEP_SUPPORT
+#                  (if it doesn't work)
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt -DCLOCK_NANOSLEEP_SUPPORT
+#                  (if it doesn't work)
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
 #
 # Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2024-06-23
 #
@@ -28,23 +47,49 @@
 ####################################################################*/
 
 /*=== Initial Setting ==============================================*/
+#include <errno.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include "timeio.h"
+
+/* Buffer size for the argument */
+#define ARG_BUF 64
+
+typedef struct timespec tmsp;
+
+int  parse_duration(const char *pszArg, tmsp *ptsDur);
+void sleep_until(const tmsp *ptsWake);
 
 char* gpszCmdname;
+int   giVerbose;
 
 /*=== Define the functions for printing usage and error ============*/
 void print_usage_and_exit(void) {
   fprintf(stderr,
-    "USAGE   : %s seconds\n"
+    "USAGE   : %s [-s spintime] seconds\n"
     "Args    : seconds ... The number of second to sleep for. You can\n"
     "                      give not only an integer number but also a\n"
-    "                      non-integer number here.\n"
+    "                      non-integer number here. It is read exactly\n"
+    "                      up to nanosecond.\n"
+    "                      You can also give a unit after the number.\n"
+    "                      Available units are 's', 'ms', 'us', 'ns'.\n"
+    "Options : -s spintime Spend the last \"spintime\" of the sleeping time\n"
+    "                      by busy-waiting instead of sleeping. It makes\n"
+    "                      the time more precise by avoiding the wake-up\n"
+    "                      latency of the OS, but it uses the CPU during\n"
+    "                      the spintime. The format is the same as the\n"
+    "                      argument \"seconds\" (e.g. \"200us\").\n"
+    "Note    : * The end of the sleep is fixed as an absolute time on the\n"
+    "            monotonic clock when this command starts. So, neither\n"
+    "            signals which interrupt the sleep nor changes of the\n"
+    "            system clock stretch or cut the sleeping time.\n"
     "Retuen  : Return 0 only when succeeded to sleep\n"
-    "Version : 2024-06-23 13:28:01 JST\n"
+    "Version : 2026-10-18 22:55:12 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -55,6 +100,13 @@ void print_usage_and_exit(void) {
     ,gpszCmdname);
   exit(1);
 }
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr,szFormat,va);
+  va_end(va);
+}
 void error_exit(int iErrno, const char* szFormat, ...) {
   va_list va;
   va_start(va, szFormat);
@@ -72,28 +124,157 @@ void error_exit(int iErrno, const char* szFormat, ...) {
 int main(int argc, char *argv[]) {
 
   /*=== Initial Setting ============================================*/
-  struct timespec tspcSleeping_time;
-  double dNum;
-  int    i,iRet;
+  tmsp   tsWake;      /* the time to wake up (the end of the sleep)  */
+  tmsp   tsSpin;      /* the time to start busy-waiting              */
+  tmsp   tsDur;       /* the sleeping time                           */
+  tmsp   tsSpintime;  /* the busy-waiting time                       */
+  tmsp   tsNow;
+  int    i;
 
+  /* Fix the starting time first not to count the time for parsing */
+  if (clock_gettime(CLOCK_MONOTONIC,&tsWake) != 0) {
+    error_exit(errno,"clock_gettime() at initialize: %s\n",strerror(errno));
+  }
   gpszCmdname = argv[0];
   for (i=0; *(gpszCmdname+i)!='\0'; i++) {
     if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
   }
+  giVerbose = 0;
 
   /*=== Parse options ==============================================*/
-  if (argc != 2                         ) {print_usage_and_exit();}
-  if (sscanf(argv[1], "%lf", &dNum) != 1) {print_usage_and_exit();}
-  if (dNum > INT_MAX                    ) {print_usage_and_exit();}
+  tsSpintime.tv_sec  = 0;
+  tsSpintime.tv_nsec = 0;
+  /* (a negative number is not an option but just means no sleep) */
+  while (optind>=argc || argv[optind][0]!='-'                         ||
+         argv[optind][1]=='\0' || strchr(".0123456789",argv[optind][1])==NULL) {
+    if ((i=getopt(argc, argv, "s:h")) == -1) {break;}
+    switch (i) {
+      case 's': if (! parse_duration(optarg, &tsSpintime)) {
+                  print_usage_and_exit();
+                }
+                break;
+      case 'h': print_usage_and_exit();
+      default : print_usage_and_exit();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc != 1                         ) {print_usage_and_exit();}
+  if (! parse_duration(argv[0], &tsDur) ) {print_usage_and_exit();}
+  if (tsDur.tv_sec > INT_MAX            ) {print_usage_and_exit();}
 
   /*=== Sleep ======================================================*/
-  if (dNum <= 0                                   ) {exit(0);               }
-  tspcSleeping_time.tv_sec  = (time_t)dNum;
-  tspcSleeping_time.tv_nsec = (dNum - tspcSleeping_time.tv_sec) * 1000000000;
+  if (tsDur.tv_sec<0 || (tsDur.tv_sec==0 && tsDur.tv_nsec==0)) {exit(0);}
+  tsWake.tv_sec  += tsDur.tv_sec ;
+  tsWake.tv_nsec += tsDur.tv_nsec;
+  if (tsWake.tv_nsec>=1000000000) {tsWake.tv_sec++; tsWake.tv_nsec-=1000000000;}
+
+  /*--- Sleep until the spintime comes -----------------------------*/
+  tsSpin.tv_sec  = tsWake.tv_sec  - tsSpintime.tv_sec ;
+  tsSpin.tv_nsec = tsWake.tv_nsec - tsSpintime.tv_nsec;
+  if (tsSpin.tv_nsec<0) {tsSpin.tv_sec--; tsSpin.tv_nsec+=1000000000;}
+  sleep_until(&tsSpin);
 
-  iRet = nanosleep(&tspcSleeping_time, NULL);
-  if (iRet != 0) {error_exit(iRet,"Error happend while nanosleeping\n");}
+  /*--- Spend the spintime by busy-waiting -------------------------*/
+  if (tsSpintime.tv_sec>0 || tsSpintime.tv_nsec>0) {
+    do {
+      if (clock_gettime(CLOCK_MONOTONIC,&tsNow) != 0) {
+        error_exit(errno,"clock_gettime() while spinning: %s\n",
+                   strerror(errno));
+      }
+    } while ( tsNow.tv_sec <  tsWake.tv_sec                               ||
+             (tsNow.tv_sec == tsWake.tv_sec && tsNow.tv_nsec < tsWake.tv_nsec));
+  }
 
   /*=== Finish =====================================================*/
   return 0;
 }
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Parse the duration string exactly ==============================
+ * The number is parsed by parse_unixtime() in timeio.h, which reads
+ * the decimal digits as they are without converting into a double.
+ * [in]  pszArg : String to be parsed ("[+|-]n[.n]"[+unit])
+ * [out] ptsDur : The duration (can be negative)
+ * [ret] 1 : Succeeded
+ *       0 : It is not a duration                                   */
+int parse_duration(const char *pszArg, tmsp *ptsDur) {
+
+  /*--- Variables --------------------------------------------------*/
+  char    szNum[ARG_BUF]; /* the number part of the argument        */
+  char   *pszUnit;        /* the unit part of the argument          */
+  int64_t i8Div;          /* divisor for the unit                   */
+  int64_t i8Rem;
+
+  /*--- Separate the number and the unit ---------------------------*/
+  if (strlen(pszArg) >= ARG_BUF) {return 0;}
+  strcpy(szNum, pszArg);
+  for (pszUnit=szNum; *pszUnit!='\0'; pszUnit++) {
+    if (strchr("+-.0123456789", *pszUnit) == NULL) {break;}
+  }
+  if      (strcmp(pszUnit,""  )==0) {i8Div =          1;}
+  else if (strcmp(pszUnit,"s" )==0) {i8Div =          1;}
+  else if (strcmp(pszUnit,"ms")==0) {i8Div =       1000;}
+  else if (strcmp(pszUnit,"us")==0) {i8Div =    1000000;}
+  else if (strcmp(pszUnit,"ns")==0) {i8Div = 1000000000;}
+  else                              {return 0;          }
+  if (pszUnit == szNum) {return 0;}
+  *pszUnit = '\0';
+
+  /*--- Parse the number -------------------------------------------*/
+  if (! parse_unixtime(szNum, ptsDur)) {return 0;}
+  if (szNum[0] == '-') {
+    /* parse_unixtime() applies the sign only to the integer part, but
+       any negative duration just means no sleep                      */
+    if (ptsDur->tv_sec!=0 || ptsDur->tv_nsec!=0) {ptsDur->tv_sec = -1;}
+    ptsDur->tv_nsec = 0;
+    return 1;
+  }
+
+  /*--- Apply the unit ---------------------------------------------*/
+  if (i8Div > 1) {
+    /* floor division of the seconds, and the rest goes to the nsec */
+    i8Rem = (int64_t)ptsDur->tv_sec % i8Div;
+    if (i8Rem < 0) {i8Rem += i8Div;}
+    ptsDur->tv_sec  = (time_t)(((int64_t)ptsDur->tv_sec - i8Rem) / i8Div);
+    ptsDur->tv_nsec = (long)((i8Rem*1000000000 + ptsDur->tv_nsec) / i8Div);
+  }
+  return 1;
+}
+
+/*=== Sleep until the time on the monotonic clock ====================
+ * The sleep is resumed when a signal interrupts it.
+ * [in] ptsWake : The time to wake up (CLOCK_MONOTONIC)             */
+void sleep_until(const tmsp *ptsWake) {
+#ifdef CLOCK_NANOSLEEP_SUPPORT
+  int  iRet;
+
+  while ((iRet=clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,ptsWake,NULL))
+         != 0                                                             ) {
+    if (iRet == EINTR) {continue;}
+    error_exit(iRet,"clock_nanosleep(): %s\n",strerror(iRet));
+  }
+#else
+  tmsp tsNow;
+  tmsp tsLength;
+
+  while (1) {
+    if (clock_gettime(CLOCK_MONOTONIC,&tsNow) != 0) {
+      error_exit(errno,"clock_gettime() in sleep_until(): %s\n",
+                 strerror(errno));
+    }
+    tsLength.tv_sec  = ptsWake->tv_sec  - tsNow.tv_sec ;
+    tsLength.tv_nsec = ptsWake->tv_nsec - tsNow.tv_nsec;
+    if (tsLength.tv_nsec<0) {tsLength.tv_nsec+=1000000000; tsLength.tv_sec--;}
+    if (tsLength.tv_sec < 0) {return;}
+    if (nanosleep(&tsLength,NULL) == 0) {return;}
+    if (errno != EINTR) {
+      error_exit(errno,"nanosleep(): %s\n",strerror(errno));
+    }
+  }
+#endif
+}
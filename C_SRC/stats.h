@@ -0,0 +1,391 @@
+/*####################################################################
+#
+# STATS.H - Live Counters Shared by the Stream Commands Here
+#
+# USAGE   : #include "stats.h"
+#           (in the "headers" section of a command's source file)
+# Provides: stats_start() ... Start the statistics thread. Call it in
+#                             the main thread BEFORE creating any other
+#                             threads.
+#           stats_add() ..... Add a number to one of the counters
+#           stats_pass() .... Add numbers to both the input and output
+#                             counters
+#           stats_slept() ... Count a timed sleep and record how late
+#                             the command woke up
+# Counters: bytes_in  ..... Bytes read from the input
+#           lines_in  ..... Lines (LFs) read from the input
+#           bytes_out ..... Bytes written into the stdout
+#           lines_out ..... Lines (LFs) written into the stdout
+#           dropped   ..... Lines thrown away
+#           drained   ..... Lines sent to the drain (-d option)
+#           sleeps .......  Timed sleeps/waits the command did
+#           giveups ......  Times the command gave up recovering the
+#                           lost time (valve)
+#           oversleep_us .  Histogram of the oversleeping time of each
+#                           sleep. The i-th number (from 0) is the
+#                           count of the sleeps which were late by
+#                           [2^(i-1),2^i) microseconds. The first one is
+#                           for less than 1us and the last one is for
+#                           2^(STATS_HIST_NUM-2)us or more.
+#           minflt .......  Minor page faults of the process so far
+#           majflt .......  Major page faults of the process so far
+#                           (These two are from getrusage(). They show
+#                           whether memory locking works. See rtmem.h.)
+# Output  : One line for each snapshot with the following format.
+#             cmd=valve pid=123 time=1760000000.123456789 bytes_in=...
+#           Every field is a "name=value" word without any quotations,
+#           so you can import a snapshot into shell variables with eval.
+#           * A snapshot is written into the stderr when the command
+#             receives SIGUSR1.
+#           * If a statistics file is given to stats_start(), a snapshot
+#             is written into it instead every STATS_ITRVL_MSEC millisecs,
+#             when SIGUSR1 comes, and at exit. A regular file always has
+#             only the latest snapshot, and a named pipe or character
+#             special file gets a line for each snapshot. (A snapshot for
+#             a named pipe is discarded while nobody reads it.)
+# Requires: The including source file MUST define the following ones.
+#             int  giVerbose;
+#             void warning(const char* szFormat, ...);
+#             void error_exit(int iErrno, const char* szFormat, ...);
+#           And it MUST be compiled with the -pthread option.
+# Note    : * Each counter has its own cache line so that the updating
+#             thread and the reporting thread never share one. The
+#             counters are designed for a single writer (the thread
+#             which runs the main loop), so the update is a relaxed
+#             atomic load and store, not a locked read-modify-write.
+#           * SIGUSR1 is blocked in all threads but the statistics
+#             thread. So, it never interrupts the sleeps of the command.
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+#ifndef STATS_H
+#define STATS_H
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*--- macro constants ----------------------------------------------*/
+/* Size of a cache line, which every counter is aligned to */
+#define STATS_CACHELINE 64
+/* The number of buckets of the oversleeping histogram */
+#define STATS_HIST_NUM 24
+/* Interval time of writing a snapshot into the statistics file */
+#define STATS_ITRVL_MSEC 1000
+/* Buffer size for a snapshot line */
+#define STATS_LINE_BUF 1024
+/* Attributes for the functions and the counters here */
+#if defined(__GNUC__)
+  #define STATS_FUNC  static __attribute__((unused))
+  #define STATS_ALIGN __attribute__((aligned(STATS_CACHELINE)))
+#else
+  #define STATS_FUNC  static
+  #define STATS_ALIGN
+#endif
+/* Load and store a counter without tearing */
+#if defined(__ATOMIC_RELAXED)
+  #define STATS_LOAD(p)    __atomic_load_n((p),__ATOMIC_RELAXED)
+  #define STATS_STORE(p,v) __atomic_store_n((p),(v),__ATOMIC_RELAXED)
+#else
+  #define STATS_LOAD(p)    (*(volatile unsigned long long*)(p))
+  #define STATS_STORE(p,v) (*(volatile unsigned long long*)(p)=(v))
+#endif
+
+/*--- counter IDs --------------------------------------------------*/
+enum {
+  ST_BYTES_IN = 0,
+  ST_LINES_IN    ,
+  ST_BYTES_OUT   ,
+  ST_LINES_OUT   ,
+  ST_DROPPED     ,
+  ST_DRAINED     ,
+  ST_SLEEPS      ,
+  ST_GIVEUPS     ,
+  ST_OVERSLEEP   ,  /* top of the histogram (STATS_HIST_NUM counters) */
+  ST_NUM = ST_OVERSLEEP + STATS_HIST_NUM
+};
+
+/*--- things the including file has to define ----------------------*/
+extern int giVerbose;
+void warning(const char* szFormat, ...);
+void error_exit(int iErrno, const char* szFormat, ...);
+
+/*--- global variables ---------------------------------------------*/
+static struct {             /* A counter occupying a cache line       */
+  unsigned long long ullVal;
+  char cPad[STATS_CACHELINE-sizeof(unsigned long long)];
+} gstStats[ST_NUM] STATS_ALIGN;
+static const char* gpszStatsName[ST_OVERSLEEP] = {
+  "bytes_in", "lines_in", "bytes_out", "lines_out",
+  "dropped" , "drained" , "sleeps"   , "giveups"
+};
+static struct {             /* Control block of the statistics thread */
+  const char*     pszCmd;   /* The name of the command                */
+  const char*     pszFile;  /* Statistics file (NULL means stderr)    */
+  int             iFd;      /* File descriptor of the file (-1:none)  */
+  int             iFdType;  /* 0:stderr 1:regular file 2:other        */
+  int             iPipe[2]; /* Self-pipe to wake the thread up        */
+  pthread_t       tTh_id;   /* ID of the statistics thread            */
+  int             iRunning; /* 1 while the thread is running          */
+  pthread_mutex_t mu;       /* Mutex for writing a snapshot           */
+} gstStatsCtl = {NULL, NULL, -1, 0, {-1,-1}, 0, 0,
+                 PTHREAD_MUTEX_INITIALIZER};
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Add a number to a counter ======================================
+ * Only one thread may update each counter.
+ * [in] iId : Counter ID (ST_*)
+ *      ull : The number to add                                     */
+STATS_FUNC void stats_add(int iId, unsigned long long ull) {
+  STATS_STORE(&gstStats[iId].ullVal, STATS_LOAD(&gstStats[iId].ullVal)+ull);
+}
+
+/*=== Count data passed through as it is ============================
+ * This is for the commands which send every byte they read to the
+ * stdout. It adds the numbers to both the input and output counters.
+ * [in] ullBytes : The number of bytes passed through
+ *      ullLines : The number of LFs in them                        */
+STATS_FUNC void stats_pass(unsigned long long ullBytes,
+                           unsigned long long ullLines) {
+  stats_add(ST_BYTES_IN , ullBytes);
+  stats_add(ST_BYTES_OUT, ullBytes);
+  if (ullLines) {
+    stats_add(ST_LINES_IN , ullLines);
+    stats_add(ST_LINES_OUT, ullLines);
+  }
+}
+
+/*=== Count a timed sleep and record the oversleeping time ===========
+ * [in] ptsTo  : The time until which the command wanted to sleep
+ *      ptsNow : The time when the command actually woke up
+ *               (Both have to be measured with the same clock.)    */
+STATS_FUNC void stats_slept(const struct timespec *ptsTo,
+                            const struct timespec *ptsNow) {
+  long long llUs;
+  int       i;
+
+  stats_add(ST_SLEEPS, 1);
+  llUs = (long long)(ptsNow->tv_sec - ptsTo->tv_sec) * 1000000
+         + (ptsNow->tv_nsec - ptsTo->tv_nsec) / 1000;
+  for (i=0; llUs>0 && i<STATS_HIST_NUM-1; i++) {llUs >>= 1;}
+  stats_add(ST_OVERSLEEP+i, 1);
+}
+
+/*=== Make a snapshot line ===========================================
+ * [in]  pszBuf : Buffer for the line (STATS_LINE_BUF bytes or more)
+ * [ret] The length of the line                                     */
+STATS_FUNC int stats_sprint(char *pszBuf) {
+  struct timespec ts;
+  struct rusage   ru;
+  int             i, iLen;
+
+  if (clock_gettime(CLOCK_REALTIME,&ts) != 0) {ts.tv_sec=0; ts.tv_nsec=0;}
+  iLen = snprintf(pszBuf, STATS_LINE_BUF, "cmd=%s pid=%ld time=%lld.%09ld",
+                  gstStatsCtl.pszCmd, (long)getpid(),
+                  (long long)ts.tv_sec, ts.tv_nsec                       );
+  for (i=0; i<ST_OVERSLEEP; i++) {
+    iLen += snprintf(pszBuf+iLen, STATS_LINE_BUF-iLen, " %s=%llu",
+                     gpszStatsName[i], STATS_LOAD(&gstStats[i].ullVal));
+  }
+  for (i=0; i<STATS_HIST_NUM; i++) {
+    iLen += snprintf(pszBuf+iLen, STATS_LINE_BUF-iLen, "%s%llu",
+                     (i==0) ? " oversleep_us=" : ",",
+                     STATS_LOAD(&gstStats[ST_OVERSLEEP+i].ullVal));
+  }
+  if (getrusage(RUSAGE_SELF,&ru) != 0) {ru.ru_minflt=0; ru.ru_majflt=0;}
+  iLen += snprintf(pszBuf+iLen, STATS_LINE_BUF-iLen, " minflt=%ld majflt=%ld\n",
+                   (long)ru.ru_minflt, (long)ru.ru_majflt                 );
+  return iLen;
+}
+
+/*=== Write a snapshot ===============================================
+ * [in] gstStatsCtl : The destination of the snapshot               */
+STATS_FUNC void stats_write(void) {
+  char szBuf[STATS_LINE_BUF];
+  int  iLen;
+  int  iFd;
+
+  pthread_mutex_lock(&gstStatsCtl.mu);
+  iLen = stats_sprint(szBuf);
+  switch (gstStatsCtl.iFdType) {
+    case 0 : /* stderr */
+             if (write(STDERR_FILENO,szBuf,iLen) < 0) {break;}
+             break;
+    case 1 : /* regular file: overwrite with the latest one */
+             if (pwrite(gstStatsCtl.iFd,szBuf,iLen,0) < 0) {
+               if (giVerbose>0) {warning("stats: %s\n",strerror(errno));}
+               break;
+             }
+             if (ftruncate(gstStatsCtl.iFd,iLen) < 0) {break;}
+             break;
+    default: /* named pipe etc.: open it without blocking if not yet */
+             if (gstStatsCtl.iFd < 0) {
+               iFd = open(gstStatsCtl.pszFile, O_WRONLY|O_NONBLOCK);
+               if (iFd < 0) {break;} /* nobody reads it now */
+               gstStatsCtl.iFd = iFd;
+             }
+             if (write(gstStatsCtl.iFd,szBuf,iLen) < 0) {
+               if (errno == EAGAIN) {break;} /* the reader is too slow */
+               close(gstStatsCtl.iFd); gstStatsCtl.iFd = -1;
+             }
+             break;
+  }
+  pthread_mutex_unlock(&gstStatsCtl.mu);
+}
+
+/*=== SIGNALHANDLER : Request a snapshot =============================
+ * This function wakes the statistics thread up through the self-pipe.
+ */
+STATS_FUNC void stats_request(int iSig) {
+  int iErrno;
+
+  iErrno = errno;
+  if (write(gstStatsCtl.iPipe[1],"s",1) < 0) {errno=iErrno; return;}
+  errno = iErrno;
+}
+
+/*=== The statistics thread ==========================================
+ * This thread writes a snapshot when SIGUSR1 comes or the interval
+ * time has passed (only with the statistics file), and finishes when
+ * it gets "q" from the self-pipe.                                  */
+STATS_FUNC void* stats_thread(void* pvArgs) {
+  struct pollfd stPfd;
+  sigset_t      ssMask;
+  char          szBuf[16];
+  int           iQuit;
+  int           i, j;
+
+  /*--- Accept only SIGUSR1 in this thread -------------------------*/
+  sigemptyset(&ssMask);
+  sigaddset(&ssMask, SIGUSR1);
+  pthread_sigmask(SIG_UNBLOCK, &ssMask, NULL);
+
+  /*--- Wait for a request and write a snapshot --------------------*/
+  stPfd.fd     = gstStatsCtl.iPipe[0];
+  stPfd.events = POLLIN;
+  iQuit        = 0;
+  while (! iQuit) {
+    i = poll(&stPfd, 1, (gstStatsCtl.pszFile) ? STATS_ITRVL_MSEC : -1);
+    if (i < 0) {continue;} /* EINTR by SIGUSR1 (the pipe has a byte) */
+    if (i > 0) {
+      while ((i=read(gstStatsCtl.iPipe[0],szBuf,sizeof(szBuf))) > 0) {
+        for (j=0; j<i; j++) {if (szBuf[j]=='q') {iQuit=1;}}
+      }
+    }
+    stats_write();
+  }
+  return NULL;
+}
+
+/*=== EXITHANDLER : Stop the statistics thread =======================
+ * The thread writes the final snapshot into the statistics file before
+ * finishing.                                                       */
+STATS_FUNC void stats_stop(void) {
+  if (! gstStatsCtl.iRunning) {return;}
+  gstStatsCtl.iRunning = 0;
+  if (pthread_equal(pthread_self(),gstStatsCtl.tTh_id)) {return;}
+  if (write(gstStatsCtl.iPipe[1],"q",1) < 0) {return;}
+  pthread_join(gstStatsCtl.tTh_id, NULL);
+}
+
+/*=== Start the statistics thread ====================================
+ * [in] pszCmd  : The name of the command
+ *      pszFile : Statistics file (NULL means that the snapshots are
+ *                written into the stderr only when SIGUSR1 comes)  */
+STATS_FUNC void stats_start(const char *pszCmd, const char *pszFile) {
+  struct sigaction sa;
+  struct stat      st;
+  sigset_t         ssAll, ssOld;
+  int              i;
+
+  /*--- Open the statistics file -----------------------------------*/
+  gstStatsCtl.pszCmd  = pszCmd;
+  gstStatsCtl.pszFile = pszFile;
+  if (pszFile == NULL) {
+    gstStatsCtl.iFdType = 0;
+  } else if (stat(pszFile,&st)==0 && !S_ISREG(st.st_mode)) {
+    gstStatsCtl.iFdType = 2; /* It will be opened when writing */
+  } else {
+    gstStatsCtl.iFdType = 1;
+    gstStatsCtl.iFd = open(pszFile, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (gstStatsCtl.iFd < 0) {
+      error_exit(errno,"%s: %s\n",pszFile,strerror(errno));
+    }
+  }
+
+  /*--- Make the self-pipe -----------------------------------------*/
+  if (pipe(gstStatsCtl.iPipe) < 0) {
+    error_exit(errno,"pipe() in stats_start(): %s\n",strerror(errno));
+  }
+  for (i=0; i<2; i++) {
+    if (fcntl(gstStatsCtl.iPipe[i],F_SETFL,O_NONBLOCK) < 0) {
+      error_exit(errno,"fcntl() in stats_start(): %s\n",strerror(errno));
+    }
+  }
+
+  /*--- Start the thread with all signals blocked ------------------*/
+  sigfillset(&ssAll);
+  if ((i=pthread_sigmask(SIG_SETMASK,&ssAll,&ssOld)) != 0) {
+    error_exit(i,"pthread_sigmask() #1 in stats_start(): %s\n",strerror(i));
+  }
+  memset(&sa, 0, sizeof(sa));
+  sigemptyset(&sa.sa_mask);
+  sa.sa_handler = stats_request;
+  sa.sa_flags   = SA_RESTART;
+  if (sigaction(SIGUSR1,&sa,NULL) != 0) {
+    error_exit(errno,"sigaction() in stats_start(): %s\n",strerror(errno));
+  }
+  i = pthread_create(&gstStatsCtl.tTh_id, NULL, &stats_thread, NULL);
+  if (i) {error_exit(i,"pthread_create() in stats_start(): %s\n",strerror(i));}
+  gstStatsCtl.iRunning = 1;
+  if (pszFile != NULL && atexit(stats_stop) != 0) {
+    error_exit(255,"atexit() in stats_start() failed\n");
+  }
+
+  /*--- Keep SIGUSR1 blocked in the caller (and threads it'll make) */
+  sigaddset(&ssOld, SIGUSR1);
+  if ((i=pthread_sigmask(SIG_SETMASK,&ssOld,NULL)) != 0) {
+    error_exit(i,"pthread_sigmask() #2 in stats_start(): %s\n",strerror(i));
+  }
+  if (giVerbose>0) {
+    warning("statistics thread started (%s)\n",
+            (pszFile) ? pszFile : "SIGUSR1 -> stderr");
+  }
+}
+
+
+
+#endif
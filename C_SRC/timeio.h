@@ -0,0 +1,593 @@
+/*####################################################################
+#
+# TIMEIO.H - Timestamp Parser/Formatter Shared by the Commands Here
+#
+# USAGE   : #include "timeio.h"
+#           (in the "headers" section of a command's source file)
+# Provides: parse_calendartime() ... "YYYYMMDDhhmmss[.n]" -> timespec
+#           parse_unixtime() ....... "[+|-]n[.n]"         -> timespec
+#           parse_iso8601time() .... "YYYY-MM-DDThh:mm:ss[,n][{+|-}hh:mm|Z]"
+#                                                         -> timespec
+#           sprint_calendartime() .. time_t -> "YYYYMMDDhhmmss" + decimals
+#           sprint_iso8601time() ... time_t -> "YYYY-MM-DDThh:mm:ss"
+#                                              + decimals + "{+|-}hh:mm"
+# Requires: The including source file MUST define the following ones.
+#             int  giVerbose;
+#             void warning(const char* szFormat, ...);
+# Note    : * Every function in this file is "static" so that each
+#             command can still be compiled from its single source file
+#             by MAKE.sh. (MAKE.sh compiles sources in this directory,
+#             so no extra compiler option is needed.)
+#           * The parsers do neither strptime() nor mktime() for every
+#             timestamp. Fixed-width digits are converted 8 digits at a
+#             time, and the offset of the local timezone is looked up in
+#             a small cache which is filled by mktime() once an hour of
+#             the calendar. The formatters keep the result of
+#             localtime() for the current minute in the same way.
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+#ifndef TIMEIO_H
+#define TIMEIO_H
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*--- macro constants ----------------------------------------------*/
+/* The number of entries of the timezone offset cache (power of 2) */
+#define TZCACHE_NUM 64
+/* Attribute for the functions here (Commands don't use all of them) */
+#if defined(__GNUC__)
+  #define TIMEIO_FUNC static __attribute__((unused))
+#else
+  #define TIMEIO_FUNC static
+#endif
+/* Macro to tell whether the char is a digit */
+#define IS_DIGIT(c) ((unsigned char)((c)-'0')<10)
+
+/*--- things the including file has to define ----------------------*/
+extern int giVerbose;
+void warning(const char* szFormat, ...);
+
+/*--- global variables ---------------------------------------------*/
+static struct {     /* Timezone offset cache for the parsers          */
+  long long llKey;  /* The hour number since 1970-01-01T00 (calendar) */
+  long long llOffs; /* (calendar-time as UTC) - (real UNIX-time)      */
+  int       iValid; /* 1 if this entry is available                   */
+} gstTzcache[TZCACHE_NUM];
+static struct {     /* localtime() cache for the formatters           */
+  time_t    tMin;   /* UNIX-time of the top of the minute cached      */
+  struct tm tmMin;  /* The result of localtime() for tMin             */
+  char      szTmz[7];/* Timezone string ("{+|-}hh:mm") for tMin       */
+  int       iValid; /* 1 if this cache is available                   */
+} gstLtcache;
+static const long glPow10[10] = {1000000000L, 100000000L, 10000000L,
+                                    1000000L,    100000L,    10000L,
+                                       1000L,       100L,       10L, 1L};
+static const char gszIsoPat[] = "-00-00T00:00:00"; /* '0' means a digit */
+
+
+
+/*####################################################################
+# Functions (Helpers)
+####################################################################*/
+
+/*=== Convert 8 digit characters into a number at once ===============
+ * [in]  psz : Pointer to the 8 digit characters (MUST be all digits)
+ * [ret] The number                                                 */
+TIMEIO_FUNC unsigned long conv_8digits(const char *psz) {
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && \
+    __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+  /*--- SWAR (for little endian hosts) -----------------------------*/
+  unsigned long long u;
+  memcpy(&u, psz, 8);
+  u = ((u & 0x0F0F0F0F0F0F0F0FULL) *           2561ULL) >>  8; /* 2dgt */
+  u = ((u & 0x00FF00FF00FF00FFULL) *        6553601ULL) >> 16; /* 4dgt */
+  u = ((u & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32; /* 8dgt */
+  return (unsigned long)u;
+#else
+  /*--- One by one (for the other hosts) ---------------------------*/
+  unsigned long ul = 0;
+  int           i;
+  for (i=0; i<8; i++) {ul = ul*10 + (psz[i]-'0');}
+  return ul;
+#endif
+}
+
+/*=== Convert the digit characters into a number =====================
+ * [in]  psz  : Pointer to the digit characters (MUST be all digits)
+ *       iLen : The number of the digits (up to 19)
+ * [ret] The number                                                 */
+TIMEIO_FUNC unsigned long long conv_digits(const char *psz, int iLen) {
+
+  unsigned long long ull = 0;
+
+  for (; iLen>=8; iLen-=8, psz+=8) {ull = ull*100000000ULL+conv_8digits(psz);}
+  for (; iLen> 0; iLen--  , psz++ ) {ull = ull*10 + (*psz-'0');              }
+  return ull;
+}
+
+/*=== Convert 2 digit characters into a number =======================
+ * [in]  psz : Pointer to the 2 characters
+ * [ret] >=0 : The number
+ *       < 0 : Not digits                                           */
+TIMEIO_FUNC int conv_2digits(const char *psz) {
+  if (! IS_DIGIT(psz[0]) || ! IS_DIGIT(psz[1])) {return -1;}
+  return (psz[0]-'0')*10 + (psz[1]-'0');
+}
+
+/*=== Read the decimal part of a timestamp ===========================
+ * [in]  psz    : Pointer to the next character of the decimal point
+ *       plNsec : To be set the number in nanoseconds
+ * [ret] The number of the characters consumed. The digits after the
+ *       9th one are consumed but ignored.                          */
+TIMEIO_FUNC int read_decimals(const char *psz, long *plNsec) {
+
+  int i;
+
+  for (i=0; i<9 && IS_DIGIT(psz[i]); i++);
+  *plNsec = (long)conv_digits(psz, i) * glPow10[i];
+  while (IS_DIGIT(psz[i])) {i++;}
+  return i;
+}
+
+/*=== Count the days since 1970-01-01 of the Gregorian calendar ======
+ * [in]  llY  : Year
+ *       iMon : Month (1-12)
+ *       iDay : Day (out of the range of the month is allowed as well
+ *              as mktime())
+ * [ret] The days                                                   */
+TIMEIO_FUNC long long days_since_epoch(long long llY, int iMon,
+                                      int iDay                 ) {
+
+  long long llEra;
+  int       iYoe, iDoy;
+
+  llY  -= (iMon<=2);
+  llEra = ((llY>=0) ? llY : llY-399) / 400;
+  iYoe  = (int)(llY - llEra*400);
+  iDoy  = (153*(iMon+((iMon>2)?-3:9))+2)/5;
+  return llEra*146097 + (long long)iYoe*365 + iYoe/4 - iYoe/100 + iDoy
+         + (iDay-1) - 719468;
+}
+
+/*=== Call mktime() for a local calendar time ========================
+ * [in]  llY..iSec : The calendar time in the localtime
+ *       ptSec     : To be set the UNIX-time
+ * [ret] > 0 : success
+ *       ==0 : error (mktime() failed)                              */
+TIMEIO_FUNC int localcal_mktime(long long llY, int iMon, int iDay,
+                                int iHour, int iMin, int iSec,
+                                time_t *ptSec                ) {
+
+  struct tm tmDate;
+
+  if (llY-1900<-2147483647LL || llY-1900>2147483647LL) {return 0;}
+  memset(&tmDate, 0, sizeof(tmDate));
+  tmDate.tm_year = (int)(llY-1900);
+  tmDate.tm_mon  = iMon-1;
+  tmDate.tm_mday = iDay;
+  tmDate.tm_hour = iHour;
+  tmDate.tm_min  = iMin;
+  tmDate.tm_sec  = iSec;
+  errno = 0;
+  *ptSec = mktime(&tmDate);
+  if (*ptSec==(time_t)-1 && errno) {
+    if (giVerbose>1) {warning("mktime(): %s\n", strerror(errno));}
+    return 0;
+  }
+  return 1;
+}
+
+/*=== Convert a local calendar time into the UNIX-time ===============
+ * This is the same as mktime() with tm_isdst=0 (standard time), but
+ * mktime() is called only twice per hour of the calendar. An hour is
+ * cached only when its top and its end have the same UTC offset. The
+ * other hours (the offset changes inside, e.g. the half-hour shifts
+ * of Australia/Lord_Howe, or the top of it doesn't exist) are always
+ * converted by mktime() for the exact time.
+ * [in]  llY..iSec : The calendar time in the localtime
+ *       ptSec     : To be set the UNIX-time
+ * [ret] > 0 : success
+ *       ==0 : error (mktime() failed)                              */
+TIMEIO_FUNC int localcal_to_unixtime(long long llY, int iMon, int iDay,
+                                     int iHour, int iMin, int iSec,
+                                     time_t *ptSec                ) {
+
+  long long llHour; /* Hours since 1970-01-01T00 (calendar as UTC)  */
+  time_t    tTop;   /* UNIX-time of HH:00:00                        */
+  time_t    tEnd;   /* UNIX-time of HH:59:59                        */
+  int       i;
+
+  /*--- Look up the offset cache -----------------------------------*/
+  llHour = days_since_epoch(llY, iMon, iDay)*24 + iHour;
+  i      = (int)((unsigned long long)llHour & (TZCACHE_NUM-1));
+  if ((! gstTzcache[i].iValid) || (gstTzcache[i].llKey != llHour)) {
+    /*--- Cache miss: ask mktime() about the top and the end -------*/
+    if (! localcal_mktime(llY,iMon,iDay,iHour, 0, 0,&tTop) ||
+        ! localcal_mktime(llY,iMon,iDay,iHour,59,59,&tEnd) ||
+        (long long)tEnd-(long long)tTop != 3599               ) {
+      /* The offset is not the same in the hour. Never cache it. */
+      return localcal_mktime(llY,iMon,iDay,iHour,iMin,iSec,ptSec);
+    }
+    gstTzcache[i].llKey  = llHour;
+    gstTzcache[i].llOffs = llHour*3600 - (long long)tTop;
+    gstTzcache[i].iValid = 1;
+  }
+
+  /*--- Apply the offset -------------------------------------------*/
+  *ptSec = (time_t)(llHour*3600 + iMin*60 + iSec - gstTzcache[i].llOffs);
+  return 1;
+}
+
+/*=== Check the range of each calendar field =========================
+ * [ret] > 0 : valid (the same range as strptime() allows)
+ *       ==0 : invalid                                              */
+TIMEIO_FUNC int is_valid_calendar(int iMon, int iDay, int iHour,
+                                  int iMin, int iSec              ) {
+  return (1<=iMon && iMon<=12) && (1<=iDay && iDay<=31) &&
+         (0<=iHour && iHour<=23) && (0<=iMin && iMin<=59) &&
+         (0<=iSec && iSec<=61);
+}
+
+/*=== Get localtime() of the time with the minute cache ==============
+ * [in]  tSec : UNIX-time
+ * [ret] The pointer to the "tm" structure, or NULL if failed. The
+ *       timezone string for it is in gstLtcache.szTmz.             */
+TIMEIO_FUNC struct tm *localtime_cached(time_t tSec) {
+
+  static struct tm tmRet;
+  struct tm       *ptm;
+  time_t           tMin;
+
+  /*--- Refresh the cache when the minute has changed --------------*/
+  tMin = tSec - (((tSec%60)+60)%60);
+  if ((! gstLtcache.iValid) || (gstLtcache.tMin != tMin)) {
+    if ((ptm=localtime(&tMin)) == NULL) {return NULL;}
+    if (ptm->tm_sec != 0) {
+      /* The timezone whose offset is not a multiple of a minute
+         (such as LMT) can't be cached */
+      gstLtcache.iValid = 0;
+      if ((ptm=localtime(&tSec)) == NULL) {return NULL;}
+      strftime(gstLtcache.szTmz, 6, "%z", ptm);
+      gstLtcache.szTmz[6]=0; gstLtcache.szTmz[5]=gstLtcache.szTmz[4];
+      gstLtcache.szTmz[4]=gstLtcache.szTmz[3]; gstLtcache.szTmz[3]=':';
+      return ptm;
+    }
+    memcpy(&gstLtcache.tmMin, ptm, sizeof(struct tm));
+    strftime(gstLtcache.szTmz, 6, "%z", ptm);
+    gstLtcache.szTmz[6]=0; gstLtcache.szTmz[5]=gstLtcache.szTmz[4];
+    gstLtcache.szTmz[4]=gstLtcache.szTmz[3]; gstLtcache.szTmz[3]=':';
+    gstLtcache.tMin   = tMin;
+    gstLtcache.iValid = 1;
+  }
+
+  /*--- Make the result --------------------------------------------*/
+  memcpy(&tmRet, &gstLtcache.tmMin, sizeof(struct tm));
+  tmRet.tm_sec = (int)(tSec - tMin);
+  return &tmRet;
+}
+
+/*=== Write a 2 digit number =========================================*/
+TIMEIO_FUNC char *put_2digits(char *psz, int i) {
+  psz[0] = (char)('0' + i/10);
+  psz[1] = (char)('0' + i%10);
+  return psz+2;
+}
+
+
+
+/*####################################################################
+# Functions (Parsers)
+####################################################################*/
+
+/*=== Parse a local calendar time ====================================
+ * [in]  pszTime : calendar-time string in the localtime
+ *                 (/[0-9]{11,20}(\.[0-9]{1,9})?/)
+ *       ptsTime : To be set the parsed time ("timespec" structure)
+ * [ret] > 0 : success
+ *       ==0 : error (failure to parse)                             */
+TIMEIO_FUNC int parse_calendartime(char* pszTime,
+                                   struct timespec *ptsTime) {
+
+  /*--- Variables --------------------------------------------------*/
+  int       i, iY;       /* length of the integer part and of the year */
+  int       iMon, iDay, iHour, iMin, iSec;
+  long      lNsec;
+  char     *psz;
+
+  /*--- Find the end of the integer part ---------------------------*/
+  for (i=0; IS_DIGIT(pszTime[i]); i++) {
+    if (i<20) {continue;}
+    warning("The integer part of the timestamp is too big "
+            "as a calendar-time\n");
+    return 0;
+  }
+  switch (pszTime[i]) {
+    case '.' : psz = pszTime+i+1+read_decimals(pszTime+i+1, &lNsec);
+               break;
+    case 0   :
+    case ' ' :
+    case '\t': psz = pszTime+i; lNsec = 0;
+               break;
+    default  : if (giVerbose>0) {
+                 warning("%c: Unexpected chr. in the integer part\n",
+                         pszTime[i]                                  );
+               }
+               return 0;
+  }
+  if (*psz!=0 && *psz!=' ' && *psz!='\t') {
+    if (giVerbose>0) {
+      warning("%c: Unexpected chr. in the decimal part\n",*psz);
+    }
+    return 0;
+  }
+  if ((iY=i-10) <= 0) {return 0;}
+
+  /*--- Convert the fixed-width fields -----------------------------*/
+  psz   = pszTime+iY;
+  iMon  = conv_2digits(psz  );
+  iDay  = conv_2digits(psz+2);
+  iHour = conv_2digits(psz+4);
+  iMin  = conv_2digits(psz+6);
+  iSec  = conv_2digits(psz+8);
+  if (! is_valid_calendar(iMon, iDay, iHour, iMin, iSec)) {
+    if (giVerbose>1) {
+      warning("%s: Invalid calendartime string\n", pszTime);
+    }
+    return 0;
+  }
+
+  /*--- Pack the time into the timespec structure ------------------*/
+  if (! localcal_to_unixtime((long long)conv_digits(pszTime,iY), iMon, iDay,
+                             iHour, iMin, iSec, &ptsTime->tv_sec        )) {
+    if (giVerbose>1) {
+      warning("%s: Invalid calendartime string\n", pszTime);
+    }
+    return 0;
+  }
+  ptsTime->tv_nsec = lNsec;
+
+  return 1;
+}
+
+/*=== Parse a UNIX-time ==============================================
+ * [in]  pszTime : UNIX-time string (/[+-]?[0-9]{1,19}(\.[0-9]{1,9})?/)
+ *       ptsTime : To be set the parsed time ("timespec" structure)
+ *                 (The integer part will be LLONG_MAX if it is bigger.
+ *                  And the sign is applied only to the integer part.)
+ * [ret] > 0 : success
+ *       ==0 : error (failure to parse)                             */
+TIMEIO_FUNC int parse_unixtime(char* pszTime, struct timespec *ptsTime) {
+
+  /*--- Variables --------------------------------------------------*/
+  unsigned long long ullSec;
+  int                iSign;
+  int                i;
+  long               lNsec;
+  char              *psz;
+
+  /*--- Read the sign ----------------------------------------------*/
+  iSign = 1;
+  switch (*pszTime) {
+    case '-': iSign=-1; pszTime++; break;
+    case '+':           pszTime++; break;
+  }
+
+  /*--- Find the end of the integer part ---------------------------*/
+  for (i=0; IS_DIGIT(pszTime[i]); i++) {
+    if (i<19) {continue;}
+    warning("The integer part of the timestamp is too big "
+            "as a UNIX-time\n");
+    return 0;
+  }
+  switch (pszTime[i]) {
+    case '.' : psz = pszTime+i+1+read_decimals(pszTime+i+1, &lNsec);
+               break;
+    case 0   :
+    case ' ' :
+    case '\t': psz = pszTime+i; lNsec = 0;
+               break;
+    default  : if (giVerbose>0) {
+                 warning("%c: Unexpected chr. in the integer part\n",
+                         pszTime[i]                                  );
+               }
+               return 0;
+  }
+  if (*psz!=0 && *psz!=' ' && *psz!='\t') {
+    if (giVerbose>0) {
+      warning("%c: Unexpected chr. in the decimal part\n",*psz);
+    }
+    return 0;
+  }
+
+  /*--- Pack the time into the timespec structure ------------------*/
+  ullSec = conv_digits(pszTime, i);
+  if (ullSec > 9223372036854775807ULL) {ullSec = 9223372036854775807ULL;}
+  if (sizeof(time_t)<8 && ullSec>2147483647ULL) {ullSec = 2147483647ULL;}
+  ptsTime->tv_sec  = (time_t)((long long)ullSec * iSign);
+  ptsTime->tv_nsec = lNsec;
+
+  return 1;
+}
+
+/*=== Parse an extended ISO 8601 time ================================
+ * [in]  pszTime : ISO 8601 (ext.) string in the localtime
+   (/[0-9]{1,10}-[0-9]{2}-[0-9]{2}T[0-9]{2}:[0-9]{2}:[0-9]{2}([,.][0-9]{1,9})?([+-][0-9]{2}:?[0-9]{2}|Z)?/)
+ *       ptsTime : To be set the parsed time ("timespec" structure)
+ * [ret] > 0 : success
+ *       ==0 : error (failure to parse)                             */
+TIMEIO_FUNC int parse_iso8601time(char* pszTime,
+                                  struct timespec *ptsTime) {
+
+  /*--- Variables --------------------------------------------------*/
+  int       iY;          /* length of the year                      */
+  int       iMon, iDay, iHour, iMin, iSec;
+  int       iTZoffs;     /* Offset of the timezone in the string    */
+  int       iHasTZ;      /* 1 if the string has the timezone part   */
+  int       i, j;
+  long      lNsec;
+  long long llSec;
+  char     *psz;
+
+  /*--- Read the string (integer part) -----------------------------*/
+  for (iY=0; iY<10 && IS_DIGIT(pszTime[iY]); iY++);
+  psz = pszTime+iY;
+  for (i=0; gszIsoPat[i]; i++) {
+    if ((gszIsoPat[i]=='0') ? IS_DIGIT(psz[i]) : (psz[i]==gszIsoPat[i])) {
+      continue;
+    }
+    if (giVerbose>0) {warning("%s: Invalid ISO 8601 string\n",pszTime);}
+    return 0;
+  }
+  if (iY==0) {
+    if (giVerbose>0) {warning("%s: Invalid ISO 8601 string\n",pszTime);}
+    return 0;
+  }
+  iMon  = conv_2digits(psz+ 1);
+  iDay  = conv_2digits(psz+ 4);
+  iHour = conv_2digits(psz+ 7);
+  iMin  = conv_2digits(psz+10);
+  iSec  = conv_2digits(psz+13);
+  psz += 15;
+
+  /*--- Read the string (decimal part) -----------------------------*/
+  lNsec = 0;
+  if (*psz==',' || *psz=='.') {psz++; psz+=read_decimals(psz, &lNsec);}
+
+  /*--- Read the string (timezone part) ----------------------------*/
+  iHasTZ  = 0;
+  iTZoffs = 0;
+  switch (*psz) {
+    case 'Z' : iHasTZ = 1; psz++;
+               break;
+    case '+' :
+    case '-' : j = (*psz=='+') ? 1 : -1; psz++;
+               if ((i=conv_2digits(psz))<0) {psz=NULL; break;}
+               iTZoffs = i*3600; psz+=2;
+               if (*psz==':') {psz++;}
+               if ((i=conv_2digits(psz))<0) {psz=NULL; break;}
+               iTZoffs = (iTZoffs+i*60)*j; psz+=2;
+               iHasTZ  = 1;
+               break;
+  }
+  if (psz==NULL || (*psz!=0 && *psz!=' ' && *psz!='\t')) {
+    if (giVerbose>0) {
+      warning("%s: Invalid ISO 8601 string (decimal or timezone part)\n",
+              pszTime                                                     );
+    }
+    return 0;
+  }
+  if (! is_valid_calendar(iMon, iDay, iHour, iMin, iSec)) {
+    if (giVerbose>1) {warning("%s: Invalid ISO 8601 string\n", pszTime);}
+    return 0;
+  }
+
+  /*--- Pack the time into the timespec structure ------------------*/
+  if (iHasTZ) {
+    llSec = days_since_epoch((long long)conv_digits(pszTime,iY),iMon,iDay)
+            *86400 + iHour*3600 + iMin*60 + iSec - iTZoffs;
+    ptsTime->tv_sec = (time_t)llSec;
+  } else if (! localcal_to_unixtime((long long)conv_digits(pszTime,iY),
+                                    iMon, iDay, iHour, iMin, iSec,
+                                    &ptsTime->tv_sec               )  ) {
+    if (giVerbose>1) {warning("%s: Invalid ISO 8601 string\n", pszTime);}
+    return 0;
+  }
+  ptsTime->tv_nsec = lNsec;
+
+  return 1;
+}
+
+
+
+/*####################################################################
+# Functions (Formatters)
+####################################################################*/
+
+/*=== Write a local calendar time ====================================
+ * [in]  pszBuf : Buffer to write the string (MUST be 48 bytes or more)
+ *       tSec   : UNIX-time to be written
+ *       pszDec : String to be attached after the seconds (such as
+ *                ".123"), or NULL
+ * [ret] >=0 : The length of the string ("YYYYMMDDhhmmss[.n]")
+ *       < 0 : error (localtime() failed)                           */
+TIMEIO_FUNC int sprint_calendartime(char *pszBuf, time_t tSec,
+                                    const char *pszDec       ) {
+
+  struct tm *ptm;
+  char      *psz;
+
+  if ((ptm=localtime_cached(tSec)) == NULL) {return -1;}
+  if (ptm->tm_year<-1900 || ptm->tm_year>8099) {
+    psz = pszBuf + snprintf(pszBuf, 21, "%04d", ptm->tm_year+1900);
+  } else {
+    psz = put_2digits(pszBuf, (ptm->tm_year+1900)/100);
+    psz = put_2digits(psz   , (ptm->tm_year+1900)%100);
+  }
+  psz = put_2digits(psz, ptm->tm_mon+1);
+  psz = put_2digits(psz, ptm->tm_mday );
+  psz = put_2digits(psz, ptm->tm_hour );
+  psz = put_2digits(psz, ptm->tm_min  );
+  psz = put_2digits(psz, ptm->tm_sec  );
+  if (pszDec) {while (*pszDec) {*psz++ = *pszDec++;}}
+  *psz = 0;
+  return (int)(psz-pszBuf);
+}
+
+/*=== Write a local extended ISO 8601 time ===========================
+ * [in]  pszBuf : Buffer to write the string (MUST be 48 bytes or more)
+ *       tSec   : UNIX-time to be written
+ *       pszDec : String to be attached after the seconds (such as
+ *                ",123"), or NULL
+ * [ret] >=0 : The length of the string
+ *             ("YYYY-MM-DDThh:mm:ss[,n]{+|-}hh:mm")
+ *       < 0 : error (localtime() failed)                           */
+TIMEIO_FUNC int sprint_iso8601time(char *pszBuf, time_t tSec,
+                                   const char *pszDec       ) {
+
+  struct tm *ptm;
+  char      *psz;
+  char      *pszTmz;
+
+  if ((ptm=localtime_cached(tSec)) == NULL) {return -1;}
+  if (ptm->tm_year<-1900 || ptm->tm_year>8099) {
+    psz = pszBuf + snprintf(pszBuf, 21, "%04d", ptm->tm_year+1900);
+  } else {
+    psz = put_2digits(pszBuf, (ptm->tm_year+1900)/100);
+    psz = put_2digits(psz   , (ptm->tm_year+1900)%100);
+  }
+  *psz++ = '-'; psz = put_2digits(psz, ptm->tm_mon+1);
+  *psz++ = '-'; psz = put_2digits(psz, ptm->tm_mday );
+  *psz++ = 'T'; psz = put_2digits(psz, ptm->tm_hour );
+  *psz++ = ':'; psz = put_2digits(psz, ptm->tm_min  );
+  *psz++ = ':'; psz = put_2digits(psz, ptm->tm_sec  );
+  if (pszDec) {while (*pszDec) {*psz++ = *pszDec++;}}
+  for (pszTmz=gstLtcache.szTmz; *pszTmz; ) {*psz++ = *pszTmz++;}
+  *psz = 0;
+  return (int)(psz-pszBuf);
+}
+
+#endif
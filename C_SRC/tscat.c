@@ -2,7 +2,7 @@
 #
 # TSCAT - A "cat" Command Which Can Reprodude the Timing of Flow
 #
-# USAGE   : tscat [-c|-e|-I|-z] [-Z] [-1kuy] [-p n] [file [...]]
+# USAGE   : tscat [-c|-e|-I|-z] [-Z] [-1kuy] [-p n] [-L] [-C cpu] [file [...]]
 # Args    : file ........ Filepath to be send ("-" means STDIN)
 #                         The file MUST be a textfile and MUST have
 #                         a timestamp at the first field to make the
@@ -64,13 +64,32 @@
 #                          3: Strongest realtime process of this host
 #                         Larger numbers maybe require a privileged user,
 #                         but if failed, it will try the smaller numbers.
+#           -L .......... Lock the memory of this command into the RAM
+#                         after pre-faulting the stack, so that no page
+#                         fault delays it in the realtime mode. A large
+#                         enough "ulimit -l" or a privileged user might
+#                         be required.
+#           -C cpu ...... Run this command only on the CPU #cpu (from 0)
+#                         to avoid the migration between CPUs. (for only
+#                         Linux) An isolated CPU gives the best result.
+# Note    : The relative modes ("-z" and "-Z") are anchored on the
+#           monotonic clock. Every deadline is computed on that clock
+#           from the zero-point and waited by an absolute sleep. So, the
+#           spacing of the lines stays exact even if the system clock
+#           is stepped by NTP etc. in the middle of a long replay. Only
+#           the absolute modes ("-c", "-e", "-I" without "-Z") follow
+#           the system clock.
 # Return  : Return 0 only when finished successfully
 #
-# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -DCLOCK_NANOSLEEP_SUPPORT
+#                  (if it doesn't work)
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt -DCLOCK_NANOSLEEP_SUPPORT
 #                  (if it doesn't work)
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#                  (if it doesn't work)
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-04-15
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -92,8 +111,7 @@
 
 /*--- headers ------------------------------------------------------*/
 #if defined(__linux) || defined(__linux__)
-  /* This definition is for strptime() on Linux */
-  #define _XOPEN_SOURCE 700
+  #define _GNU_SOURCE /* for sched_setaffinity() */
 #endif
 #include <errno.h>
 #include <stdio.h>
@@ -110,6 +128,8 @@
   #include <sched.h>
   #include <sys/resource.h>
 #endif
+#include "timeio.h"
+#include "rtmem.h"
 
 /*--- macro constants ----------------------------------------------*/
 /* Some OSes, such as HP-UX, may not know the following macros whenever
@@ -120,6 +140,9 @@
 #ifndef LLONG_MAX
   #define LLONG_MAX 9223372036854775807
 #endif
+#ifndef CLOCK_MONOTONIC
+  #define CLOCK_MONOTONIC CLOCK_REALTIME /* for HP-UX */
+#endif
 /* Buffer size for the read_and_write_a_line() */
 #define LINE_BUF 1024
 
@@ -131,9 +154,6 @@ void get_time_data_arrived(int iFd, tmsp *ptsTime);
 int  read_1st_field_as_a_timestamp(FILE *fp, char *pszTime);
 int  read_and_write_a_line(FILE *fp);
 int  skip_over_a_line(FILE *fp);
-int  parse_calendartime(char* pszTime, tmsp *ptsTime);
-int  parse_unixtime(char* pszTime, tmsp *ptsTime);
-int  parse_iso8601time(char* pszTime, tmsp *ptsTime);
 void spend_my_spare_time(tmsp *ptsTo, tmsp *ptsOffset);
 int  change_to_rtprocess(int iPrio);
 
@@ -141,8 +161,11 @@ int  change_to_rtprocess(int iPrio);
 char* gpszCmdname;  /* The name of this command                    */
 int   giTypingmode; /* Typing mode by option -y is on if >0        */
 int   giVerbose;    /* speaks more verbosely by the greater number */
-int   giTZoffs;     /* Offset in second in the local timezone      */
-tmsp  gtsZero;      /* The zero-point time                         */
+tmsp  gtsZero;      /* The zero-point time (CLOCK_MONOTONIC)       */
+char  gcStdiobuf[3][BUFSIZ]; /* Buffers for the stdio streams (for
+                      * stdin, the other input files and stdout).
+                      * They are static to be pre-faulted/locked
+                      * by -L.                                     */
 
 /*=== Define the functions for printing usage and error ============*/
 
@@ -150,7 +173,7 @@ tmsp  gtsZero;      /* The zero-point time                         */
 void print_usage_and_exit(void) {
   fprintf(stderr,
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
-    "USAGE   : %s [-c|-e|-I|-z] [-Z] [-1kuy] [-p n] [file [...]]\n"
+    "USAGE   : %s [-c|-e|-I|-z] [-Z] [-1kuy] [-p n] [-L] [-C cpu] [file [...]]\n"
 #else
     "USAGE   : %s [-c|-e|-I|-z] [-Z] [-1kuy] [file [...]]\n"
 #endif
@@ -217,8 +240,23 @@ void print_usage_and_exit(void) {
     "                         3: Strongest realtime process of this host\n"
     "                        Larger numbers maybe require a privileged user,\n"
     "                        but if failed, it will try the smaller numbers.\n"
+    "          -L .......... Lock the memory of this command into the RAM\n"
+    "                        after pre-faulting the stack, so that no page\n"
+    "                        fault delays it in the realtime mode. A large\n"
+    "                        enough \"ulimit -l\" or a privileged user might\n"
+    "                        be required.\n"
+    "          -C cpu ...... Run this command only on the CPU #cpu (from 0)\n"
+    "                        to avoid the migration between CPUs. (for only\n"
+    "                        Linux) An isolated CPU gives the best result.\n"
 #endif
-    "Version : 2025-04-15 14:54:42 JST\n"
+    "Note    : The relative modes (\"-z\" and \"-Z\") are anchored on the\n"
+    "          monotonic clock. Every deadline is computed on that clock\n"
+    "          from the zero-point and waited by an absolute sleep. So, the\n"
+    "          spacing of the lines stays exact even if the system clock\n"
+    "          is stepped by NTP etc. in the middle of a long replay. Only\n"
+    "          the absolute modes (\"-c\", \"-e\", \"-I\" without \"-Z\") follow\n"
+    "          the system clock.\n"
+    "Version : 2026-10-18 23:19:07 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -264,6 +302,8 @@ int   iMode;         /* 0:"-c",  1:"-e",  2:"-z",  3:"-I",
 int   iOpt_1;        /* -1 option flag (default 0)                  */
 int   iKeepTs;       /* -k option flag (0>:Keep timestamps, =0:Drop)*/
 int   iPrio;         /* -p option number (default 1)                */
+int   iCpu;          /* -C option number (-1:not pinned)            */
+int   iMlock;        /* 1 if -L option is given                     */
 int   iRet;          /* return code                                 */
 int   iGotOffset;    /* 0:NotYet 1:GetZeroPoint 2:Done              */
 char  szTime[43];    /* Buffer for the 1st field of lines           */
@@ -277,7 +317,7 @@ FILE *fp;            /* file handle                                 */
 int   i;             /* all-purpose int                             */
 
 /*--- Initialize ---------------------------------------------------*/
-if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+if (clock_gettime(CLOCK_MONOTONIC,&gtsZero) != 0) {
   error_exit(errno,"clock_gettime() at initialize: %s\n",strerror(errno));
 }
 gpszCmdname = argv[0];
@@ -297,9 +337,11 @@ iOpt_1       = 0; /* 0:Normal 1:Output one character/line at first         */
 iKeepTs      = 0; /* 0>:Keep timestamps, =0:Drop(default) */
 giTypingmode = 0;
 iPrio        = 1;
+iCpu         =-1;
+iMlock       = 0;
 giVerbose    = 0;
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "ceIp:1kuyvhZz")) != -1) {
+while ((i=getopt(argc, argv, "ceIp:LC:1kuyvhZz")) != -1) {
   switch (i) {
     case 'c': iMode&=4; iMode+=0;           break;
     case 'e': iMode&=4; iMode+=1;           break;
@@ -313,6 +355,10 @@ while ((i=getopt(argc, argv, "ceIp:1kuyvhZz")) != -1) {
     #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
       case 'p': if (sscanf(optarg,"%d",&iPrio) != 1) {print_usage_and_exit();}
                                               break;
+      case 'L': iMlock=1;                     break;
+      case 'C': if (sscanf(optarg,"%d",&iCpu) != 1) {print_usage_and_exit();}
+                if (iCpu < 0                       ) {print_usage_and_exit();}
+                                              break;
     #endif
     case 'v': giVerbose++;                  break;
     case 'h': print_usage_and_exit();
@@ -324,19 +370,18 @@ argv += optind  ;
 if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
 
 /*=== Switch buffer mode ===========================================*/
-if (setvbuf(stdout,NULL,(giTypingmode>0)?_IONBF:_IOLBF,0)!=0) {
+if (setvbuf(stdout,gcStdiobuf[2],(giTypingmode>0)?_IONBF:_IOLBF,BUFSIZ)!=0) {
   error_exit(255,"Failed to switch to line-buffered mode\n");
 }
+if (setvbuf(stdin ,gcStdiobuf[0],_IOFBF,BUFSIZ)!=0) {
+  error_exit(255,"Failed to give stdin the buffer\n");
+}
 
 /*=== Try to make me a realtime process ============================*/
 if (change_to_rtprocess(iPrio)==-1) {print_usage_and_exit();}
-
-/*=== Calculate the timezone offset if the -I option is enabled ====*/
-if (iMode%4==3) {
-  /* "giTZoffset" means "localtime - UTCtime" */
-  giTZoffs = (int)difftime(mktime(localtime((time_t[]){0})),
-                           mktime(   gmtime((time_t[]){0})) );
-}
+if (iCpu >= 0) {rtmem_pin_cpu(iCpu);}
+if (iMlock   ) {rtmem_prefault(gcStdiobuf,sizeof(gcStdiobuf));
+                rtmem_lock();                                  }
 
 /*=== Output the starter charater/line when -1 is enabled ==========*/
 if (iOpt_1 && putchar('\n')==EOF) {
@@ -369,6 +414,9 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
     if (feof(stdin)) {clearerr(stdin);} /* Reset EOF condition when stdin */
   } else                   {
     fp = fdopen(iFd, "r");
+    if (setvbuf(fp,gcStdiobuf[1],_IOFBF,BUFSIZ)!=0) {
+      error_exit(255,"%s: Failed to give the buffer\n",pszFilename);
+    }
   }
 
   /*--- Reading and writing loop -----------------------------------*/
@@ -537,7 +585,7 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
                             tsOffset.tv_nsec = gtsZero.tv_nsec;
                             iGotOffset=2;
                           } else if (tsTime.tv_sec < 0) {
-                            if (clock_gettime(CLOCK_REALTIME,&tsOffset) != 0) {
+                            if (clock_gettime(CLOCK_MONOTONIC,&tsOffset)!= 0) {
                               error_exit(errno,"clock_gettime() at %d: %s\n",
                                          __LINE__,strerror(errno)            );
                             }
@@ -776,7 +824,7 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
                           } else if (iGotOffset   ==2 &&
                                      iMode        ==6 &&
                                      tsTime.tv_sec< 0   ) {
-                            if (clock_gettime(CLOCK_REALTIME,&tsOffset) != 0) {
+                            if (clock_gettime(CLOCK_MONOTONIC,&tsOffset)!= 0) {
                               error_exit(errno,"clock_gettime() at %d: %s\n",
                                          __LINE__,strerror(errno)            );
                             }
@@ -943,8 +991,8 @@ void get_time_data_arrived(int iFd, tmsp *ptsTime) {
                strerror(errno));
   }
 
-  /*--- Set the time -----------------------------------------------*/
-  if (clock_gettime(CLOCK_REALTIME,ptsTime) != 0) {
+  /*--- Set the time (on the monotonic clock) ----------------------*/
+  if (clock_gettime(CLOCK_MONOTONIC,ptsTime) != 0) {
     error_exit(errno,"clock_gettime() in get_time_data_arrived(): %s\n",
                strerror(errno));
   }
@@ -1123,318 +1171,23 @@ int skip_over_a_line(FILE *fp) {
   }
 }
 
-/*=== Parse a local calendar time ====================================
- * [in]  pszTime : calendar-time string in the localtime
- *                 (/[0-9]{11,20}(\.[0-9]{1,9})?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_calendartime(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szDate[21], szNsec[10], szDate2[26];
-  int  i, j, k;            /* +-- 0:(reading integer part)          */
-  char c;                  /* +-- 1:finish reading without_decimals */
-  int  iStatus = 0; /* <--------- 2:to_be_started reading decimals  */
-  struct tm tmDate;
-
-  /*--- Separate pszTime into date and nanoseconds -----------------*/
-  for (i=0; i<20; i++) {
-    c = pszTime[i];
-    if      ('0'<=c && c<='9'         ) {szDate[i]=c;                       }
-    else if (c=='.'                   ) {szDate[i]=0; iStatus=2; i++; break;}
-    else if (c==0 || c=='\t' || c==' ') {szDate[i]=0; iStatus=1;      break;}
-    else                           {if (giVerbose>0) {
-                                      warning("%c: Unexpected chr. in "
-                                              "the integer part\n",c);
-                                    }
-                                    return 0;
-                                   }
-  }
-  if ((iStatus==0) && (i==20)) {
-    switch (pszTime[20]) {
-      case '.': szDate[20]=0; iStatus=2; i++; break;
-      case  0 : szDate[20]=0; iStatus=1;      break;
-      default : warning("The integer part of the timestamp is too big "
-                        "as a calendar-time\n",c);
-                return 0;
-    }
-  }
-  switch (iStatus) {
-    case 1 : strcpy(szNsec,"000000000");
-             break;
-    case 2 : j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      ('0'<=c && c<='9'         ) {szNsec[k]=c; k++;}
-               else if (c==0 || c=='\t' || c==' ') {break;           }
-               else                           {
-                 if (giVerbose>0) {
-                   warning("%c: Unexpected chr. in the decimal part\n",c);
-                 }
-                 return 0;
-               }
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    default: warning("Unexpected error in parse_calendartime(), "
-                     "maybe a bug?\n");
-             return 0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  i = strlen(szDate)-10;
-  if (i<=0) {return 0;}
-  k =0; for (j=0; j<i; j++) {szDate2[k]=szDate[j];k++;} /* Y */
-  szDate2[k]='-'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* m */
-  szDate2[k]='-'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* d */
-  szDate2[k]='T'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* H */
-  szDate2[k]=':'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* M */
-  szDate2[k]=':'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* S */
-  szDate2[k]=  0;
-  memset(&tmDate, 0, sizeof(tmDate));
-  if(! strptime(szDate2, "%Y-%m-%dT%H:%M:%S", &tmDate)) {
-    if (giVerbose>1) {
-      warning("Unexpect error at strptime() in parse_calendartime()\n");
-    }
-    return 0;
-  }
-  errno=0;
-  ptsTime->tv_sec  = mktime(&tmDate);
-  if (errno) {
-    if (giVerbose>1) {
-      warning("%s: Invalid calendartime string: %s\n", pszTime,strerror(errno));
-    }
-    return 0;
-  }
-  ptsTime->tv_nsec = atol(szNsec);
-
-  return 1;
-}
-
-/*=== Parse a UNIX-time ==============================================
- * [in]  pszTime : UNIX-time string (/[0-9]{1,19}(\.[0-9]{1,9})?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_unixtime(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szSec[21], szNsec[10];
-  int  i, j, k;            /* +-- 0:(reading integer part)          */
-  char c;                  /* +-- 1:finish reading without_decimals */
-  int  iStatus = 0; /* <--------- 2:to_be_started reading decimals  */
-
-  /*--- Separate pszTime into seconds and nanoseconds --------------*/
-  i=0; j=19;
-  if (pszTime[i]=='+'||pszTime[i]=='-') {szSec[i]=pszTime[i];i++;j++;}
-  for (   ; i<j; i++) {
-    c = pszTime[i];
-    if      ('0'<=c && c<='9'         ) {szSec[i]=c;                       }
-    else if (c=='.'                   ) {szSec[i]=0; iStatus=2; i++; break;}
-    else if (c==0 || c=='\t' || c==' ') {szSec[i]=0; iStatus=1;      break;}
-    else                           {if (giVerbose>0) {
-                                      warning("%c: Unexpected chr. in "
-                                              "the integer part\n",c);
-                                    }
-                                    return 0;
-                                   }
-  }
-  if ((iStatus==0) && (i==j)) {
-    switch (pszTime[j]) {
-      case '.': szSec[j]=0; iStatus=2; i++; break;
-      case  0 : szSec[j]=0; iStatus=1;      break;
-      default : warning("The integer part of the timestamp is too big "
-                        "as a UNIX-time\n");
-                return 0;
-    }
-  }
-  switch (iStatus) {
-    case 1 : strcpy(szNsec,"000000000");
-             break;
-    case 2 : j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      ('0'<=c && c<='9'         ) {szNsec[k]=c; k++;}
-               else if (c==0 || c=='\t' || c==' ') {break;           }
-               else                           {
-                 if (giVerbose>0) {
-                   warning("%c: Unexpected chr. in the decimal part\n",c);
-                 }
-                 return 0;
-               }
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    default: warning("Unexpected error in parse_unixtime(), maybe a bug?\n");
-             return 0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  ptsTime->tv_sec  = (time_t)atoll(szSec);
-  ptsTime->tv_nsec =         atol(szNsec);
-
-  return 1;
-}
-
-/*=== Parse an extended ISO 8601 time ================================
- * [in]  pszTime : ISO 8601 (ext.) string in the localtime
-   (/[0-9]{1,10}-[0-9]{2}-[0-9]{2}T[0-9]{2}:[0-9]{2}:[0-9]{2}([,.][0-9]{1,9})?([+-][0-9]{2}:?[0-9]{2}|Z)?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_iso8601time(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szDate[26], szNsec[10];
-  int  iTZoffs;            /* +-- 0:now reading integer part or invalid string*/
-  int  i, j, k;            /* +-- 1:to_be_started reading decimals  */
-  char c;                  /* +-- 2:to_be_started reading timezone  */
-  int  iStatus = 0; /* <--------- 3:finished reading                */
-  struct tm tmDate;
-
-  /*--- Read the string (integer part) -----------------------------*/
-  iStatus=0;
-  while (1) {
-    i=0;
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* Y     */
-    while ('0'<=pszTime[i] && pszTime[i]<='9' && i<10 ) {i++;} /* Y{,9} */
-    if (pszTime[i] != '-'               ) {break;} else {i++;} /* -     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* M     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* M     */
-    if (pszTime[i] != '-'               ) {break;} else {i++;} /* -     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* D     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* D     */
-    if (pszTime[i] != 'T'               ) {break;} else {i++;} /* T     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* h     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* h     */
-    if (pszTime[i] != ':'               ) {break;} else {i++;} /* :     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* m     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* m     */
-    if (pszTime[i] != ':'               ) {break;} else {i++;} /* :     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* s     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* s     */
-    switch (pszTime[i]) {
-      case ',' :
-      case '.' : iStatus = 1; break;
-      case 'Z' :
-      case '+' :
-      case '-' : iStatus = 2; break;
-      case 0   :
-      case ' ' :
-      case '\t': iStatus = 3; break;
-      default  : break;
-    }
-    break;
-  }
-  if (iStatus==0) {
-    if (giVerbose>0) {warning("%s: Invalid ISO 8601 string\n",pszTime);}
-    return 0;
-  }
-  memcpy(szDate, pszTime, i); szDate[i]=0;
-
-  /*--- Read the string (decimal part) -----------------------------*/
-  switch (iStatus) {
-    case 1 : i++;
-             j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      ('0'<=c  && c<='9'          ) {szNsec[k]=c; k++;}
-               else if (c=='+'  || c=='-' || c=='Z') {iStatus=2; break;}
-               else if (c=='\t' || c==' ' || c==0  ) {iStatus=3; break;}
-               else                                  {
-                 if (giVerbose>0) {
-                   warning("%s: Invalid ISO 8601 string (decimal part)\n",
-                           pszTime                                        );
-                 }
-                 return 0;
-               }
-             }
-             if (i==j) {
-               c = pszTime[i];
-               if (c=='+'  || c=='-'        ) {iStatus=2; break;}
-               if (c=='\t' || c==' ' || c==0) {iStatus=3; break;}
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    case 2 :
-    case 3 : strcpy(szNsec,"000000000");
-             break;
-  }
-
-  /*--- Read the string (timezone part) ----------------------------*/
-  if (iStatus==2) {
-    k=0;
-    while (k==0) {
-      iTZoffs  = 0;
-      if (pszTime[i]=='Z') {j=1; k=1; break;}                    /* Z    */
-      j = (pszTime[i]=='+') ? 1 : -1; i++;                       /* [+-] */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')*36000; i++;                    /* h    */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')* 3600; i++;                    /* h    */
-      if (pszTime[i]==':'                 ) {i++;  }             /* :    */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')*  600; i++;                    /* m    */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')*   60; i++;                    /* m    */
-      if (pszTime[i]!=' ' && pszTime[i]!='\t' && pszTime[i]!=0) {break;}
-      iTZoffs *= j;
-      k=1;
-    }
-    if (k==0) {
-      if (iStatus==0) {
-        warning("%s: Invalid ISO 8601 string (timezone part)\n",
-                pszTime                                         );
-        return 0;
-      }
-    }
-  } else          {
-    j=0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  if (! strptime(szDate, "%Y-%m-%dT%H:%M:%S", &tmDate)) {
-    if (giVerbose>1) {
-      warning("Unexpect error at strptime() #1 in parse_iso8601time()\n");
-    }
-    return 0;
-  }
-  errno=0;
-  ptsTime->tv_sec  = mktime(&tmDate);
-  if (errno) {
-    if (giVerbose>1) {
-      warning("%s: Invalid ISO 8601 string: %s\n", pszTime, strerror(errno));
-    }
-    return 0;
-  }
-  ptsTime->tv_nsec = atol(szNsec);
-  if (j!=0) {ptsTime->tv_sec = ptsTime->tv_sec + giTZoffs - iTZoffs;}
-
-  return 1;
-}
-
 /*=== Sleep until the next interval period ===========================
+ * The time is on CLOCK_MONOTONIC when ptsOffset is given (the offset
+ * is made from a zero-point on that clock), or CLOCK_REALTIME when not.
  * [in] ptsTo     : Time until which this function wait
                     (given from the 1st field of a line, which not adjusted yet)
         ptsOffset : Offset for ptsTo (set NULL if unnecessary)      */
 void spend_my_spare_time(tmsp *ptsTo, tmsp *ptsOffset) {
 
   /*--- Variables --------------------------------------------------*/
-  tmsp tsTo  ;
-  tmsp tsDiff;
-  tmsp tsNow ;
+  clockid_t cid  ;
+  tmsp      tsTo ;
+#ifdef CLOCK_NANOSLEEP_SUPPORT
+  int       iRet ;
+#else
+  tmsp      tsDiff;
+  tmsp      tsNow ;
+#endif
 
   /*--- Calculate how long I wait ----------------------------------*/
   if (! ptsOffset) {
@@ -1451,8 +1204,19 @@ void spend_my_spare_time(tmsp *ptsTo, tmsp *ptsOffset) {
       tsTo.tv_sec   = ptsTo->tv_sec + ptsOffset->tv_sec;
     }
   }
+  cid = (ptsOffset) ? CLOCK_MONOTONIC : CLOCK_REALTIME;
+
+#ifdef CLOCK_NANOSLEEP_SUPPORT
+  /*--- Sleeping until tsTo ----------------------------------------*/
+  if (tsTo.tv_sec < 0) {return;} /* far past, it doesn't matter */
+  while ((iRet=clock_nanosleep(cid,TIMER_ABSTIME,&tsTo,NULL)) != 0) {
+    if (iRet == EINTR) {continue;}
+    error_exit(iRet,"clock_nanosleep() in spend_my_spare_time(): %s\n",
+               strerror(iRet));
+  }
+#else
   /* tsNow = (current_time) */
-  if (clock_gettime(CLOCK_REALTIME,&tsNow) != 0) {
+  if (clock_gettime(cid,&tsNow) != 0) {
     error_exit(errno,"clock_gettime() in spend_my_spare_time(): %s\n",
                strerror(errno));
   }
@@ -1474,6 +1238,7 @@ void spend_my_spare_time(tmsp *ptsTo, tmsp *ptsOffset) {
     error_exit(errno,"nanosleep() in spend_my_spare_time(): %s\n",
                strerror(errno));
   }
+#endif
 }
 
 /*=== Try to make me a realtime process ==============================
@@ -0,0 +1,962 @@
+/*####################################################################
+#
+# TSHEAD - A "head" Command Which Considers Timestamp Instead of
+#          the Number of Lines
+#
+# USAGE   : (a) tshead [options]     -i  interval      [file ...]
+#           (b) tshead [options] -x  -i  interval      [file ...]
+#           (c) tshead [options]     -i -interval      [file ...]
+#           (d) tshead [options] -x  -i -interval      [file ...]
+#           (e) tshead [options]     -t  date-and-time [file ...]
+#           (f) tshead [options] -x  -t  date-and-time [file ...]
+#
+#           The lines that can pass through this command will be chosen
+#           by making sure the timestamp at the first field of each line
+#           is in one of the following ranges.
+#             (a) [ <top>, <command start time>+<interval> ]
+#             (b) [ <top>, <command start time>+<interval> )
+#             (c) [ <top>, <last line's time>  -<interval> ]
+#             (d) [ <top>, <last line's time>  -<interval> )
+#             (e) [ <top>, <date-and-time>                 ]
+#             (f) [ <top>, <date-and-time>                 )
+#           This command stops reading the file at the first line which
+#           is out of the range because the lines are supposed to be in
+#           time order.
+#
+# Args    : file ........ Filepath to be send ("-" means STDIN)
+#                         The file MUST be a textfile and MUST have
+#                         a timestamp at the first field of each line,
+#                         and the lines MUST be in time order. The first
+#                         space character <0x20> of every line will be
+#                         regarded as the field delimiter.
+#                         * The lines are sent to the stdout as they are,
+#                           with their timestamps.
+#                         * A line whose first field is not a valid time-
+#                           stamp is regarded as a continuation of the
+#                           previous line (e.g. a stack trace in a log).
+#                           So, it passes through when the previous line
+#                           does.
+#                         * When the file is a regular file, this command
+#                           does not read the whole file but finds the
+#                           end of the range by binary search on the
+#                           memory-mapped file, and sends the lines in
+#                           the range at once. So, it takes almost no
+#                           time even for a huge file.
+#                         * When the file is a pipe or a terminal in the
+#                           pattern (a) and (b), this command exits as
+#                           soon as the interval ends even if no line
+#                           comes. A line which has not been completed
+#                           by then will not be sent.
+# Options : -c,-e,-I,-z . Specify the format for timestamp and -t option
+#                         parameter. You can choose one of the following.
+#                           -c ... "YYYYMMDDhhmmss[.n]" (default)
+#                                  Calendar time (standard time) in your
+#                                  timezone (".n" is the digits under
+#                                  second. You can specify up to nano
+#                                  second.)
+#                           -e ... "[+|-]n[.n]"
+#                                  The number of seconds since the UNIX
+#                                  epoch (".n" is the same as -c)
+#                           -I ... "YYYY-MM-DDThh:mm:ss[,n][{{+|-}hh:mm|Z}]"
+#                                  Ext. ISO 8601 formatted time in your
+#                                  timezone (".n" is the same as -c)
+#                           -z ... "[+|-]n[.n]"
+#                                  The number of seconds since this
+#                                  command has started (".n" is the same
+#                                  as -c)
+#           -i interval . This is one of options to specify the timestamp
+#                         range. (See the pattern (a) to (d) above)
+#                         You can use the format "A[.B][u]" as the
+#                         option's parameter "interval."
+#                           "A" is the integer part of the time.
+#                           "B" is the decimal part of the time.
+#                           "u" is the unit for the time. You can choose
+#                               one of the followings.
+#                               "s", "ms", "us" and "ns."
+#           -t date-and-time
+#                         This is one of options to specify the timestamp
+#                         range. (See the pattern (e) and (f) above)
+#                         The format of "date-and-time" depends on
+#                         which of the option "-c", "-e," "-I" or "-z"
+#                         you choose.
+#                           "-c" ... "YYYYMMDDhhmmss[.n]" (cal. time)
+#                           "-e" ... "n[.n]" (UNIX time)
+#                           "-I" ... "YYYY-MM-DDThh:mm:ss[,n]" (ISO 8601)
+#                           "-z" ... "n[.n]" (the number of seconds)
+#           -q .......... Suppresses printing filenames when two or more
+#                         files are given.
+#           -u .......... Set the date in UTC when -c option is set
+#                         (same as that of date command)
+#           -x .......... An additional option for -i and -t. It will
+#                         exclude the endpoint itself from the range.
+#                         (See the pattern (b), (d) and (f) above)
+#           -Z .......... Measure the interval of the -i option from the
+#                         time of the first line of each file instead of
+#                         the command start time.
+#                         For instance, "-Z -i 5" passes through the
+#                         first five seconds of each file.
+# Retuen  : Return 0 only when finished successfully for all files
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
+#                  (if it doesn't work)
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <locale.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux) || defined(__linux__)
+  #include <sys/sendfile.h>
+  #include <sys/timerfd.h>
+#endif
+#include "timeio.h"
+
+/*--- macro constants ----------------------------------------------*/
+/* Buffer size for the option parameter */
+#define OPT_PARM_BUF 64
+/* Maximum length of the timestamp field */
+#define TS_FIELD_MAX 42
+/* Initial size of the buffer for reading a stream */
+#define READ_BUF 65536
+
+/*--- data type definitions ----------------------------------------*/
+typedef struct timespec tmsp;
+
+/*--- prototype functions ------------------------------------------*/
+int  head_mmapped_file(int iFd);
+int  head_streamed_file(int iFd);
+int  get_border(const char *pcTop, const char *pcEnd, tmsp *ptsBorder);
+const char* find_cut(const char *pcTop, const char *pcEnd,
+                     const tmsp *ptsBorder                );
+const char* next_line(const char *pc, const char *pcEnd);
+int  get_line_time(const char *pc, const char *pcEnd, tmsp *ptsTime);
+int  is_out_of_range(const tmsp *ptsTime, const tmsp *ptsBorder);
+int  open_deadline_timer(const tmsp *ptsDeadline);
+int  wait_for_input(int iFd, int iTfd, const tmsp *ptsDeadline);
+int64_t parse_periodictime(char *pszArg);
+void write_all(const char *pc, size_t siz);
+void tmsp_add(tmsp *pts, int64_t i8Nsec);
+
+/*--- global variables ---------------------------------------------*/
+char*   gpszCmdname; /* The name of this command                    */
+int     giVerbose;   /* speaks more verbosely by the greater number */
+tmsp    gtsZero;     /* The zero-point time                         */
+int     giTfmt;      /* 0:"-c"  1:"-e"  2:"-z"  3:"-I"              */
+int     giMode;      /* 1:"-i"  2:"-t"  0:(undefined)               */
+int     giEndp;      /* Including the endpoint or not (1:include)   */
+int     giL1zero;    /* Interval is based on the time 1st line comes*/
+int     giFromtop;   /* The interval is from the (1:top 0:end)      */
+int64_t gi8Interval; /* The interval by "-i" (in nanosecond)        */
+tmsp    gtsTime;     /* The date-and-time by "-t"                   */
+
+/*=== Define the functions for printing usage and error ============*/
+
+/*--- exit with usage ----------------------------------------------*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : (a) %s [options]     -i  interval      [file ...]\n"
+    "          (b) %s [options] -x  -i  interval      [file ...]\n"
+    "          (c) %s [options]     -i -interval      [file ...]\n"
+    "          (d) %s [options] -x  -i -interval      [file ...]\n"
+    "          (e) %s [options]     -t  date-and-time [file ...]\n"
+    "          (f) %s [options] -x  -t  date-and-time [file ...]\n"
+    "\n"
+    "          The lines that can pass through this command will be chosen\n"
+    "          by making sure the timestamp at the first field of each line\n"
+    "          is in one of the following ranges.\n"
+    "            (a) [ <top>, <command start time>+<interval> ]\n"
+    "            (b) [ <top>, <command start time>+<interval> )\n"
+    "            (c) [ <top>, <last line's time>  -<interval> ]\n"
+    "            (d) [ <top>, <last line's time>  -<interval> )\n"
+    "            (e) [ <top>, <date-and-time>                 ]\n"
+    "            (f) [ <top>, <date-and-time>                 )\n"
+    "          This command stops reading the file at the first line which\n"
+    "          is out of the range because the lines are supposed to be in\n"
+    "          time order.\n"
+    "\n"
+    "Args    : file ........ Filepath to be send (\"-\" means STDIN)\n"
+    "                        The file MUST be a textfile and MUST have\n"
+    "                        a timestamp at the first field of each line,\n"
+    "                        and the lines MUST be in time order. The first\n"
+    "                        space character <0x20> of every line will be\n"
+    "                        regarded as the field delimiter.\n"
+    "                        * The lines are sent to the stdout as they are,\n"
+    "                          with their timestamps.\n"
+    "                        * A line whose first field is not a valid time-\n"
+    "                          stamp is regarded as a continuation of the\n"
+    "                          previous line (e.g. a stack trace in a log).\n"
+    "                          So, it passes through when the previous line\n"
+    "                          does.\n"
+    "                        * When the file is a regular file, this command\n"
+    "                          does not read the whole file but finds the\n"
+    "                          end of the range by binary search on the\n"
+    "                          memory-mapped file, and sends the lines in\n"
+    "                          the range at once. So, it takes almost no\n"
+    "                          time even for a huge file.\n"
+    "                        * When the file is a pipe or a terminal in the\n"
+    "                          pattern (a) and (b), this command exits as\n"
+    "                          soon as the interval ends even if no line\n"
+    "                          comes. A line which has not been completed\n"
+    "                          by then will not be sent.\n"
+    "Options : -c,-e,-I,-z . Specify the format for timestamp and -t option\n"
+    "                        parameter. You can choose one of the following.\n"
+    "                          -c ... \"YYYYMMDDhhmmss[.n]\" (default)\n"
+    "                                 Calendar time (standard time) in your\n"
+    "                                 timezone (\".n\" is the digits under\n"
+    "                                 second. You can specify up to nano\n"
+    "                                 second.)\n"
+    "                          -e ... \"[+|-]n[.n]\"\n"
+    "                                 The number of seconds since the UNIX\n"
+    "                                 epoch (\".n\" is the same as -c)\n"
+    "                          -I ... \"YYYY-MM-DDThh:mm:ss[,n][{{+|-}hh:mm|Z}]"
+                                                                          "\"\n"
+    "                                 Ext. ISO 8601 formatted time in your\n"
+    "                                 timezone (\".n\" is the same as -c)\n"
+    "                          -z ... \"[+|-]n[.n]\"\n"
+    "                                 The number of seconds since this\n"
+    "                                 command has started (\".n\" is the same\n"
+    "                                 as -c)\n"
+    "          -i interval . This is one of options to specify the timestamp\n"
+    "                        range. (See the pattern (a) to (d) above)\n"
+    "                        You can use the format \"A[.B][u]\" as the\n"
+    "                        option's parameter \"interval.\"\n"
+    "                          \"A\" is the integer part of the time.\n"
+    "                          \"B\" is the decimal part of the time.\n"
+    "                          \"u\" is the unit for the time. You can choose\n"
+    "                              one of the followings.\n"
+    "                              \"s\", \"ms\", \"us\" and \"ns.\"\n"
+    "          -t date-and-time\n"
+    "                        This is one of options to specify the timestamp\n"
+    "                        range. (See the pattern (e) and (f) above)\n"
+    "                        The format of \"date-and-time\" depends on\n"
+    "                        which of the option \"-c\", \"-e,\" \"-I\" or \"-z\"\n"
+    "                        you choose.\n"
+    "                          \"-c\" ... \"YYYYMMDDhhmmss[.n]\" (cal. time)\n"
+    "                          \"-e\" ... \"n[.n]\" (UNIX time)\n"
+    "                          \"-I\" ... \"YYYY-MM-DDThh:mm:ss[,n]\" (ISO 8601)\n"
+    "                          \"-z\" ... \"n[.n]\" (the number of seconds)\n"
+    "          -q .......... Suppresses printing filenames when two or more\n"
+    "                        files are given.\n"
+    "          -u .......... Set the date in UTC when -c option is set\n"
+    "                        (same as that of date command)\n"
+    "          -x .......... An additional option for -i and -t. It will\n"
+    "                        exclude the endpoint itself from the range.\n"
+    "                        (See the pattern (b), (d) and (f) above)\n"
+    "          -Z .......... Measure the interval of the -i option from the\n"
+    "                        time of the first line of each file instead of\n"
+    "                        the command start time.\n"
+    "                        For instance, \"-Z -i 5\" passes through the\n"
+    "                        first five seconds of each file.\n"
+    "Version : 2026-10-18 22:31:27 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/tokideli\n"
+    ,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+
+/*--- print warning message ----------------------------------------*/
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr, szFormat, va);
+  va_end(va);
+  return;
+}
+
+/*--- exit with error message --------------------------------------*/
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr, szFormat, va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+/*=== Initialization ===============================================*/
+int main(int argc, char *argv[]) {
+
+/*--- Variables ----------------------------------------------------*/
+int      iPrnhdr;         /* 1:Print 2 or more filenames 0:none           */
+char     szOptbuf[OPT_PARM_BUF];
+int      iRet;            /* return code                                  */
+char    *pszPath;         /* filepath on arguments                        */
+char    *pszFilename;     /* filepath (for message)                       */
+int      iFileno;         /* file# of filepath                            */
+int      iFd;             /* file descriptor                              */
+int      i;               /* all-purpose int                              */
+
+/*--- Initialize ---------------------------------------------------*/
+if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+  error_exit(errno,"clock_gettime() at initialize: %s\n",strerror(errno));
+}
+gpszCmdname = argv[0];
+for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+  if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+}
+if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+  error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+}
+setlocale(LC_CTYPE, "");
+
+/*=== Parse arguments ==============================================*/
+
+/*--- Set default parameters of the arguments ----------------------*/
+giTfmt    = 0; /* 0:"-c"(default) 1:"-e" 2:"-z" 3:"-I" */
+giMode    = 0; /* 1:interval(-i) 2:time(-t)            */
+giL1zero  = 0; /* 0:The 0-time is based on the time the command begins
+                  1:The 0-time is based on the time 1st line comes     */
+giEndp    = 1; /* 0:Exclude the time range endpoint
+                  1:Include the time range endpoint (default)          */
+giFromtop = 1; /* 1:The interval starts from the top 0:from the end    */
+iPrnhdr   = 1; /* 1:Print 2 or more filenames 0:none                   */
+giVerbose = 0;
+
+/*--- Parse and validate options -----------------------------------*/
+if (argc<2) {print_usage_and_exit();}
+while ((i=getopt(argc, argv, "ceIhi:qt:uvxzZ")) != -1) {
+  switch (i) {
+    case 'u': (void)setenv("TZ", "UTC0", 1); break;
+    case 'c': giTfmt   = 0;                  break;
+    case 'e': giTfmt   = 1;                  break;
+    case 'z': giTfmt   = 2;                  break;
+    case 'I': giTfmt   = 3;                  break;
+    case 'Z': giL1zero = 1;                  break;
+    case 'x': giEndp   = 0;                  break;
+    case 'i': if (*optarg=='-') {giFromtop = 0; optarg++;}
+              else              {giFromtop = 1;          }
+              gi8Interval = parse_periodictime(optarg);
+              if (gi8Interval<0) {print_usage_and_exit();}
+              giMode = 1;                    break;
+    case 't': giMode = 2;
+              if (strlen(optarg)>=OPT_PARM_BUF) {
+                error_exit(1,"date-and-time for the \"-t\" is too long\n");
+              }
+              strcpy(szOptbuf, optarg);      break;
+    case 'q': iPrnhdr  = 0;                  break;
+    case 'v': giVerbose++;                   break;
+    case 'h': print_usage_and_exit();
+    default : print_usage_and_exit();
+  }
+}
+argc -= optind;
+argv += optind;
+if (argc     <2) {iPrnhdr=0;}
+if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
+switch (giMode) {
+  case  1: break;
+  case  2: switch (giTfmt) {
+             case 0 : i = parse_calendartime(szOptbuf, &gtsTime); break;
+             case 3 : i = parse_iso8601time( szOptbuf, &gtsTime); break;
+             default: i = parse_unixtime(    szOptbuf, &gtsTime); break;
+           }
+           if (! i) {
+             error_exit(1,"%s: The string for \"-t\" does not match the "
+                          "timestamp format. See usage.\n", szOptbuf     );
+           }
+           break;
+  default: error_exit(1,"Either \"-i\" or \"-t\" option is required\n");
+}
+
+/*=== Each file loop ===============================================*/
+iRet    =  0;
+iFileno =  0;
+iFd     = -1;
+while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
+
+  /*--- Open one of the input files --------------------------------*/
+  if (pszPath == NULL || strcmp(pszPath, "-") == 0) {
+    pszFilename = "stdin"                ;
+    iFd         = STDIN_FILENO           ;
+  } else                                            {
+    pszFilename = pszPath                ;
+    while ((iFd=open(pszPath, O_RDONLY)) < 0) {
+      if (errno == EINTR) {continue;}
+      iRet = 1;
+      warning("%s: %s\n", pszFilename, strerror(errno));
+      break;
+    }
+    if (iFd < 0) {iFileno++; continue;}
+  }
+
+  /*--- Print the filename if required -----------------------------*/
+  if (iPrnhdr) {
+    if (printf("%s==> %s <==\n",(iFileno>0)?"\n":"",pszFilename) < 0) {
+      error_exit(errno,"printf() in main(): %s\n",strerror(errno));
+    }
+    if (fflush(stdout) == EOF) {
+      error_exit(errno,"fflush() in main(): %s\n",strerror(errno));
+    }
+  }
+
+  /*--- Send the lines in the range --------------------------------*/
+  if (head_mmapped_file(iFd) != 0) {
+    if (head_streamed_file(iFd) != 0) {
+      warning("%s: File access error, skip it\n", pszFilename);
+      iRet = 1;
+    }
+  }
+
+  /*--- Close the input file ---------------------------------------*/
+  if (iFd != STDIN_FILENO) {close(iFd);}
+  iFileno++;
+  if (pszPath == NULL) {break;}
+}
+
+/*=== Finish normally ==============================================*/
+return(iRet);}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Send the lines in the range of a regular file by mmap() ========
+ * The end of the range is found by binary search on the mapping, and
+ * the lines in the range are sent at once, with sendfile() if it is
+ * available. So, the lines out of the range are never read.
+ * [in] iFd : File descriptor of the input file
+ * [ret] 0  : Finished sending the lines
+ *       -1 : Could not do it for the file (Nothing has been read yet.
+ *            Use head_streamed_file() instead.)                    */
+int head_mmapped_file(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stFile;  /* stat of the file                          */
+  off_t       otPos;   /* the current offset in the file            */
+  off_t       otMap;   /* the offset the mapping begins at          */
+  char*       pcMap;   /* the mapping                               */
+  size_t      sizMap;  /* size of the mapping                       */
+  const char* pcTop;   /* the top of the data to be read            */
+  const char* pcEnd;   /* the end of the mapped data                */
+  const char* pcCut;   /* the top of the first line out of the range*/
+  tmsp        tsBorder;/* the end of the range                      */
+  long        lPgsiz;  /* page size                                 */
+#if defined(__linux) || defined(__linux__)
+  off_t       otOut;   /* the offset for sendfile()                 */
+  size_t      siz;
+  ssize_t     ss;
+#endif
+
+  /*--- Is it possible? --------------------------------------------*/
+  if (fstat(iFd,&stFile)  < 0                ) {return -1;}
+  if (! S_ISREG(stFile.st_mode)              ) {return -1;}
+  if ((otPos=lseek(iFd,0,SEEK_CUR)) < 0      ) {return -1;}
+  if ((lPgsiz=sysconf(_SC_PAGESIZE)) < 1     ) {return -1;}
+  if (stFile.st_size <= otPos                ) {return  0;}
+  otMap  = otPos - otPos%lPgsiz;
+  if ((uintmax_t)(stFile.st_size-otMap) > (uintmax_t)SIZE_MAX) {return -1;}
+
+  /*--- Map the rest of the file -----------------------------------*/
+  sizMap = (size_t)(stFile.st_size-otMap);
+  pcMap  = mmap(NULL,sizMap,PROT_READ,MAP_SHARED,iFd,otMap);
+  if (pcMap == MAP_FAILED) {
+    if (giVerbose>0) {warning("mmap(): %s\n",strerror(errno));}
+    return -1;
+  }
+  posix_madvise(pcMap, sizMap, POSIX_MADV_RANDOM);
+  pcTop = pcMap + (otPos-otMap);
+  pcEnd = pcMap + sizMap;
+
+  /*--- Find the end of the range ----------------------------------*/
+  if (get_border(pcTop, pcEnd, &tsBorder)) {
+    pcCut = find_cut(pcTop, pcEnd, &tsBorder);
+  } else {
+    pcCut = pcEnd; /* no valid timestamp, so all are continuations */
+  }
+  if (giVerbose>0) {
+    warning("%lld of %lld bytes are in the range\n",
+            (long long)(pcCut-pcTop), (long long)(pcEnd-pcTop));
+  }
+
+  /*--- Send the lines in the range --------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  otOut = otPos;
+  siz   = (size_t)(pcCut-pcTop);
+  while (siz > 0) {
+    ss = sendfile(STDOUT_FILENO, iFd, &otOut, siz);
+    if (ss > 0                 ) {siz -= (size_t)ss; continue;}
+    if (ss < 0 && errno==EINTR ) {continue;}
+    if (ss < 0 && giVerbose>0  ) {warning("sendfile(): %s\n",strerror(errno));}
+    break; /* The rest is sent by write() */
+  }
+  write_all(pcCut-siz, siz);
+#else
+  write_all(pcTop, (size_t)(pcCut-pcTop));
+#endif
+
+  /*--- Finish -----------------------------------------------------*/
+  munmap(pcMap, sizMap);
+  if (lseek(iFd,otPos+(off_t)(pcCut-pcTop),SEEK_SET) < 0) {
+    error_exit(errno,"lseek() in head_mmapped_file(): %s\n",strerror(errno));
+  }
+  return 0;
+}
+
+/*=== Send the lines in the range of a stream ========================
+ * The stream is read by the chunk, and the lines in the range of each
+ * chunk are sent at once. Reading is stopped at the first line out of
+ * the range. For the pattern (c) and (d), which need the last line,
+ * the whole stream is read into the memory first. For the pattern (a)
+ * and (b) on a pipe or a terminal, reading is also stopped when the
+ * interval ends, which is watched by a timer instead of the clock at
+ * each line so that it works even while no line comes.
+ * [in] iFd : File descriptor of the input file
+ * [ret] 0  : Finished sending the lines
+ *       1  : File access error                                     */
+int head_streamed_file(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  char*       pcBuf;    /* the buffer                               */
+  size_t      sizBuf;   /* size of the buffer                       */
+  size_t      sizDat;   /* size of the data in the buffer           */
+  const char* pc;       /* the top of the current line              */
+  const char* pcNext;   /* the top of the next line                 */
+  const char* pcEnd;    /* the end of the data in the buffer        */
+  tmsp        tsBorder; /* the end of the range                     */
+  tmsp        tsTime;   /* the time of the current line             */
+  int         iBorder;  /* 1 if tsBorder has been fixed             */
+  int         iEof;     /* 1 if the stream came to EOF              */
+  int         iLive;    /* 1 if reading is stopped at the deadline  */
+  int         iTfd;     /* timer for the deadline (-1:not available)*/
+  int         iReady;   /* the result of wait_for_input()           */
+  tmsp        tsDeadline;/* the time when the interval ends         */
+  struct stat stFile;   /* stat of the file                         */
+  int         iRet;
+  ssize_t     ss;
+
+  /*--- Prepare the buffer -----------------------------------------*/
+  sizBuf = READ_BUF;
+  if ((pcBuf=(char*)malloc(sizBuf)) == NULL) {
+    error_exit(errno,"malloc() in head_streamed_file(): %s\n",strerror(errno));
+  }
+  sizDat  = 0;
+  iRet    = 0;
+  iBorder = 0;
+  if (giMode==2 || (giFromtop && !giL1zero)) {
+    get_border(NULL, NULL, &tsBorder);
+    iBorder = 1;
+  }
+
+  /*--- Prepare the deadline for the pattern (a),(b) ---------------*/
+  iLive  = 0;
+  iTfd   = -1;
+  iReady = 1;
+  if (giMode==1 && giFromtop && !giL1zero) {
+    if (fstat(iFd,&stFile)<0 || !S_ISREG(stFile.st_mode)) {
+      tsDeadline = gtsZero; tmsp_add(&tsDeadline, gi8Interval);
+      iTfd       = open_deadline_timer(&tsDeadline);
+      iLive      = 1;
+    }
+  }
+
+  /*--- Read and send the lines (loop) -----------------------------*/
+  while (1) {
+    /* 1) Wait for the next chunk until the deadline */
+    if (iLive) {
+      iReady = wait_for_input(iFd, iTfd, &tsDeadline);
+      if (iReady == 2) {
+        if (giVerbose>0) {warning("The interval has ended\n");}
+        break;
+      }
+    }
+    /* 2) Read the next chunk */
+    if (sizDat == sizBuf) {
+      if ((pcBuf=(char*)realloc(pcBuf,sizBuf*2)) == NULL) {
+        error_exit(errno,"realloc() in head_streamed_file(): %s\n",
+                   strerror(errno));
+      }
+      sizBuf *= 2;
+    }
+    ss = read(iFd, pcBuf+sizDat, sizBuf-sizDat);
+    if (ss < 0) {
+      if (errno == EINTR) {continue;}
+      if (giVerbose>0) {warning("read(): %s\n",strerror(errno));}
+      iRet = 1; break;
+    }
+    sizDat += (size_t)ss;
+    iEof    = (ss == 0);
+    /* 3) For the pattern (c) and (d), just keep reading until EOF */
+    if (! giFromtop) {
+      if (! iEof) {continue;}
+      pcEnd = pcBuf + sizDat;
+      if (get_border(pcBuf, pcEnd, &tsBorder)) {
+        pcEnd = find_cut(pcBuf, pcEnd, &tsBorder);
+      }
+      write_all(pcBuf, (size_t)(pcEnd-pcBuf));
+      break;
+    }
+    /* 4) Send the lines in the range in the chunk */
+    pcEnd = pcBuf + sizDat;
+    for (pc=pcBuf; pc<pcEnd; pc=pcNext) {
+      pcNext = next_line(pc, pcEnd);
+      if (pcNext[-1]!='\n' && !iEof) {break;} /* incomplete line */
+      if (! get_line_time(pc, pcNext, &tsTime)) {continue;}
+      if (! iBorder) {
+        tsBorder = tsTime; tmsp_add(&tsBorder, gi8Interval);
+        iBorder  = 1;
+      }
+      if (is_out_of_range(&tsTime, &tsBorder)) {
+        write_all(pcBuf, (size_t)(pc-pcBuf));
+        goto finish;
+      }
+    }
+    write_all(pcBuf, (size_t)(pc-pcBuf));
+    if (iEof || (iReady & 2)) {break;}
+    /* 5) Move the incomplete line to the top of the buffer */
+    sizDat = (size_t)(pcEnd-pc);
+    memmove(pcBuf, pc, sizDat);
+  }
+
+finish:
+  /*--- Finish -----------------------------------------------------*/
+  if (iTfd >= 0) {close(iTfd);}
+  free(pcBuf);
+  return iRet;
+}
+
+/*=== Get the end of the range =======================================
+ * [in]  pcTop,pcEnd : The data (the top and the end) to look for the
+ *                     first or the last line in if it is required
+ *       giMode, giFromtop, giL1zero, gi8Interval, gtsTime, gtsZero
+ * [out] ptsBorder   : The end of the range
+ * [ret] 1 : Succeeded
+ *       0 : Failed because the data have no valid timestamp        */
+int get_border(const char *pcTop, const char *pcEnd, tmsp *ptsBorder) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char* pc;
+  const char* pc1;
+
+  /*--- Pattern (e),(f): The date-and-time itself ------------------*/
+  if (giMode == 2) {*ptsBorder = gtsTime; return 1;}
+
+  /*--- Pattern (a),(b): From the top ------------------------------*/
+  if (giFromtop) {
+    if (giL1zero) {
+      for (pc=pcTop; pc<pcEnd; pc=next_line(pc,pcEnd)) {
+        if (get_line_time(pc, pcEnd, ptsBorder)) {break;}
+      }
+      if (pc >= pcEnd) {return 0;}
+    } else if (giTfmt == 2) {
+      ptsBorder->tv_sec  = 0;
+      ptsBorder->tv_nsec = 0;
+    } else {
+      *ptsBorder = gtsZero;
+    }
+    tmsp_add(ptsBorder,  gi8Interval);
+    return 1;
+  }
+
+  /*--- Pattern (c),(d): From the last line ------------------------*/
+  pc = pcEnd;
+  while (pc > pcTop) {
+    /* Find the top of the line before pc */
+    pc1 = pc - 1;
+    while (pc1>pcTop && pc1[-1]!='\n') {pc1--;}
+    if (get_line_time(pc1, pc, ptsBorder)) {
+      tmsp_add(ptsBorder, -gi8Interval);
+      return 1;
+    }
+    pc = pc1;
+  }
+  return 0;
+}
+
+/*=== Find the first line out of the range by binary search ==========
+ * [in] pcTop,pcEnd : The data (the top and the end)
+ *      ptsBorder   : The end of the range
+ * [ret] The top of the first line which has a valid timestamp and is
+ *       out of the range (pcEnd if all lines are in the range)     */
+const char* find_cut(const char *pcTop, const char *pcEnd,
+                     const tmsp *ptsBorder                ) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char* pcLo;  /* all the lines before it are in the range    */
+  const char* pcHi;  /* no valid line from it to pcCut              */
+  const char* pcCut; /* the first line out of the range found so far*/
+  const char* pcMid;
+  const char* pc;
+  tmsp        tsTime;
+
+  /*--- Binary search ----------------------------------------------*/
+  pcLo  = pcTop;
+  pcHi  = pcEnd;
+  pcCut = pcEnd;
+  while (pcLo < pcHi) {
+    pcMid = pcLo + (pcHi-pcLo)/2;
+    /* Look for the first valid line which begins in [pcMid,pcHi) */
+    pc = (pcMid==pcTop || pcMid[-1]=='\n') ? pcMid : next_line(pcMid,pcEnd);
+    for (; pc<pcHi; pc=next_line(pc,pcEnd)) {
+      if (get_line_time(pc, pcEnd, &tsTime)) {break;}
+    }
+    if      (pc >= pcHi                           ) {pcHi=pcMid;            }
+    else if (is_out_of_range(&tsTime, ptsBorder)) {pcHi=pcMid; pcCut=pc;}
+    else                                          {pcLo=next_line(pc,pcEnd);}
+  }
+
+  /*--- Return -----------------------------------------------------*/
+  return pcCut;
+}
+
+/*=== Get the top of the next line ===================================
+ * [in] pc    : A pointer in the current line
+ *      pcEnd : The end of the data
+ * [ret] The top of the next line (pcEnd if it is the last one)     */
+const char* next_line(const char *pc, const char *pcEnd) {
+  const char* pcLf;
+  if (pc >= pcEnd) {return pcEnd;}
+  pcLf = memchr(pc, '\n', (size_t)(pcEnd-pc));
+  return (pcLf) ? pcLf+1 : pcEnd;
+}
+
+/*=== Get the time of the line by its 1st field ======================
+ * [in]  pc      : The top of the line
+ *       pcEnd   : The end of the data (or the line)
+ *       giTfmt  : The format of the timestamp
+ * [out] ptsTime : The time of the line
+ * [ret] 1 : The line has a valid timestamp
+ *       0 : The line does not have a valid one                     */
+int get_line_time(const char *pc, const char *pcEnd, tmsp *ptsTime) {
+
+  /*--- Variables --------------------------------------------------*/
+  char szTime[TS_FIELD_MAX+1];
+  int  i;
+
+  /*--- Copy the 1st field to terminate it -------------------------*/
+  for (i=0; pc+i<pcEnd && i<=TS_FIELD_MAX; i++) {
+    if (pc[i]==' ' || pc[i]=='\t' || pc[i]=='\n') {break;}
+    if (i == TS_FIELD_MAX                       ) {return 0;}
+    szTime[i] = pc[i];
+  }
+  if (i == 0) {return 0;}
+  szTime[i] = '\0';
+
+  /*--- Parse it ---------------------------------------------------*/
+  switch (giTfmt) {
+    case 0 : return parse_calendartime(szTime, ptsTime);
+    case 3 : return parse_iso8601time( szTime, ptsTime);
+    default: return parse_unixtime(    szTime, ptsTime);
+  }
+}
+
+/*=== Is the time out of the range? ==================================
+ * [in] ptsTime   : The time of the line
+ *      ptsBorder : The end of the range
+ *      giEndp    : Including the endpoint or not (1:include)
+ * [ret] 1 : out of the range
+ *       0 : in the range                                           */
+int is_out_of_range(const tmsp *ptsTime, const tmsp *ptsBorder) {
+  if (ptsTime->tv_sec  != ptsBorder->tv_sec ) {
+    return (ptsTime->tv_sec  > ptsBorder->tv_sec );
+  }
+  if (ptsTime->tv_nsec != ptsBorder->tv_nsec) {
+    return (ptsTime->tv_nsec > ptsBorder->tv_nsec);
+  }
+  return (giEndp == 0);
+}
+
+/*=== Open a timer which expires at the deadline =====================
+ * [in] ptsDeadline : The time when the timer expires (CLOCK_REALTIME)
+ * [ret] >=0 : File descriptor of the timer, which becomes readable
+ *             at the deadline
+ *       -1  : The timer is not available (wait_for_input() watches
+ *             the clock by itself instead)                         */
+int open_deadline_timer(const tmsp *ptsDeadline) {
+#if defined(__linux) || defined(__linux__)
+  int               iTfd;
+  struct itimerspec itsDeadline;
+
+  if ((iTfd=timerfd_create(CLOCK_REALTIME, 0)) < 0) {
+    if (giVerbose>0) {warning("timerfd_create(): %s\n",strerror(errno));}
+    return -1;
+  }
+  memset(&itsDeadline, 0, sizeof(itsDeadline));
+  itsDeadline.it_value = *ptsDeadline;
+  if (itsDeadline.it_value.tv_sec<=0 && itsDeadline.it_value.tv_nsec==0) {
+    itsDeadline.it_value.tv_nsec = 1; /* {0,0} would disarm the timer */
+  }
+  if (timerfd_settime(iTfd, TFD_TIMER_ABSTIME, &itsDeadline, NULL) < 0) {
+    if (giVerbose>0) {warning("timerfd_settime(): %s\n",strerror(errno));}
+    close(iTfd);
+    return -1;
+  }
+  return iTfd;
+#else
+  (void)ptsDeadline;
+  return -1;
+#endif
+}
+
+/*=== Wait for the input or the deadline =============================
+ * [in] iFd         : File descriptor of the input file
+ *      iTfd        : Timer by open_deadline_timer() (-1:not available)
+ *      ptsDeadline : The time when the interval ends
+ * [ret] The OR of the following ones
+ *       1 : The input is readable
+ *       2 : The deadline has come                                  */
+int wait_for_input(int iFd, int iTfd, const tmsp *ptsDeadline) {
+
+  /*--- Variables --------------------------------------------------*/
+  fd_set fdsRead;    /* for pselect()                               */
+  tmsp   tsNow;      /* the current time                            */
+  tmsp   tsTimeout;  /* the rest of the time until the deadline     */
+  int    iMax;
+  int    i;
+
+  /*--- Wait for them (loop) ---------------------------------------*/
+  while (1) {
+    FD_ZERO(&fdsRead);
+    FD_SET(iFd, &fdsRead);
+    iMax = iFd;
+    if (iTfd >= 0) {
+      /* The timer tells the deadline */
+      FD_SET(iTfd, &fdsRead);
+      if (iTfd > iMax) {iMax = iTfd;}
+      i = pselect(iMax+1, &fdsRead, NULL, NULL, NULL, NULL);
+    } else {
+      /* Otherwise, calculate the rest of the time every time */
+      if (clock_gettime(CLOCK_REALTIME,&tsNow) != 0) {
+        error_exit(errno,"clock_gettime() in wait_for_input(): %s\n",
+                   strerror(errno));
+      }
+      tsTimeout.tv_sec  = ptsDeadline->tv_sec  - tsNow.tv_sec ;
+      tsTimeout.tv_nsec = ptsDeadline->tv_nsec - tsNow.tv_nsec;
+      if (tsTimeout.tv_nsec < 0) {tsTimeout.tv_sec--; tsTimeout.tv_nsec+=1000000000;}
+      if (tsTimeout.tv_sec  < 0) {tsTimeout.tv_sec=0; tsTimeout.tv_nsec=0;}
+      i = pselect(iMax+1, &fdsRead, NULL, NULL, &tsTimeout, NULL);
+      if (i == 0) {return 2;}
+    }
+    if (i < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"pselect() in wait_for_input(): %s\n",strerror(errno));
+    }
+    break;
+  }
+
+  /*--- Return -----------------------------------------------------*/
+  i = (FD_ISSET(iFd, &fdsRead)) ? 1 : 0;
+  if (iTfd >= 0 && FD_ISSET(iTfd, &fdsRead)) {i |= 2;}
+  return i;
+}
+
+/*=== Parse the periodic time ========================================
+ * [ret] >= 0  : Interval value (in nanosecound)
+ *       <=-1  : (undefined)
+ *       <=-2  : It is not a value                                  */
+int64_t parse_periodictime(char *pszArg) {
+
+  /*--- Variables --------------------------------------------------*/
+  char   szUnit[OPT_PARM_BUF];
+  double dNum;
+
+  /*--- Check the lengths of the argument --------------------------*/
+  if (strlen(pszArg) >= OPT_PARM_BUF) {return -2;}
+
+  /*--- Try to interpret the argument as "<value>"[+"unit"] --------*/
+  switch (sscanf(pszArg, "%lf%s", &dNum, szUnit)) {
+    case   2:                      break;
+    case   1: strcpy(szUnit, "s"); break;
+    default : return -2;
+  }
+  if (dNum < 0                     ) {return -2;}
+
+  /* as a second value */
+  if (strcmp(szUnit, "s" )==0) {
+    if (dNum > ((double)INT_MAX             )) {return -2;}
+    return       (int64_t)(dNum * 1000000000);
+  }
+
+  /* as a millisecond value */
+  if (strcmp(szUnit, "ms")==0) {
+    if (dNum > ((double)INT_MAX *       1000)) {return -2;}
+    return       (int64_t)(dNum *    1000000);
+  }
+
+  /* as a microsecond value */
+  if (strcmp(szUnit, "us")==0) {
+    if (dNum > ((double)INT_MAX *    1000000)) {return -2;}
+    return       (int64_t)(dNum *       1000);
+  }
+
+  /* as a nanosecond value */
+  if (strcmp(szUnit, "ns")==0) {
+    if (dNum > ((double)INT_MAX * 1000000000)) {return -2;}
+    return       (int64_t)(dNum *          1);
+  }
+
+  /*--- Otherwise, it is not a value -------------------------------*/
+  return -2;
+}
+
+/*=== Write the whole data into the stdout ===========================
+ * [in] pc  : The data
+ *      siz : The size of the data                                  */
+void write_all(const char *pc, size_t siz) {
+
+  ssize_t ss;
+
+  while (siz > 0) {
+    ss = write(STDOUT_FILENO, pc, siz);
+    if (ss < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write() to the stdout: %s\n",strerror(errno));
+    }
+    pc  += ss;
+    siz -= (size_t)ss;
+  }
+}
+
+/*=== Add nanoseconds to a timespec ==================================
+ * [in/out] pts    : The time to be added to
+ * [in]     i8Nsec : Nanoseconds to add (can be negative)           */
+void tmsp_add(tmsp *pts, int64_t i8Nsec) {
+  pts->tv_sec  += (time_t)(i8Nsec / 1000000000);
+  pts->tv_nsec +=   (long)(i8Nsec % 1000000000);
+  if      (pts->tv_nsec >= 1000000000) {pts->tv_sec++; pts->tv_nsec-=1000000000;}
+  else if (pts->tv_nsec <           0) {pts->tv_sec--; pts->tv_nsec+=1000000000;}
+}
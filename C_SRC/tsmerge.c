@@ -0,0 +1,586 @@
+/*####################################################################
+#
+# TSMERGE - Merge Timestamped Files Into One Stream in Time Order
+#
+# USAGE   : tsmerge [-c|-e|-I|-z] [-u] file [file ...]
+# Args    : file ........ Filepath to be merged ("-" means STDIN)
+#                         The file MUST be a textfile and MUST have
+#                         a timestamp at the first field of each line,
+#                         and the lines MUST be in time order. The first
+#                         space character <0x20> of every line will be
+#                         regarded as the field delimiter.
+#                         * The lines of all the files are sent to the
+#                           stdout in time order, as they are. So, you
+#                           can replay them by piping to tscat with the
+#                           same format option.
+#                         * The lines which have the same time are sent
+#                           in the order of the files in the arguments.
+#                         * A line whose first field is not a valid time-
+#                           stamp is regarded as a continuation of the
+#                           previous line (e.g. a stack trace in a log).
+#                           So, it is sent right after the previous line
+#                           and never comes between the lines of another
+#                           file.
+#                         * A regular file is memory-mapped and does not
+#                           use a file descriptor after that. So, you can
+#                           merge even a thousand files at once.
+# Options : -c,-e,-I,-z . Specify the format for timestamp. You can choose
+#                         one of the following.
+#                           -c ... "YYYYMMDDhhmmss[.n]" (default)
+#                                  Calendar time (standard time) in your
+#                                  timezone (".n" is the digits under
+#                                  second. You can specify up to nano
+#                                  second.)
+#                           -e ... "[+|-]n[.n]"
+#                                  The number of seconds since the UNIX
+#                                  epoch (".n" is the same as -c)
+#                           -I ... "YYYY-MM-DDThh:mm:ss[,n][{{+|-}hh:mm|Z}]"
+#                                  Ext. ISO 8601 formatted time in your
+#                                  timezone (".n" is the same as -c)
+#                           -z ... "[+|-]n[.n]"
+#                                  The number of seconds since some time
+#                                  (".n" is the same as -c)
+#           -u .......... Set the date in UTC when -c option is set
+#                         (same as that of date command)
+# Retuen  : Return 0 only when finished successfully for all files
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <locale.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#include "timeio.h"
+
+/*--- macro constants ----------------------------------------------*/
+/* Maximum length of the timestamp field */
+#define TS_FIELD_MAX 42
+/* Initial size of the buffer for reading a stream */
+#define READ_BUF 65536
+/* Size of the buffer for the stdout */
+#define WRITE_BUF 1048576
+
+/*--- data type definitions ----------------------------------------*/
+typedef struct timespec tmsp;
+typedef struct _cursor_t {
+  const char* pszName;  /* filepath (for message)                   */
+  int         iNo;      /* order in the arguments (for the same time)*/
+  int         iFd;      /* file descriptor (-1:mapped or finished)  */
+  char*       pcMap;    /* the mapping (NULL:read by the buffer)    */
+  size_t      sizMap;   /* size of the mapping                      */
+  char*       pcBuf;    /* the buffer for a stream                  */
+  size_t      sizBuf;   /* size of the buffer                       */
+  const char* pcRec;    /* the top of the current record            */
+  const char* pcNext;   /* the top of the next record               */
+  const char* pcEnd;    /* the end of the data                      */
+  int         iEof;     /* 1 if the stream came to EOF              */
+  int         iNotime;  /* 1 if the record has no timestamp         */
+  tmsp        tsRec;    /* the time of the current record           */
+} cursor_t;             /* a reading position of an input file      */
+
+/*--- prototype functions ------------------------------------------*/
+int  open_cursor(cursor_t* pcs, const char* pszPath);
+int  next_record(cursor_t* pcs);
+int  fill_cursor(cursor_t* pcs);
+void close_cursor(cursor_t* pcs);
+int  get_line_time(const char *pc, const char *pcEnd, tmsp *ptsTime);
+const char* next_line(const char *pc, const char *pcEnd);
+void write_record(cursor_t* pcs);
+int  cursor_cmp(const cursor_t* pcs1, const cursor_t* pcs2);
+void heap_sift_up(cursor_t** ppcsHeap, int iPos);
+void heap_sift_down(cursor_t** ppcsHeap, int iHeapNum, int iPos);
+
+/*--- global variables ---------------------------------------------*/
+char*   gpszCmdname; /* The name of this command                    */
+int     giVerbose;   /* speaks more verbosely by the greater number */
+int     giTfmt;      /* 0:"-c"  1:"-e"  2:"-z"  3:"-I"              */
+
+/*=== Define the functions for printing usage and error ============*/
+
+/*--- exit with usage ----------------------------------------------*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : %s [-c|-e|-I|-z] [-u] file [file ...]\n"
+    "Args    : file ........ Filepath to be merged (\"-\" means STDIN)\n"
+    "                        The file MUST be a textfile and MUST have\n"
+    "                        a timestamp at the first field of each line,\n"
+    "                        and the lines MUST be in time order. The first\n"
+    "                        space character <0x20> of every line will be\n"
+    "                        regarded as the field delimiter.\n"
+    "                        * The lines of all the files are sent to the\n"
+    "                          stdout in time order, as they are. So, you\n"
+    "                          can replay them by piping to tscat with the\n"
+    "                          same format option.\n"
+    "                        * The lines which have the same time are sent\n"
+    "                          in the order of the files in the arguments.\n"
+    "                        * A line whose first field is not a valid time-\n"
+    "                          stamp is regarded as a continuation of the\n"
+    "                          previous line (e.g. a stack trace in a log).\n"
+    "                          So, it is sent right after the previous line\n"
+    "                          and never comes between the lines of another\n"
+    "                          file.\n"
+    "                        * A regular file is memory-mapped and does not\n"
+    "                          use a file descriptor after that. So, you can\n"
+    "                          merge even a thousand files at once.\n"
+    "Options : -c,-e,-I,-z . Specify the format for timestamp. You can choose\n"
+    "                        one of the following.\n"
+    "                          -c ... \"YYYYMMDDhhmmss[.n]\" (default)\n"
+    "                                 Calendar time (standard time) in your\n"
+    "                                 timezone (\".n\" is the digits under\n"
+    "                                 second. You can specify up to nano\n"
+    "                                 second.)\n"
+    "                          -e ... \"[+|-]n[.n]\"\n"
+    "                                 The number of seconds since the UNIX\n"
+    "                                 epoch (\".n\" is the same as -c)\n"
+    "                          -I ... \"YYYY-MM-DDThh:mm:ss[,n][{{+|-}hh:mm|Z}]"
+                                                                          "\"\n"
+    "                                 Ext. ISO 8601 formatted time in your\n"
+    "                                 timezone (\".n\" is the same as -c)\n"
+    "                          -z ... \"[+|-]n[.n]\"\n"
+    "                                 The number of seconds since some time\n"
+    "                                 (\".n\" is the same as -c)\n"
+    "          -u .......... Set the date in UTC when -c option is set\n"
+    "                        (same as that of date command)\n"
+    "Version : 2026-10-18 22:47:36 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/tokideli\n"
+    ,gpszCmdname);
+  exit(1);
+}
+
+/*--- print warning message ----------------------------------------*/
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr, szFormat, va);
+  va_end(va);
+  return;
+}
+
+/*--- exit with error message --------------------------------------*/
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr, szFormat, va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+/*=== Initialization ===============================================*/
+int main(int argc, char *argv[]) {
+
+/*--- Variables ----------------------------------------------------*/
+cursor_t*  pcsAll;        /* cursors of all the files                     */
+cursor_t** ppcsHeap;      /* min-heap of the cursors by the next record   */
+cursor_t*  pcs;           /* the cursor which has the earliest record     */
+int        iHeapNum;      /* number of the cursors in the heap            */
+int        iFiles;        /* number of the files                          */
+int        iRet;          /* return code                                  */
+struct rlimit stRlim;     /* for raising the limit of file descriptors    */
+char      *pszStdin[2];   /* arguments when no file is given              */
+int        i;             /* all-purpose int                              */
+
+/*--- Initialize ---------------------------------------------------*/
+gpszCmdname = argv[0];
+for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+  if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+}
+if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+  error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+}
+setlocale(LC_CTYPE, "");
+
+/*=== Parse arguments ==============================================*/
+
+/*--- Set default parameters of the arguments ----------------------*/
+giTfmt    = 0; /* 0:"-c"(default) 1:"-e" 2:"-z" 3:"-I" */
+giVerbose = 0;
+
+/*--- Parse options which start by "-" -----------------------------*/
+while ((i=getopt(argc, argv, "ceIzuhv")) != -1) {
+  switch (i) {
+    case 'c': giTfmt = 0;                    break;
+    case 'e': giTfmt = 1;                    break;
+    case 'z': giTfmt = 2;                    break;
+    case 'I': giTfmt = 3;                    break;
+    case 'u': (void)setenv("TZ", "UTC0", 1); break;
+    case 'v': giVerbose++;                   break;
+    case 'h': print_usage_and_exit();
+    default : print_usage_and_exit();
+  }
+}
+argc -= optind;
+argv += optind;
+if (argc == 0) {pszStdin[0]="-"; pszStdin[1]=NULL; argv=pszStdin; argc=1;}
+if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
+
+/*=== Prepare the cursors ==========================================*/
+
+/*--- Raise the limit of file descriptors for the streams ----------*/
+if (getrlimit(RLIMIT_NOFILE,&stRlim)==0 && stRlim.rlim_cur<stRlim.rlim_max) {
+  stRlim.rlim_cur = stRlim.rlim_max;
+  (void)setrlimit(RLIMIT_NOFILE, &stRlim);
+}
+
+/*--- Open all the files -------------------------------------------*/
+iFiles   = argc;
+pcsAll   = (cursor_t* )calloc((size_t)iFiles, sizeof(cursor_t ));
+ppcsHeap = (cursor_t**)calloc((size_t)iFiles, sizeof(cursor_t*));
+if (!pcsAll || !ppcsHeap) {error_exit(1,"Memory is not enough.\n");}
+iRet     = 0;
+iHeapNum = 0;
+for (i=0; i<iFiles; i++) {
+  pcsAll[i].iNo = i;
+  if (open_cursor(&pcsAll[i], argv[i]) != 0) {iRet=1; continue;}
+  switch (next_record(&pcsAll[i])) {
+    case 1 : ppcsHeap[iHeapNum] = &pcsAll[i];
+             heap_sift_up(ppcsHeap, iHeapNum++);
+             break;
+    case 0 : close_cursor(&pcsAll[i]); break;
+    default: close_cursor(&pcsAll[i]); iRet=1; break;
+  }
+}
+if (giVerbose>0) {warning("%d file(s) are ready\n",iHeapNum);}
+if (setvbuf(stdout,NULL,_IOFBF,WRITE_BUF) != 0) {
+  error_exit(1,"Failed to setvbuf() for STDOUT\n");
+}
+
+/*=== Merge (loop) =================================================*/
+while (iHeapNum > 0) {
+  /* 1) Send the earliest record, and the following ones of the same
+        file as long as they are still the earliest                   */
+  pcs = ppcsHeap[0];
+  do {
+    write_record(pcs);
+    i = next_record(pcs);
+  } while (i==1 && (iHeapNum==1 || (cursor_cmp(pcs,ppcsHeap[1])<=0
+                                    && (iHeapNum==2
+                                        || cursor_cmp(pcs,ppcsHeap[2])<=0))));
+  /* 2) Put the cursor back into the heap, or remove it if finished */
+  if (i != 1) {
+    if (i < 0) {iRet = 1;}
+    close_cursor(pcs);
+    ppcsHeap[0] = ppcsHeap[--iHeapNum];
+  }
+  if (iHeapNum > 0) {heap_sift_down(ppcsHeap, iHeapNum, 0);}
+}
+
+/*=== Finish normally ==============================================*/
+if (fflush(stdout) == EOF) {
+  error_exit(errno,"fflush() at the end: %s\n",strerror(errno));
+}
+return(iRet);}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Open a cursor for the file =====================================
+ * A regular file is mapped and its file descriptor is closed at once.
+ * Otherwise, the file is read by the buffer.
+ * [in]  pszPath : Filepath ("-" means STDIN)
+ * [out] pcs     : The cursor, which points nothing yet
+ * [ret] 0 : Succeeded
+ *       1 : Failed (The warning has been printed already)          */
+int open_cursor(cursor_t* pcs, const char* pszPath) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stFile;  /* stat of the file                          */
+  off_t       otPos;   /* the current offset in the file            */
+  off_t       otMap;   /* the offset the mapping begins at          */
+  long        lPgsiz;  /* page size                                 */
+
+  /*--- Open the file ----------------------------------------------*/
+  if (strcmp(pszPath, "-") == 0) {
+    pcs->pszName = "stdin";
+    pcs->iFd     = STDIN_FILENO;
+  } else {
+    pcs->pszName = pszPath;
+    while ((pcs->iFd=open(pszPath, O_RDONLY)) < 0) {
+      if (errno == EINTR) {continue;}
+      warning("%s: %s\n", pszPath, strerror(errno));
+      return 1;
+    }
+  }
+  pcs->pcMap  = NULL;
+  pcs->pcBuf  = NULL;
+  pcs->iEof   = 0;
+
+  /*--- Map it if it is a regular file -----------------------------*/
+  while (1) {
+    if (fstat(pcs->iFd,&stFile)  < 0          ) {break;}
+    if (! S_ISREG(stFile.st_mode)             ) {break;}
+    if ((otPos=lseek(pcs->iFd,0,SEEK_CUR)) < 0) {break;}
+    if ((lPgsiz=sysconf(_SC_PAGESIZE)) < 1    ) {break;}
+    if (stFile.st_size <= otPos) {
+      /* empty, so nothing to be read */
+      pcs->pcRec = pcs->pcNext = pcs->pcEnd = NULL;
+      pcs->iEof  = 1;
+      close_cursor(pcs);
+      return 0;
+    }
+    otMap = otPos - otPos%lPgsiz;
+    if ((uintmax_t)(stFile.st_size-otMap) > (uintmax_t)SIZE_MAX) {break;}
+    pcs->sizMap = (size_t)(stFile.st_size-otMap);
+    pcs->pcMap  = mmap(NULL,pcs->sizMap,PROT_READ,MAP_SHARED,pcs->iFd,otMap);
+    if (pcs->pcMap == MAP_FAILED) {pcs->pcMap=NULL; break;}
+    posix_madvise(pcs->pcMap, pcs->sizMap, POSIX_MADV_SEQUENTIAL);
+    pcs->pcNext = pcs->pcMap + (otPos-otMap);
+    pcs->pcEnd  = pcs->pcMap + pcs->sizMap;
+    pcs->iEof   = 1;
+    if (pcs->iFd != STDIN_FILENO) {close(pcs->iFd);}
+    pcs->iFd    = -1;
+    return 0;
+  }
+
+  /*--- Otherwise, prepare the buffer ------------------------------*/
+  if (giVerbose>1) {warning("%s: read by the buffer\n",pcs->pszName);}
+  pcs->sizBuf = READ_BUF;
+  if ((pcs->pcBuf=(char*)malloc(pcs->sizBuf)) == NULL) {
+    error_exit(errno,"malloc() in open_cursor(): %s\n",strerror(errno));
+  }
+  pcs->pcNext = pcs->pcBuf;
+  pcs->pcEnd  = pcs->pcBuf;
+  return 0;
+}
+
+/*=== Move the cursor to the next record =============================
+ * A record is a line which has a valid timestamp and the continuation
+ * lines after it. Only the first record of a file can be the lines
+ * without timestamp, and it comes before everything.
+ * [in/out] pcs : The cursor
+ * [ret] 1 : The next record is ready
+ *       0 : No more record
+ *       -1: File access error                                      */
+int next_record(cursor_t* pcs) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char* pc;       /* the top of the current line              */
+  const char* pcLine;   /* the top of the next line                 */
+  size_t      sizOfs;   /* offset of pc in the record               */
+  tmsp        ts;
+
+  /*--- The current record begins at the next one ------------------*/
+  pcs->pcRec = pcs->pcNext;
+  pc         = pcs->pcRec;
+  while (1) {
+    /* 1) Get the top of the line after the one at pc */
+    pcLine = next_line(pc, pcs->pcEnd);
+    if ((pcLine==pcs->pcEnd) && !pcs->iEof) {
+      /* Not found yet in the stream, so read more and retry */
+      sizOfs = (size_t)(pc-pcs->pcRec);
+      if (fill_cursor(pcs) < 0) {return -1;}
+      pc = pcs->pcRec + sizOfs; /* fill_cursor() has moved the record */
+      continue;
+    }
+    /* 2) The first line of the record tells the time */
+    if (pc == pcs->pcRec) {
+      if (pc >= pcs->pcEnd) {return 0;} /* no more */
+      pcs->iNotime = ! get_line_time(pc, pcLine, &pcs->tsRec);
+      pc = pcLine;
+      continue;
+    }
+    /* 3) The record ends at the next line which has the time */
+    if (pc >= pcs->pcEnd || get_line_time(pc, pcLine, &ts)) {break;}
+    pc = pcLine;
+  }
+  pcs->pcNext = pc;
+  return 1;
+}
+
+/*=== Read more data into the buffer of the cursor ===================
+ * The current record is moved to the top of the buffer first, so the
+ * pointers in the cursor are fixed by this function.
+ * [in/out] pcs : The cursor
+ * [ret] 1 : Read some data
+ *       0 : Came to EOF (pcs->iEof is set)
+ *       -1: File access error                                      */
+int fill_cursor(cursor_t* pcs) {
+
+  size_t  sizDat;
+  ssize_t ss;
+
+  /*--- Move the current record to the top -------------------------*/
+  sizDat = (size_t)(pcs->pcEnd-pcs->pcRec);
+  if (pcs->pcRec != pcs->pcBuf) {memmove(pcs->pcBuf, pcs->pcRec, sizDat);}
+  if (sizDat == pcs->sizBuf) {
+    if ((pcs->pcBuf=(char*)realloc(pcs->pcBuf,pcs->sizBuf*2)) == NULL) {
+      error_exit(errno,"realloc() in fill_cursor(): %s\n",strerror(errno));
+    }
+    pcs->sizBuf *= 2;
+  }
+  pcs->pcRec = pcs->pcBuf;
+  pcs->pcEnd = pcs->pcBuf + sizDat;
+
+  /*--- Read --------------------------------------------------------*/
+  while ((ss=read(pcs->iFd, pcs->pcBuf+sizDat, pcs->sizBuf-sizDat)) < 0) {
+    if (errno == EINTR) {continue;}
+    warning("%s: %s\n", pcs->pszName, strerror(errno));
+    return -1;
+  }
+  if (ss == 0) {pcs->iEof = 1; return 0;}
+  pcs->pcEnd += ss;
+  return 1;
+}
+
+/*=== Release the cursor =============================================*/
+void close_cursor(cursor_t* pcs) {
+  if (pcs->pcMap) {munmap(pcs->pcMap, pcs->sizMap); pcs->pcMap=NULL;}
+  if (pcs->pcBuf) {free(pcs->pcBuf);                pcs->pcBuf=NULL;}
+  if (pcs->iFd>=0 && pcs->iFd!=STDIN_FILENO) {close(pcs->iFd);}
+  pcs->iFd = -1;
+}
+
+/*=== Write the current record of the cursor =========================
+ * A newline is added if the record is the last line without it.   */
+void write_record(cursor_t* pcs) {
+  size_t siz;
+
+  siz = (size_t)(pcs->pcNext-pcs->pcRec);
+  if (fwrite(pcs->pcRec, 1, siz, stdout) < siz) {
+    error_exit(errno,"fwrite() to the stdout: %s\n",strerror(errno));
+  }
+  if (pcs->pcRec[siz-1] != '\n') {
+    if (putchar('\n') == EOF) {
+      error_exit(errno,"putchar() to the stdout: %s\n",strerror(errno));
+    }
+  }
+}
+
+/*=== Get the top of the next line ===================================
+ * [in] pc    : A pointer in the current line
+ *      pcEnd : The end of the data
+ * [ret] The top of the next line (pcEnd if it is the last one)     */
+const char* next_line(const char *pc, const char *pcEnd) {
+  const char* pcLf;
+  if (pc >= pcEnd) {return pcEnd;}
+  pcLf = memchr(pc, '\n', (size_t)(pcEnd-pc));
+  return (pcLf) ? pcLf+1 : pcEnd;
+}
+
+/*=== Get the time of the line by its 1st field ======================
+ * [in]  pc      : The top of the line
+ *       pcEnd   : The end of the data (or the line)
+ *       giTfmt  : The format of the timestamp
+ * [out] ptsTime : The time of the line
+ * [ret] 1 : The line has a valid timestamp
+ *       0 : The line does not have a valid one                     */
+int get_line_time(const char *pc, const char *pcEnd, tmsp *ptsTime) {
+
+  /*--- Variables --------------------------------------------------*/
+  char szTime[TS_FIELD_MAX+1];
+  int  i;
+
+  /*--- Copy the 1st field to terminate it -------------------------*/
+  for (i=0; pc+i<pcEnd && i<=TS_FIELD_MAX; i++) {
+    if (pc[i]==' ' || pc[i]=='\t' || pc[i]=='\n') {break;}
+    if (i == TS_FIELD_MAX                       ) {return 0;}
+    szTime[i] = pc[i];
+  }
+  if (i == 0) {return 0;}
+  szTime[i] = '\0';
+
+  /*--- Parse it ---------------------------------------------------*/
+  switch (giTfmt) {
+    case 0 : return parse_calendartime(szTime, ptsTime);
+    case 3 : return parse_iso8601time( szTime, ptsTime);
+    default: return parse_unixtime(    szTime, ptsTime);
+  }
+}
+
+/*=== Compare the current records of two cursors =====================
+ * The record without timestamp is the earliest, and the order in the
+ * arguments decides when the times are the same.
+ * [ret] <0, 0, >0 like strcmp()                                    */
+int cursor_cmp(const cursor_t* pcs1, const cursor_t* pcs2) {
+  if (pcs1->iNotime != pcs2->iNotime) {
+    return (pcs1->iNotime) ? -1 : 1;
+  }
+  if (! pcs1->iNotime) {
+    if (pcs1->tsRec.tv_sec  != pcs2->tsRec.tv_sec ) {
+      return (pcs1->tsRec.tv_sec  < pcs2->tsRec.tv_sec ) ? -1 : 1;
+    }
+    if (pcs1->tsRec.tv_nsec != pcs2->tsRec.tv_nsec) {
+      return (pcs1->tsRec.tv_nsec < pcs2->tsRec.tv_nsec) ? -1 : 1;
+    }
+  }
+  return pcs1->iNo - pcs2->iNo;
+}
+
+/*=== Move the cursor at the position up to the right place ==========*/
+void heap_sift_up(cursor_t** ppcsHeap, int iPos) {
+  cursor_t* pcs;
+  int       iParent;
+
+  pcs = ppcsHeap[iPos];
+  while (iPos > 0) {
+    iParent = (iPos-1)/2;
+    if (cursor_cmp(ppcsHeap[iParent],pcs) <= 0) {break;}
+    ppcsHeap[iPos] = ppcsHeap[iParent];
+    iPos           = iParent;
+  }
+  ppcsHeap[iPos] = pcs;
+}
+
+/*=== Move the cursor at the position down to the right place ========*/
+void heap_sift_down(cursor_t** ppcsHeap, int iHeapNum, int iPos) {
+  cursor_t* pcs;
+  int       iChild;
+
+  pcs = ppcsHeap[iPos];
+  while ((iChild=iPos*2+1) < iHeapNum) {
+    if (iChild+1<iHeapNum &&
+        cursor_cmp(ppcsHeap[iChild+1],ppcsHeap[iChild])<0) {
+      iChild++;
+    }
+    if (cursor_cmp(pcs,ppcsHeap[iChild]) <= 0) {break;}
+    ppcsHeap[iPos] = ppcsHeap[iChild];
+    iPos           = iChild;
+  }
+  ppcsHeap[iPos] = pcs;
+}
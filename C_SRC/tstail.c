@@ -0,0 +1,928 @@
+/*####################################################################
+#
+# TSTAIL - A "tail" Command Which Considers Timestamp Instead of
+#          the Number of Lines
+#
+# USAGE   : (a) tstail [options]     -i  interval      [file ...]
+#           (b) tstail [options] -x  -i  interval      [file ...]
+#           (c) tstail [options]     -i +interval      [file ...]
+#           (d) tstail [options] -x  -i +interval      [file ...]
+#           (e) tstail [options]     -t  date-and-time [file ...]
+#           (f) tstail [options] -x  -t  date-and-time [file ...]
+#
+#           The lines that can pass through this command will be chosen
+#           by making sure the timestamp at the first field of each line
+#           is in one of the following ranges.
+#             (a) [ <last line's time>  -<interval>, <last> ]
+#             (b) ( <last line's time>  -<interval>, <last> ]
+#             (c) [ <command start time>+<interval>, <last> ]
+#             (d) ( <command start time>+<interval>, <last> ]
+#             (e) [ <date-and-time>                , <last> ]
+#             (f) ( <date-and-time>                , <last> ]
+#           The lines are supposed to be in time order. So, all of the
+#           lines after the first line in the range are sent.
+#
+# Args    : file ........ Filepath to be send ("-" means STDIN)
+#                         The file MUST be a textfile and MUST have
+#                         a timestamp at the first field of each line,
+#                         and the lines MUST be in time order. The first
+#                         space character <0x20> of every line will be
+#                         regarded as the field delimiter.
+#                         * The lines are sent to the stdout as they are,
+#                           with their timestamps.
+#                         * A line whose first field is not a valid time-
+#                           stamp is regarded as a continuation of the
+#                           previous line (e.g. a stack trace in a log).
+#                           So, it passes through when the previous line
+#                           does.
+#                         * When the file is a regular file, this command
+#                           does not read the whole file but finds the
+#                           top of the range by binary search backward
+#                           from the end of the memory-mapped file, and
+#                           sends the lines in the range at once.
+#                         * Otherwise, this command keeps only the lines
+#                           in the range while reading. So, the memory
+#                           it uses depends on the size of the range,
+#                           not on the size of the whole data. In the
+#                           pattern (c) to (f), the lines are sent as
+#                           soon as the first line in the range comes.
+# Options : -c,-e,-I,-z . Specify the format for timestamp and -t option
+#                         parameter. You can choose one of the following.
+#                           -c ... "YYYYMMDDhhmmss[.n]" (default)
+#                                  Calendar time (standard time) in your
+#                                  timezone (".n" is the digits under
+#                                  second. You can specify up to nano
+#                                  second.)
+#                           -e ... "[+|-]n[.n]"
+#                                  The number of seconds since the UNIX
+#                                  epoch (".n" is the same as -c)
+#                           -I ... "YYYY-MM-DDThh:mm:ss[,n][{{+|-}hh:mm|Z}]"
+#                                  Ext. ISO 8601 formatted time in your
+#                                  timezone (".n" is the same as -c)
+#                           -z ... "[+|-]n[.n]"
+#                                  The number of seconds since this
+#                                  command has started (".n" is the same
+#                                  as -c)
+#           -i interval . This is one of options to specify the timestamp
+#                         range. (See the pattern (a) to (d) above)
+#                         You can use the format "A[.B][u]" as the
+#                         option's parameter "interval."
+#                           "A" is the integer part of the time.
+#                           "B" is the decimal part of the time.
+#                           "u" is the unit for the time. You can choose
+#                               one of the followings.
+#                               "s", "ms", "us" and "ns."
+#           -t date-and-time
+#                         This is one of options to specify the timestamp
+#                         range. (See the pattern (e) and (f) above)
+#                         The format of "date-and-time" depends on
+#                         which of the option "-c", "-e," "-I" or "-z"
+#                         you choose.
+#                           "-c" ... "YYYYMMDDhhmmss[.n]" (cal. time)
+#                           "-e" ... "n[.n]" (UNIX time)
+#                           "-I" ... "YYYY-MM-DDThh:mm:ss[,n]" (ISO 8601)
+#                           "-z" ... "n[.n]" (the number of seconds)
+#           -q .......... Suppresses printing filenames when two or more
+#                         files are given.
+#           -u .......... Set the date in UTC when -c option is set
+#                         (same as that of date command)
+#           -x .......... An additional option for -i and -t. It will
+#                         exclude the endpoint itself from the range.
+#                         (See the pattern (b), (d) and (f) above)
+#           -Z .......... Measure the interval of the "-i +" option from
+#                         the time of the first line of each file instead
+#                         of the command start time.
+#                         For instance, "-Z -i +5" drops the first five
+#                         seconds of each file.
+# Retuen  : Return 0 only when finished successfully for all files
+#
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
+#                  (if it doesn't work)
+# How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
+#
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
+#
+# This is a public-domain software (CC0). It means that all of the
+# people can use this for any purposes with no restrictions at all.
+# By the way, We are fed up with the side effects which are brought
+# about by the major licenses.
+#
+# The latest version is distributed at the following page.
+# https://github.com/ShellShoccar-jpn/tokideli
+#
+####################################################################*/
+
+
+
+/*####################################################################
+# Initial Configuration
+####################################################################*/
+
+/*=== Initial Setting ==============================================*/
+
+/*--- headers ------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <locale.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux) || defined(__linux__)
+  #include <sys/sendfile.h>
+#endif
+#include "timeio.h"
+
+/*--- macro constants ----------------------------------------------*/
+/* Buffer size for the option parameter */
+#define OPT_PARM_BUF 64
+/* Maximum length of the timestamp field */
+#define TS_FIELD_MAX 42
+/* Initial size of the arena for reading a stream */
+#define READ_BUF 65536
+/* Initial number of the entries of the line index */
+#define LIDX_NUM 1024
+
+/*--- data type definitions ----------------------------------------*/
+typedef struct timespec tmsp;
+typedef struct _lidx_t {
+  size_t sizOfs;  /* the offset of the line in the arena            */
+  tmsp   tsTime;  /* the timestamp of the line                      */
+} lidx_t;         /* an entry of the line index                     */
+
+/*--- prototype functions ------------------------------------------*/
+int  tail_mmapped_file(int iFd);
+int  tail_streamed_file(int iFd);
+int  get_border(const char *pcTop, const char *pcEnd, tmsp *ptsBorder);
+const char* find_top(const char *pcTop, const char *pcEnd,
+                     const tmsp *ptsBorder                );
+const char* next_line(const char *pc, const char *pcEnd);
+int  get_line_time(const char *pc, const char *pcEnd, tmsp *ptsTime);
+int  is_before_range(const tmsp *ptsTime, const tmsp *ptsBorder);
+int64_t parse_periodictime(char *pszArg);
+void write_all(const char *pc, size_t siz);
+void tmsp_add(tmsp *pts, int64_t i8Nsec);
+
+/*--- global variables ---------------------------------------------*/
+char*   gpszCmdname; /* The name of this command                    */
+int     giVerbose;   /* speaks more verbosely by the greater number */
+tmsp    gtsZero;     /* The zero-point time                         */
+int     giTfmt;      /* 0:"-c"  1:"-e"  2:"-z"  3:"-I"              */
+int     giMode;      /* 1:"-i"  2:"-t"  0:(undefined)               */
+int     giEndp;      /* Including the endpoint or not (1:include)   */
+int     giL1zero;    /* Interval is based on the time 1st line comes*/
+int     giFromtop;   /* The interval is from the (1:top 0:end)      */
+int64_t gi8Interval; /* The interval by "-i" (in nanosecond)        */
+tmsp    gtsTime;     /* The date-and-time by "-t"                   */
+
+/*=== Define the functions for printing usage and error ============*/
+
+/*--- exit with usage ----------------------------------------------*/
+void print_usage_and_exit(void) {
+  fprintf(stderr,
+    "USAGE   : (a) %s [options]     -i  interval      [file ...]\n"
+    "          (b) %s [options] -x  -i  interval      [file ...]\n"
+    "          (c) %s [options]     -i +interval      [file ...]\n"
+    "          (d) %s [options] -x  -i +interval      [file ...]\n"
+    "          (e) %s [options]     -t  date-and-time [file ...]\n"
+    "          (f) %s [options] -x  -t  date-and-time [file ...]\n"
+    "\n"
+    "          The lines that can pass through this command will be chosen\n"
+    "          by making sure the timestamp at the first field of each line\n"
+    "          is in one of the following ranges.\n"
+    "            (a) [ <last line's time>  -<interval>, <last> ]\n"
+    "            (b) ( <last line's time>  -<interval>, <last> ]\n"
+    "            (c) [ <command start time>+<interval>, <last> ]\n"
+    "            (d) ( <command start time>+<interval>, <last> ]\n"
+    "            (e) [ <date-and-time>                , <last> ]\n"
+    "            (f) ( <date-and-time>                , <last> ]\n"
+    "          The lines are supposed to be in time order. So, all of the\n"
+    "          lines after the first line in the range are sent.\n"
+    "\n"
+    "Args    : file ........ Filepath to be send (\"-\" means STDIN)\n"
+    "                        The file MUST be a textfile and MUST have\n"
+    "                        a timestamp at the first field of each line,\n"
+    "                        and the lines MUST be in time order. The first\n"
+    "                        space character <0x20> of every line will be\n"
+    "                        regarded as the field delimiter.\n"
+    "                        * The lines are sent to the stdout as they are,\n"
+    "                          with their timestamps.\n"
+    "                        * A line whose first field is not a valid time-\n"
+    "                          stamp is regarded as a continuation of the\n"
+    "                          previous line (e.g. a stack trace in a log).\n"
+    "                          So, it passes through when the previous line\n"
+    "                          does.\n"
+    "                        * When the file is a regular file, this command\n"
+    "                          does not read the whole file but finds the\n"
+    "                          top of the range by binary search backward\n"
+    "                          from the end of the memory-mapped file, and\n"
+    "                          sends the lines in the range at once.\n"
+    "                        * Otherwise, this command keeps only the lines\n"
+    "                          in the range while reading. So, the memory\n"
+    "                          it uses depends on the size of the range,\n"
+    "                          not on the size of the whole data. In the\n"
+    "                          pattern (c) to (f), the lines are sent as\n"
+    "                          soon as the first line in the range comes.\n"
+    "Options : -c,-e,-I,-z . Specify the format for timestamp and -t option\n"
+    "                        parameter. You can choose one of the following.\n"
+    "                          -c ... \"YYYYMMDDhhmmss[.n]\" (default)\n"
+    "                                 Calendar time (standard time) in your\n"
+    "                                 timezone (\".n\" is the digits under\n"
+    "                                 second. You can specify up to nano\n"
+    "                                 second.)\n"
+    "                          -e ... \"[+|-]n[.n]\"\n"
+    "                                 The number of seconds since the UNIX\n"
+    "                                 epoch (\".n\" is the same as -c)\n"
+    "                          -I ... \"YYYY-MM-DDThh:mm:ss[,n][{{+|-}hh:mm|Z}]"
+                                                                          "\"\n"
+    "                                 Ext. ISO 8601 formatted time in your\n"
+    "                                 timezone (\".n\" is the same as -c)\n"
+    "                          -z ... \"[+|-]n[.n]\"\n"
+    "                                 The number of seconds since this\n"
+    "                                 command has started (\".n\" is the same\n"
+    "                                 as -c)\n"
+    "          -i interval . This is one of options to specify the timestamp\n"
+    "                        range. (See the pattern (a) to (d) above)\n"
+    "                        You can use the format \"A[.B][u]\" as the\n"
+    "                        option's parameter \"interval.\"\n"
+    "                          \"A\" is the integer part of the time.\n"
+    "                          \"B\" is the decimal part of the time.\n"
+    "                          \"u\" is the unit for the time. You can choose\n"
+    "                              one of the followings.\n"
+    "                              \"s\", \"ms\", \"us\" and \"ns.\"\n"
+    "          -t date-and-time\n"
+    "                        This is one of options to specify the timestamp\n"
+    "                        range. (See the pattern (e) and (f) above)\n"
+    "                        The format of \"date-and-time\" depends on\n"
+    "                        which of the option \"-c\", \"-e,\" \"-I\" or \"-z\"\n"
+    "                        you choose.\n"
+    "                          \"-c\" ... \"YYYYMMDDhhmmss[.n]\" (cal. time)\n"
+    "                          \"-e\" ... \"n[.n]\" (UNIX time)\n"
+    "                          \"-I\" ... \"YYYY-MM-DDThh:mm:ss[,n]\" (ISO 8601)\n"
+    "                          \"-z\" ... \"n[.n]\" (the number of seconds)\n"
+    "          -q .......... Suppresses printing filenames when two or more\n"
+    "                        files are given.\n"
+    "          -u .......... Set the date in UTC when -c option is set\n"
+    "                        (same as that of date command)\n"
+    "          -x .......... An additional option for -i and -t. It will\n"
+    "                        exclude the endpoint itself from the range.\n"
+    "                        (See the pattern (b), (d) and (f) above)\n"
+    "          -Z .......... Measure the interval of the \"-i +\" option from\n"
+    "                        the time of the first line of each file instead\n"
+    "                        of the command start time.\n"
+    "                        For instance, \"-Z -i +5\" drops the first five\n"
+    "                        seconds of each file.\n"
+    "Version : 2026-10-18 22:40:05 JST\n"
+    "          (POSIX C language)\n"
+    "\n"
+    "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
+    "This is public domain software. (CC0)\n"
+    "\n"
+    "The latest version is distributed at the following page.\n"
+    "https://github.com/ShellShoccar-jpn/tokideli\n"
+    ,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname,gpszCmdname);
+  exit(1);
+}
+
+/*--- print warning message ----------------------------------------*/
+void warning(const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr, szFormat, va);
+  va_end(va);
+  return;
+}
+
+/*--- exit with error message --------------------------------------*/
+void error_exit(int iErrno, const char* szFormat, ...) {
+  va_list va;
+  va_start(va, szFormat);
+  fprintf(stderr,"%s: ",gpszCmdname);
+  vfprintf(stderr, szFormat, va);
+  va_end(va);
+  exit(iErrno);
+}
+
+
+/*####################################################################
+# Main
+####################################################################*/
+
+/*=== Initialization ===============================================*/
+int main(int argc, char *argv[]) {
+
+/*--- Variables ----------------------------------------------------*/
+int      iPrnhdr;         /* 1:Print 2 or more filenames 0:none           */
+char     szOptbuf[OPT_PARM_BUF];
+int      iRet;            /* return code                                  */
+char    *pszPath;         /* filepath on arguments                        */
+char    *pszFilename;     /* filepath (for message)                       */
+int      iFileno;         /* file# of filepath                            */
+int      iFd;             /* file descriptor                              */
+int      i;               /* all-purpose int                              */
+
+/*--- Initialize ---------------------------------------------------*/
+if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+  error_exit(errno,"clock_gettime() at initialize: %s\n",strerror(errno));
+}
+gpszCmdname = argv[0];
+for (i=0; *(gpszCmdname+i)!='\0'; i++) {
+  if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
+}
+if (setenv("POSIXLY_CORRECT","1",1) < 0) {
+  error_exit(errno,"setenv() at initialization: \n", strerror(errno));
+}
+setlocale(LC_CTYPE, "");
+
+/*=== Parse arguments ==============================================*/
+
+/*--- Set default parameters of the arguments ----------------------*/
+giTfmt    = 0; /* 0:"-c"(default) 1:"-e" 2:"-z" 3:"-I" */
+giMode    = 0; /* 1:interval(-i) 2:time(-t)            */
+giL1zero  = 0; /* 0:The 0-time is based on the time the command begins
+                  1:The 0-time is based on the time 1st line comes     */
+giEndp    = 1; /* 0:Exclude the time range endpoint
+                  1:Include the time range endpoint (default)          */
+giFromtop = 0; /* 1:The interval starts from the top 0:from the end    */
+iPrnhdr   = 1; /* 1:Print 2 or more filenames 0:none                   */
+giVerbose = 0;
+
+/*--- Parse and validate options -----------------------------------*/
+if (argc<2) {print_usage_and_exit();}
+while ((i=getopt(argc, argv, "ceIhi:qt:uvxzZ")) != -1) {
+  switch (i) {
+    case 'u': (void)setenv("TZ", "UTC0", 1); break;
+    case 'c': giTfmt   = 0;                  break;
+    case 'e': giTfmt   = 1;                  break;
+    case 'z': giTfmt   = 2;                  break;
+    case 'I': giTfmt   = 3;                  break;
+    case 'Z': giL1zero = 1;                  break;
+    case 'x': giEndp   = 0;                  break;
+    case 'i': if (*optarg=='+') {giFromtop = 1; optarg++;}
+              else              {giFromtop = 0;          }
+              gi8Interval = parse_periodictime(optarg);
+              if (gi8Interval<0) {print_usage_and_exit();}
+              giMode = 1;                    break;
+    case 't': giMode = 2;
+              if (strlen(optarg)>=OPT_PARM_BUF) {
+                error_exit(1,"date-and-time for the \"-t\" is too long\n");
+              }
+              strcpy(szOptbuf, optarg);      break;
+    case 'q': iPrnhdr  = 0;                  break;
+    case 'v': giVerbose++;                   break;
+    case 'h': print_usage_and_exit();
+    default : print_usage_and_exit();
+  }
+}
+argc -= optind;
+argv += optind;
+if (argc     <2) {iPrnhdr=0;}
+if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
+switch (giMode) {
+  case  1: break;
+  case  2: switch (giTfmt) {
+             case 0 : i = parse_calendartime(szOptbuf, &gtsTime); break;
+             case 3 : i = parse_iso8601time( szOptbuf, &gtsTime); break;
+             default: i = parse_unixtime(    szOptbuf, &gtsTime); break;
+           }
+           if (! i) {
+             error_exit(1,"%s: The string for \"-t\" does not match the "
+                          "timestamp format. See usage.\n", szOptbuf     );
+           }
+           break;
+  default: error_exit(1,"Either \"-i\" or \"-t\" option is required\n");
+}
+
+/*=== Each file loop ===============================================*/
+iRet    =  0;
+iFileno =  0;
+iFd     = -1;
+while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
+
+  /*--- Open one of the input files --------------------------------*/
+  if (pszPath == NULL || strcmp(pszPath, "-") == 0) {
+    pszFilename = "stdin"                ;
+    iFd         = STDIN_FILENO           ;
+  } else                                            {
+    pszFilename = pszPath                ;
+    while ((iFd=open(pszPath, O_RDONLY)) < 0) {
+      if (errno == EINTR) {continue;}
+      iRet = 1;
+      warning("%s: %s\n", pszFilename, strerror(errno));
+      break;
+    }
+    if (iFd < 0) {iFileno++; continue;}
+  }
+
+  /*--- Print the filename if required -----------------------------*/
+  if (iPrnhdr) {
+    if (printf("%s==> %s <==\n",(iFileno>0)?"\n":"",pszFilename) < 0) {
+      error_exit(errno,"printf() in main(): %s\n",strerror(errno));
+    }
+    if (fflush(stdout) == EOF) {
+      error_exit(errno,"fflush() in main(): %s\n",strerror(errno));
+    }
+  }
+
+  /*--- Send the lines in the range --------------------------------*/
+  if (tail_mmapped_file(iFd) != 0) {
+    if (tail_streamed_file(iFd) != 0) {
+      warning("%s: File access error, skip it\n", pszFilename);
+      iRet = 1;
+    }
+  }
+
+  /*--- Close the input file ---------------------------------------*/
+  if (iFd != STDIN_FILENO) {close(iFd);}
+  iFileno++;
+  if (pszPath == NULL) {break;}
+}
+
+/*=== Finish normally ==============================================*/
+return(iRet);}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Send the lines in the range of a regular file by mmap() ========
+ * The top of the range is found by binary search on the mapping, and
+ * the lines in the range are sent at once, with sendfile() if it is
+ * available. So, only a few pages before the range are read.
+ * [in] iFd : File descriptor of the input file
+ * [ret] 0  : Finished sending the lines
+ *       -1 : Could not do it for the file (Nothing has been read yet.
+ *            Use tail_streamed_file() instead.)                    */
+int tail_mmapped_file(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stFile;  /* stat of the file                          */
+  off_t       otPos;   /* the current offset in the file            */
+  off_t       otMap;   /* the offset the mapping begins at          */
+  char*       pcMap;   /* the mapping                               */
+  size_t      sizMap;  /* size of the mapping                       */
+  const char* pcTop;   /* the top of the data to be read            */
+  const char* pcEnd;   /* the end of the mapped data                */
+  const char* pcCut;   /* the top of the first line in the range    */
+  tmsp        tsBorder;/* the top of the range                      */
+  long        lPgsiz;  /* page size                                 */
+#if defined(__linux) || defined(__linux__)
+  off_t       otOut;   /* the offset for sendfile()                 */
+  size_t      siz;
+  ssize_t     ss;
+#endif
+
+  /*--- Is it possible? --------------------------------------------*/
+  if (fstat(iFd,&stFile)  < 0                ) {return -1;}
+  if (! S_ISREG(stFile.st_mode)              ) {return -1;}
+  if ((otPos=lseek(iFd,0,SEEK_CUR)) < 0      ) {return -1;}
+  if ((lPgsiz=sysconf(_SC_PAGESIZE)) < 1     ) {return -1;}
+  if (stFile.st_size <= otPos                ) {return  0;}
+  otMap  = otPos - otPos%lPgsiz;
+  if ((uintmax_t)(stFile.st_size-otMap) > (uintmax_t)SIZE_MAX) {return -1;}
+
+  /*--- Map the rest of the file -----------------------------------*/
+  sizMap = (size_t)(stFile.st_size-otMap);
+  pcMap  = mmap(NULL,sizMap,PROT_READ,MAP_SHARED,iFd,otMap);
+  if (pcMap == MAP_FAILED) {
+    if (giVerbose>0) {warning("mmap(): %s\n",strerror(errno));}
+    return -1;
+  }
+  posix_madvise(pcMap, sizMap, POSIX_MADV_RANDOM);
+  pcTop = pcMap + (otPos-otMap);
+  pcEnd = pcMap + sizMap;
+
+  /*--- Find the top of the range ----------------------------------*/
+  if (get_border(pcTop, pcEnd, &tsBorder)) {
+    pcCut = find_top(pcTop, pcEnd, &tsBorder);
+  } else {
+    pcCut = pcTop; /* no valid timestamp, so all are continuations */
+  }
+  if (giVerbose>0) {
+    warning("%lld of %lld bytes are in the range\n",
+            (long long)(pcEnd-pcCut), (long long)(pcEnd-pcTop));
+  }
+
+  /*--- Send the lines in the range --------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  otOut = otPos + (off_t)(pcCut-pcTop);
+  siz   = (size_t)(pcEnd-pcCut);
+  while (siz > 0) {
+    ss = sendfile(STDOUT_FILENO, iFd, &otOut, siz);
+    if (ss > 0                 ) {siz -= (size_t)ss; continue;}
+    if (ss < 0 && errno==EINTR ) {continue;}
+    if (ss < 0 && giVerbose>0  ) {warning("sendfile(): %s\n",strerror(errno));}
+    break; /* The rest is sent by write() */
+  }
+  write_all(pcEnd-siz, siz);
+#else
+  write_all(pcCut, (size_t)(pcEnd-pcCut));
+#endif
+
+  /*--- Finish -----------------------------------------------------*/
+  munmap(pcMap, sizMap);
+  if (lseek(iFd,0,SEEK_END) < 0) {
+    error_exit(errno,"lseek() in tail_mmapped_file(): %s\n",strerror(errno));
+  }
+  return 0;
+}
+
+/*=== Send the lines in the range of a stream ========================
+ * The stream is read by the chunk into the arena, and the timestamps
+ * and the offsets of the lines are appended to the line index. Then,
+ * the lines before the range are dropped from the top of the both by
+ * looking at the index, which is in time order. So, the arena holds
+ * only the lines in the range (and the one being read).
+ * When the top of the range is fixed, which is except the pattern (a)
+ * and (b), the rest of the stream is sent through as it is as soon as
+ * the first line in the range comes.
+ * [in] iFd : File descriptor of the input file
+ * [ret] 0  : Finished sending the lines
+ *       1  : File access error                                     */
+int tail_streamed_file(int iFd) {
+
+  /*--- Variables --------------------------------------------------*/
+  char*       pcBuf;    /* the arena                                */
+  size_t      sizBuf;   /* size of the arena                        */
+  size_t      sizTop;   /* offset of the data to be kept            */
+  size_t      sizScan;  /* offset of the line not indexed yet       */
+  size_t      sizDat;   /* size of the data in the arena            */
+  lidx_t*     plIdx;    /* the line index                           */
+  size_t      sizIdx;   /* the capacity of the line index           */
+  size_t      sizIhead; /* the oldest entry in the line index       */
+  size_t      sizItail; /* the next of the latest entry             */
+  const char* pc;       /* the top of the current line              */
+  const char* pcNext;   /* the top of the next line                 */
+  const char* pcEnd;    /* the end of the data in the arena         */
+  tmsp        tsBorder; /* the top of the range                     */
+  tmsp        tsTime;   /* the time of the current line             */
+  int         iBorder;  /* 1 if tsBorder has been fixed             */
+  int         iSeen;    /* 1 if a valid line has come               */
+  int         iEof;     /* 1 if the stream came to EOF              */
+  int         iRet;
+  size_t      siz;
+  ssize_t     ss;
+
+  /*--- Prepare the arena and the line index -----------------------*/
+  sizBuf = READ_BUF;
+  if ((pcBuf=(char*)malloc(sizBuf)) == NULL) {
+    error_exit(errno,"malloc() in tail_streamed_file(): %s\n",strerror(errno));
+  }
+  sizIdx = LIDX_NUM;
+  if ((plIdx=(lidx_t*)malloc(sizIdx*sizeof(lidx_t))) == NULL) {
+    error_exit(errno,"malloc() in tail_streamed_file(): %s\n",strerror(errno));
+  }
+  sizTop   = 0;
+  sizScan  = 0;
+  sizDat   = 0;
+  sizIhead = 0;
+  sizItail = 0;
+  iSeen    = 0;
+  iRet     = 0;
+  iBorder  = 0;
+  if (giMode==2 || (giFromtop && !giL1zero)) {
+    get_border(NULL, NULL, &tsBorder);
+    iBorder = 1;
+  }
+
+  /*--- Read and keep the lines in the range (loop) ----------------*/
+  while (1) {
+    /* 1) Make room in the arena (drop the lines before the range, or
+          enlarge it when they are not so many)                       */
+    if (sizDat == sizBuf) {
+      if (sizTop >= sizBuf/2) {
+        memmove(pcBuf, pcBuf+sizTop, sizDat-sizTop);
+        for (siz=sizIhead; siz<sizItail; siz++) {plIdx[siz].sizOfs-=sizTop;}
+        sizScan -= sizTop;
+        sizDat  -= sizTop;
+        sizTop   = 0;
+      } else {
+        if ((pcBuf=(char*)realloc(pcBuf,sizBuf*2)) == NULL) {
+          error_exit(errno,"realloc() in tail_streamed_file(): %s\n",
+                     strerror(errno));
+        }
+        sizBuf *= 2;
+      }
+    }
+    /* 2) Read the next chunk */
+    ss = read(iFd, pcBuf+sizDat, sizBuf-sizDat);
+    if (ss < 0) {
+      if (errno == EINTR) {continue;}
+      if (giVerbose>0) {warning("read(): %s\n",strerror(errno));}
+      iRet = 1; break;
+    }
+    sizDat += (size_t)ss;
+    iEof    = (ss == 0);
+    /* 3) Index the lines in the chunk */
+    pcEnd = pcBuf + sizDat;
+    for (pc=pcBuf+sizScan; pc<pcEnd; pc=pcNext) {
+      pcNext = next_line(pc, pcEnd);
+      if (pcNext[-1]!='\n' && !iEof) {break;} /* incomplete line */
+      sizScan = (size_t)(pcNext-pcBuf);
+      if (! get_line_time(pc, pcNext, &tsTime)) {
+        /* A continuation of the line which has already been dropped */
+        if (iSeen && sizIhead==sizItail) {sizTop = sizScan;}
+        continue;
+      }
+      iSeen = 1;
+      if (giMode==1 && !giFromtop) {
+        tsBorder = tsTime; tmsp_add(&tsBorder, -gi8Interval);
+      } else if (! iBorder) {
+        tsBorder = tsTime; tmsp_add(&tsBorder,  gi8Interval);
+        iBorder  = 1;
+      }
+      if (sizItail == sizIdx) {
+        if (sizIhead >= sizIdx/2) {
+          memmove(plIdx, plIdx+sizIhead, (sizItail-sizIhead)*sizeof(lidx_t));
+          sizItail -= sizIhead;
+          sizIhead  = 0;
+        } else {
+          if ((plIdx=(lidx_t*)realloc(plIdx,sizIdx*2*sizeof(lidx_t)))==NULL) {
+            error_exit(errno,"realloc() in tail_streamed_file(): %s\n",
+                       strerror(errno));
+          }
+          sizIdx *= 2;
+        }
+      }
+      plIdx[sizItail].sizOfs = (size_t)(pc-pcBuf);
+      plIdx[sizItail].tsTime = tsTime;
+      sizItail++;
+    }
+    /* 4) Drop the lines before the range */
+    if (iSeen) {
+      while (sizIhead<sizItail
+             && is_before_range(&plIdx[sizIhead].tsTime, &tsBorder)) {
+        sizIhead++;
+        sizTop = (sizIhead<sizItail) ? plIdx[sizIhead].sizOfs : sizScan;
+      }
+    }
+    if (sizIhead == sizItail) {sizIhead = sizItail = 0;}
+    /* 5) Once the line in the range has come with the fixed top,
+          send all the rest as they are                               */
+    if (giFromtop || giMode==2) {
+      if (sizIhead < sizItail) {
+        write_all(pcBuf+sizTop, sizDat-sizTop);
+        while (1) {
+          ss = read(iFd, pcBuf, sizBuf);
+          if (ss == 0) {break;}
+          if (ss <  0) {
+            if (errno == EINTR) {continue;}
+            if (giVerbose>0) {warning("read(): %s\n",strerror(errno));}
+            iRet = 1; break;
+          }
+          write_all(pcBuf, (size_t)ss);
+        }
+        break;
+      }
+    }
+    /* 6) At the end of the stream, send the lines in the range */
+    if (iEof) {
+      if (iSeen) {write_all(pcBuf+sizTop, sizDat-sizTop);}
+      else       {write_all(pcBuf       , sizDat       );}
+      break;
+    }
+  }
+
+  /*--- Finish -----------------------------------------------------*/
+  free(plIdx);
+  free(pcBuf);
+  return iRet;
+}
+
+/*=== Get the top of the range =======================================
+ * [in]  pcTop,pcEnd : The data (the top and the end) to look for the
+ *                     first or the last line in if it is required
+ *       giMode, giFromtop, giL1zero, gi8Interval, gtsTime, gtsZero
+ * [out] ptsBorder   : The top of the range
+ * [ret] 1 : Succeeded
+ *       0 : Failed because the data have no valid timestamp        */
+int get_border(const char *pcTop, const char *pcEnd, tmsp *ptsBorder) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char* pc;
+  const char* pc1;
+
+  /*--- Pattern (e),(f): The date-and-time itself ------------------*/
+  if (giMode == 2) {*ptsBorder = gtsTime; return 1;}
+
+  /*--- Pattern (c),(d): From the top ------------------------------*/
+  if (giFromtop) {
+    if (giL1zero) {
+      for (pc=pcTop; pc<pcEnd; pc=next_line(pc,pcEnd)) {
+        if (get_line_time(pc, pcEnd, ptsBorder)) {break;}
+      }
+      if (pc >= pcEnd) {return 0;}
+    } else if (giTfmt == 2) {
+      ptsBorder->tv_sec  = 0;
+      ptsBorder->tv_nsec = 0;
+    } else {
+      *ptsBorder = gtsZero;
+    }
+    tmsp_add(ptsBorder,  gi8Interval);
+    return 1;
+  }
+
+  /*--- Pattern (a),(b): From the last line ------------------------*/
+  pc = pcEnd;
+  while (pc > pcTop) {
+    /* Find the top of the line before pc */
+    pc1 = pc - 1;
+    while (pc1>pcTop && pc1[-1]!='\n') {pc1--;}
+    if (get_line_time(pc1, pc, ptsBorder)) {
+      tmsp_add(ptsBorder, -gi8Interval);
+      return 1;
+    }
+    pc = pc1;
+  }
+  return 0;
+}
+
+/*=== Find the first line in the range by binary search ==============
+ * [in] pcTop,pcEnd : The data (the top and the end)
+ *      ptsBorder   : The top of the range
+ * [ret] The top of the first line which has a valid timestamp and is
+ *       in the range (pcEnd if no line is in the range). However, it
+ *       is pcTop when the line is the first valid one, so that the
+ *       lines before it are also sent.                             */
+const char* find_top(const char *pcTop, const char *pcEnd,
+                     const tmsp *ptsBorder                ) {
+
+  /*--- Variables --------------------------------------------------*/
+  const char* pcLo;  /* all the lines before it are before the range*/
+  const char* pcHi;  /* no valid line from it to pcCut              */
+  const char* pcCut; /* the first line in the range found so far    */
+  const char* pcMid;
+  const char* pc;
+  tmsp        tsTime;
+
+  /*--- Binary search ----------------------------------------------*/
+  pcLo  = pcTop;
+  pcHi  = pcEnd;
+  pcCut = pcEnd;
+  while (pcLo < pcHi) {
+    pcMid = pcLo + (pcHi-pcLo)/2;
+    /* Look for the first valid line which begins in [pcMid,pcHi) */
+    pc = (pcMid==pcTop || pcMid[-1]=='\n') ? pcMid : next_line(pcMid,pcEnd);
+    for (; pc<pcHi; pc=next_line(pc,pcEnd)) {
+      if (get_line_time(pc, pcEnd, &tsTime)) {break;}
+    }
+    if      (pc >= pcHi                            ) {pcHi=pcMid;            }
+    else if (! is_before_range(&tsTime, ptsBorder)) {pcHi=pcMid; pcCut=pc;}
+    else                                           {pcLo=next_line(pc,pcEnd);}
+  }
+
+  /*--- Is it the first valid line? --------------------------------*/
+  if (pcCut < pcEnd) {
+    for (pc=pcTop; pc<pcCut; pc=next_line(pc,pcEnd)) {
+      if (get_line_time(pc, pcEnd, &tsTime)) {break;}
+    }
+    if (pc == pcCut) {pcCut = pcTop;}
+  }
+
+  /*--- Return -----------------------------------------------------*/
+  return pcCut;
+}
+
+/*=== Get the top of the next line ===================================
+ * [in] pc    : A pointer in the current line
+ *      pcEnd : The end of the data
+ * [ret] The top of the next line (pcEnd if it is the last one)     */
+const char* next_line(const char *pc, const char *pcEnd) {
+  const char* pcLf;
+  if (pc >= pcEnd) {return pcEnd;}
+  pcLf = memchr(pc, '\n', (size_t)(pcEnd-pc));
+  return (pcLf) ? pcLf+1 : pcEnd;
+}
+
+/*=== Get the time of the line by its 1st field ======================
+ * [in]  pc      : The top of the line
+ *       pcEnd   : The end of the data (or the line)
+ *       giTfmt  : The format of the timestamp
+ * [out] ptsTime : The time of the line
+ * [ret] 1 : The line has a valid timestamp
+ *       0 : The line does not have a valid one                     */
+int get_line_time(const char *pc, const char *pcEnd, tmsp *ptsTime) {
+
+  /*--- Variables --------------------------------------------------*/
+  char szTime[TS_FIELD_MAX+1];
+  int  i;
+
+  /*--- Copy the 1st field to terminate it -------------------------*/
+  for (i=0; pc+i<pcEnd && i<=TS_FIELD_MAX; i++) {
+    if (pc[i]==' ' || pc[i]=='\t' || pc[i]=='\n') {break;}
+    if (i == TS_FIELD_MAX                       ) {return 0;}
+    szTime[i] = pc[i];
+  }
+  if (i == 0) {return 0;}
+  szTime[i] = '\0';
+
+  /*--- Parse it ---------------------------------------------------*/
+  switch (giTfmt) {
+    case 0 : return parse_calendartime(szTime, ptsTime);
+    case 3 : return parse_iso8601time( szTime, ptsTime);
+    default: return parse_unixtime(    szTime, ptsTime);
+  }
+}
+
+/*=== Is the time before the range? ==================================
+ * [in] ptsTime   : The time of the line
+ *      ptsBorder : The top of the range
+ *      giEndp    : Including the endpoint or not (1:include)
+ * [ret] 1 : before the range
+ *       0 : in the range                                           */
+int is_before_range(const tmsp *ptsTime, const tmsp *ptsBorder) {
+  if (ptsTime->tv_sec  != ptsBorder->tv_sec ) {
+    return (ptsTime->tv_sec  < ptsBorder->tv_sec );
+  }
+  if (ptsTime->tv_nsec != ptsBorder->tv_nsec) {
+    return (ptsTime->tv_nsec < ptsBorder->tv_nsec);
+  }
+  return (giEndp == 0);
+}
+
+/*=== Parse the periodic time ========================================
+ * [ret] >= 0  : Interval value (in nanosecound)
+ *       <=-1  : (undefined)
+ *       <=-2  : It is not a value                                  */
+int64_t parse_periodictime(char *pszArg) {
+
+  /*--- Variables --------------------------------------------------*/
+  char   szUnit[OPT_PARM_BUF];
+  double dNum;
+
+  /*--- Check the lengths of the argument --------------------------*/
+  if (strlen(pszArg) >= OPT_PARM_BUF) {return -2;}
+
+  /*--- Try to interpret the argument as "<value>"[+"unit"] --------*/
+  switch (sscanf(pszArg, "%lf%s", &dNum, szUnit)) {
+    case   2:                      break;
+    case   1: strcpy(szUnit, "s"); break;
+    default : return -2;
+  }
+  if (dNum < 0                     ) {return -2;}
+
+  /* as a second value */
+  if (strcmp(szUnit, "s" )==0) {
+    if (dNum > ((double)INT_MAX             )) {return -2;}
+    return       (int64_t)(dNum * 1000000000);
+  }
+
+  /* as a millisecond value */
+  if (strcmp(szUnit, "ms")==0) {
+    if (dNum > ((double)INT_MAX *       1000)) {return -2;}
+    return       (int64_t)(dNum *    1000000);
+  }
+
+  /* as a microsecond value */
+  if (strcmp(szUnit, "us")==0) {
+    if (dNum > ((double)INT_MAX *    1000000)) {return -2;}
+    return       (int64_t)(dNum *       1000);
+  }
+
+  /* as a nanosecond value */
+  if (strcmp(szUnit, "ns")==0) {
+    if (dNum > ((double)INT_MAX * 1000000000)) {return -2;}
+    return       (int64_t)(dNum *          1);
+  }
+
+  /*--- Otherwise, it is not a value -------------------------------*/
+  return -2;
+}
+
+/*=== Write the whole data into the stdout ===========================
+ * [in] pc  : The data
+ *      siz : The size of the data                                  */
+void write_all(const char *pc, size_t siz) {
+
+  ssize_t ss;
+
+  while (siz > 0) {
+    ss = write(STDOUT_FILENO, pc, siz);
+    if (ss < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"write() to the stdout: %s\n",strerror(errno));
+    }
+    pc  += ss;
+    siz -= (size_t)ss;
+  }
+}
+
+/*=== Add nanoseconds to a timespec ==================================
+ * [in/out] pts    : The time to be added to
+ * [in]     i8Nsec : Nanoseconds to add (can be negative)           */
+void tmsp_add(tmsp *pts, int64_t i8Nsec) {
+  pts->tv_sec  += (time_t)(i8Nsec / 1000000000);
+  pts->tv_nsec +=   (long)(i8Nsec % 1000000000);
+  if      (pts->tv_nsec >= 1000000000) {pts->tv_sec++; pts->tv_nsec-=1000000000;}
+  else if (pts->tv_nsec <           0) {pts->tv_sec--; pts->tv_nsec+=1000000000;}
+}
@@ -14,11 +14,27 @@
 #                      to a terminal.
 #           -t str ... Replace the terminator after a bunch with <str>.
 #                      Default is "\n."
+#           -s fmt ... Capture mode: Attach the timestamp taken just
+#                      after each bunch arrived as the first field.
+#                      The output can be replayed by "tscat -y" with
+#                      the same format option, and it needs no more
+#                      "linets" in the pipeline. <fmt> is one of the
+#                      following. (all in nanoseconds)
+#                        c ... "YYYYMMDDhhmmss.n" (for "tscat -yc")
+#                        e ... "n.n"  UNIX epoch  (for "tscat -ye")
+#                        I ... "YYYY-MM-DDThh:mm:ss,n{+|-}hh:mm"
+#                                                 (for "tscat -yI")
+#                        z ... "n.n"  since start (for "tscat -yz")
+#                      A line feed in a bunch is recorded as a line
+#                      with no letters after the timestamp. The -t
+#                      option cannot be used with this option.
+#           -u ....... Set the date in UTC when "-s c" is set
+#                      (same as that of date command)
 # Retuen  : 0 only when finished successfully
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2024-06-23
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -40,19 +56,32 @@
 /*--- macro constants ----------------------------------------------*/
 #define BLKSIZE 8192
 #define TRMSIZE  128
+#define TSSIZE    48 /* max size of a timestamp field with the delimiter */
 /*--- headers ------------------------------------------------------*/
 #include <errno.h>
+#include <inttypes.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
+#include <time.h>
+#include "timeio.h"
 #include <unistd.h>
+/*--- data type definitions ----------------------------------------*/
+typedef struct timespec tmsp;
+/*--- prototype functions ------------------------------------------*/
+void write_all(char *pszBuf, int iLen);
+void write_stamped_bunch(char *pszBuf, int iLen, tmsp *ptsArrived);
+int  sprint_timestamp(char *pszTs, tmsp *ptsArrived);
 /*--- global variables ---------------------------------------------*/
 char*            gpszCmdname;       /* The name of this command       */
 struct termios   gstTerms1st = {0};
 char             gszBuf[BLKSIZE+1];
+char             gszOut[(BLKSIZE+1)*(TSSIZE+1)]; /* for the capture mode */
+int              giStampFmt  =  0 ; /* 0:no stamp, 'c','e','I','z'    */
+tmsp             gtsZero     = {0}; /* Time this command booted       */
 struct sigaction gsaExit;           /* To resume terminal conf before exit */
 int              giVerbose;         /* greater number, more verbosely */
 
@@ -72,8 +101,24 @@ void print_usage_and_exit(void) {
     "                     to a terminal.\n"
     "          -t str ... Replace the terminator after a bunch with <str>.\n"
     "                     Default is \"\n.\"\n"
+    "          -s fmt ... Capture mode: Attach the timestamp taken just\n"
+    "                     after each bunch arrived as the first field.\n"
+    "                     The output can be replayed by \"tscat -y\" with\n"
+    "                     the same format option, and it needs no more\n"
+    "                     \"linets\" in the pipeline. <fmt> is one of the\n"
+    "                     following. (all in nanoseconds)\n"
+    "                       c ... \"YYYYMMDDhhmmss.n\" (for \"tscat -yc\")\n"
+    "                       e ... \"n.n\"  UNIX epoch  (for \"tscat -ye\")\n"
+    "                       I ... \"YYYY-MM-DDThh:mm:ss,n{+|-}hh:mm\"\n"
+    "                                                (for \"tscat -yI\")\n"
+    "                       z ... \"n.n\"  since start (for \"tscat -yz\")\n"
+    "                     A line feed in a bunch is recorded as a line\n"
+    "                     with no letters after the timestamp. The -t\n"
+    "                     option cannot be used with this option.\n"
+    "          -u ....... Set the date in UTC when \"-s c\" is set\n"
+    "                     (same as that of date command)\n"
     "Retuen  : 0 only when finished successfully\n"
-    "Version : 2024-06-23 13:28:01 JST\n"
+    "Version : 2026-10-18 19:04:18 JST\n"
     "          (POSIX C language with \"POSIX centric\" programming)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -128,25 +173,30 @@ void interrupted_trap(int iSig, siginfo_t *siInfo, void *pct) {
 /*=== Initialization ===============================================*/
 int main(int argc, char *argv[]) {
 /*--- Variables ----------------------------------------------------*/
-int            iIgnCtrlD, iNumofbunches, iSize_trm, iEchomode;
+int            iIgnCtrlD, iNumofbunches, iSize_trm, iEchomode, iOpt_t;
 char           szTrm[TRMSIZE];
 int            iSize_r, iSize_w, iOffset, iRemain, i;
 struct termios stTerms;
+tmsp           tsArrived;
 /*--- Initialize ---------------------------------------------------*/
 gpszCmdname = argv[0];
 for (i=0; *(gpszCmdname+i)!='\0'; i++) {
   if (*(gpszCmdname+i)=='/') {gpszCmdname=gpszCmdname+i+1;}
 }
+if (clock_gettime(CLOCK_REALTIME,&gtsZero) != 0) {
+  error_exit(errno,"clock_gettime()#%d: %s\n", __LINE__, strerror(errno));
+}
 
 /*=== Parse arguments ==============================================*/
 /*--- Set default parameters of the arguments ----------------------*/
 iIgnCtrlD     =  0;
 iEchomode     =  0;
 iNumofbunches = -1;
+iOpt_t        =  0;
 strcpy(szTrm,"\n");
 iSize_trm     =  strlen(szTrm);
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "1den:t:vh")) != -1) {
+while ((i=getopt(argc, argv, "1den:s:t:uvh")) != -1) {
   switch (i) {
     case '1': iNumofbunches = 1;                 break;
     case 'd': iIgnCtrlD     = 1;                 break;
@@ -158,7 +208,13 @@ while ((i=getopt(argc, argv, "1den:t:vh")) != -1) {
                 error_exit(1,"<str> of the -t option must be within %d.\n",
                            TRMSIZE-1                                       );
               }
-              strcpy(szTrm,optarg); iSize_trm=i; break;
+              strcpy(szTrm,optarg); iSize_trm=i; iOpt_t=1;
+                                                 break;
+    case 's': if (strlen(optarg)!=1 || strchr("ceIz",optarg[0])==NULL) {
+                print_usage_and_exit();
+              }
+              giStampFmt    = optarg[0];         break;
+    case 'u': (void)setenv("TZ", "UTC", 1);      break;
     case 'v': giVerbose++;                       break;
     default : print_usage_and_exit();
   }
@@ -168,6 +224,9 @@ argv += optind  ;
 if (giVerbose>1) {warning("verbose mode (level %d)\n",giVerbose);}
 if (giVerbose>0 && iIgnCtrlD) {warning("[Ctrl]+[D] will be ignored.\n");}
 if (argc>1) {print_usage_and_exit();}
+if (giStampFmt && iOpt_t) {
+  error_exit(1,"The -s and -t options cannot be used together.\n");
+}
 if (iNumofbunches==0) {return 0;}
 
 /*=== Do the same as the cat command if STDIN isn't connected a terminal */
@@ -177,6 +236,13 @@ if (isatty(STDIN_FILENO)==0) {
     warning("This command will work at the same as the cat command.\n");
   }
   while ((iRemain=(int)read(STDIN_FILENO,gszBuf,BLKSIZE))>0) {
+    if (giStampFmt) {
+      if (clock_gettime(CLOCK_REALTIME,&tsArrived) != 0) {
+        error_exit(errno,"clock_gettime()#%d: %s\n",__LINE__,strerror(errno));
+      }
+      write_stamped_bunch(gszBuf, iRemain, &tsArrived);
+      continue;
+    }
     for (iOffset=0; iRemain>0; iRemain-=iSize_w) {
       if ((iSize_w=(int)write(STDOUT_FILENO,gszBuf+iOffset,iRemain))<0) {
         error_exit(errno,"write()#%d: %s\n", __LINE__, strerror(errno));
@@ -227,8 +293,21 @@ if (tcsetattr(STDIN_FILENO, TCSANOW, &stTerms)     < 0) {
 /*=== Main loop ====================================================*/
 iNumofbunches--;
 while ((iSize_r=(int)read(STDIN_FILENO,gszBuf,BLKSIZE+1))>0) {
+  /*--- Get the arrival time as soon as possible (capture mode) ----*/
+  if (giStampFmt) {
+    if (clock_gettime(CLOCK_REALTIME,&tsArrived) != 0) {
+      error_exit(errno,"clock_gettime()#%d: %s\n", __LINE__, strerror(errno));
+    }
+  }
   /*--- If EOT follows the data, make this turn last ---------------*/
   if ((!iIgnCtrlD) && (gszBuf[iSize_r-1]==0x04)) {iNumofbunches=0; iSize_r--;}
+  /*--- Write the data with the timestamp (capture mode) -----------*/
+  if (giStampFmt) {
+    write_stamped_bunch(gszBuf, iSize_r, &tsArrived);
+    if      (iNumofbunches<0) {                 continue;}
+    else if (iNumofbunches>0) {iNumofbunches--; continue;}
+    else                      {                 break   ;}
+  }
   /*--- Write the data into STDOUT ---------------------------------*/
   iRemain=iSize_r;
   for (iOffset=0; iRemain>0; iRemain-=iSize_w) {
@@ -256,3 +335,107 @@ if (iSize_r<0) {error_exit(errno,"read()#%d: %s\n", __LINE__, strerror(errno));}
 
 /*=== Finish normally ==============================================*/
 return 0;}
+
+
+
+/*####################################################################
+# Functions
+####################################################################*/
+
+/*=== Write all the data into STDOUT =================================
+ * [in]  pszBuf : Data to write
+ *       iLen   : Size of the data                                  */
+void write_all(char *pszBuf, int iLen) {
+  int iSize_w;
+  while (iLen > 0) {
+    if ((iSize_w=(int)write(STDOUT_FILENO,pszBuf,iLen))<0) {
+      error_exit(errno,"write()#%d: %s\n", __LINE__, strerror(errno));
+    }
+    pszBuf += iSize_w;
+    iLen   -= iSize_w;
+  }
+}
+
+/*=== Write a bunch with the timestamp (for the capture mode) ========
+ * Every line in the bunch gets the same timestamp. And every LF in the
+ * bunch becomes a line with no letters so that "tscat -y" can restore
+ * it. All the lines are written by one write() as far as possible.
+ * [in]  pszBuf     : The bunch
+ *       iLen       : Size of the bunch
+ *       ptsArrived : The time when the bunch arrived                */
+void write_stamped_bunch(char *pszBuf, int iLen, tmsp *ptsArrived) {
+
+  /*--- Variables --------------------------------------------------*/
+  char  szTs[TSSIZE]; /* timestamp field with the delimiter          */
+  int   iTsLen;       /* length of the szTs                          */
+  char* pszOut;       /* writing position on the gszOut              */
+  char* pszEnd;       /* end of the bunch                            */
+  char* psz;          /* all-purpose char*                           */
+
+  /*--- Make the timestamp field -----------------------------------*/
+  if (iLen <= 0) {return;}
+  iTsLen = sprint_timestamp(szTs, ptsArrived);
+
+  /*--- Assemble the lines -----------------------------------------*/
+  pszOut = gszOut;
+  pszEnd = pszBuf + iLen;
+  while (pszBuf < pszEnd) {
+    memcpy(pszOut, szTs, iTsLen); pszOut += iTsLen;
+    if (*pszBuf == '\n') {
+      pszBuf++;
+    } else {
+      psz = memchr(pszBuf, '\n', pszEnd-pszBuf);
+      if (psz == NULL) {psz=pszEnd;}
+      memcpy(pszOut, pszBuf, psz-pszBuf); pszOut += psz-pszBuf;
+      pszBuf = psz;
+    }
+    *pszOut++ = '\n';
+  }
+
+  /*--- Write them -------------------------------------------------*/
+  write_all(gszOut, (int)(pszOut-gszOut));
+}
+
+/*=== Make the timestamp field string (for the capture mode) =========
+ * [in]  ptsArrived : The time to be printed
+ *       giStampFmt : The format ('c', 'e', 'I' or 'z')
+ * [out] pszTs      : The timestamp and a space (not null-terminated)
+ * [ret] The length of the string                                   */
+int sprint_timestamp(char *pszTs, tmsp *ptsArrived) {
+
+  /*--- Variables --------------------------------------------------*/
+  char      szBuf[TSSIZE+1];
+  char      szDec[12];
+  tmsp      ts;
+  int       i;
+
+  /*--- Print the timestamp ----------------------------------------*/
+  switch (giStampFmt) {
+    case 'c':
+              snprintf(szDec, 12, ".%09ld ", ptsArrived->tv_nsec);
+              i = sprint_calendartime(szBuf, ptsArrived->tv_sec, szDec);
+              if (i<0) {error_exit(255,"localtime(): returned NULL\n");}
+              break;
+    case 'I':
+              snprintf(szDec, 12, ",%09ld", ptsArrived->tv_nsec);
+              i = sprint_iso8601time(szBuf, ptsArrived->tv_sec, szDec);
+              if (i<0) {error_exit(255,"localtime(): returned NULL\n");}
+              szBuf[i++]=' ';
+              break;
+    case 'e':
+              i = snprintf(szBuf, TSSIZE+1, "%jd.%09ld ",
+                    (intmax_t)ptsArrived->tv_sec, ptsArrived->tv_nsec);
+              break;
+    case 'z':
+              ts.tv_sec  = ptsArrived->tv_sec  - gtsZero.tv_sec ;
+              ts.tv_nsec = ptsArrived->tv_nsec - gtsZero.tv_nsec;
+              if (ts.tv_nsec < 0) {ts.tv_sec--; ts.tv_nsec+=1000000000;}
+              i = snprintf(szBuf, TSSIZE+1, "%jd.%09ld ",
+                    (intmax_t)ts.tv_sec, ts.tv_nsec);
+              break;
+    default : error_exit(255,"sprint_timestamp(): Unknown format\n");
+  }
+  if (i<0 || i>TSSIZE) {error_exit(255,"sprint_timestamp(): Too long\n");}
+  memcpy(pszTs, szBuf, i);
+  return i;
+}
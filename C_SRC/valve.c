@@ -2,8 +2,12 @@
 #
 # VALVE - Adjust the Data Transfer Rate in the UNIX Pipeline
 #
-# USAGE   : valve [-c|-l] [-r|-s] [-p n] periodictime [file [...]]
-#           valve [-c|-l] [-r|-s] [-p n] controlfile [file [...]]
+# USAGE   : valve [-c|-l] [-r|-s] [-m statsfile] [-p n] [-L] [-C cpu]
+#                 periodictime [file [...]]
+#           valve [-c|-l] [-r|-s] [-m statsfile] [-p n] [-L] [-C cpu]
+#                 controlfile [file [...]]
+#           valve [-c|-l] [-r|-s] [-m statsfile] [-p n] [-L] [-C cpu]
+#                 -f feedfile
 # Args    : periodictime  Periodic time from start sending the current
 #                         block (means a character or a line) to start
 #                         sending the next block.
@@ -17,6 +21,14 @@
 #                         * output : '0%'   (completely shut the value)
 #                                    '100%' (completely open the value)
 #                         The maximum value is INT_MAX for all units.
+#                         * burst  : Append "/n" to the above to enable
+#                                    the token-bucket mode, e.g. "10ms/50".
+#                                    It lets up to n blocks go at once
+#                                    with a single write when they have
+#                                    been delayed, and the bucket gets a
+#                                    token for every periodic time while
+#                                    no block comes. The recovery and
+#                                    strict modes mean nothing then.
 #           controlfile . Filepath to specify the periodic time instead
 #                         of by argument. You can change the parameter
 #                         even when this command is running by updating
@@ -48,7 +60,30 @@
 #                             modes. The new parameter will be applied
 #                             immediately just after writing.
 #           file ........ Filepath to be send ("-" means STDIN)
-# Options : -c .......... (Default) Changes the periodic unit to
+# Options : -f feedfile . Multi-stream mode
+#                         Serve many feeds in this one process instead of
+#                         running a valve for each feed. Each line of the
+#                         feedfile describes a feed with three fields.
+#                           periodictime|controlfile  inputfile  outputfile
+#                         * The first field is the same as the argument
+#                           of the single-stream mode. A controlfile for
+#                           each feed lets you change the periodic time
+#                           of the feed individually. (SIGHUP makes this
+#                           command read all regular controlfiles now.)
+#                         * "-" means STDIN for an inputfile and STDOUT
+#                           for an outputfile. An outputfile is created
+#                           or truncated.
+#                         * Empty lines and lines beginning with "#" are
+#                           ignored.
+#                         * Files are opened in the order of the lines,
+#                           so a named pipe waits for its peer there.
+#                         * The other options are applied to all feeds.
+#                           In the recovery mode, a feed recovers the
+#                           lost time up to 10 milliseconds.
+#                         This mode uses only one thread. It sleeps until
+#                         the earliest deadline among the feeds with
+#                         watching all of the files by poll().
+#           -c .......... (Default) Changes the periodic unit to
 #                         character. This option defines that the
 #                         periodic time is the time from sending the
 #                         current character to sending the next one.
@@ -58,6 +93,8 @@
 #                         time from sending the top character of the
 #                         current line to sending the top character of
 #                         the next line.
+#                         A line in a regular file is sent from the
+#                         mmap'd file by one write() with no copying.
 #                         -c option will be disabled by this option.
 #           [The following options are for professional]
 #           -r .......... (Default) Recovery mode
@@ -75,6 +112,14 @@
 #                         keep strictly the maximum instantaneous data-
 #                         transfer rate limit decided by periodictime.
 #                         -r option will be disabled by this option.
+#           -m statsfile  Write a snapshot of the live counters (bytes,
+#                         lines, sleeps, oversleeping histogram, etc.)
+#                         into the file every second, when SIGUSR1
+#                         comes, and at exit. A regular file always has
+#                         only the latest one, and a named pipe gets a
+#                         line for each snapshot.
+#                         Without this option, a snapshot is written into
+#                         the stderr only when SIGUSR1 comes.
 #           -p n ........ Process priority setting [0-3] (if possible)
 #                          0: Normal process
 #                          1: Weakest realtime process (default)
@@ -85,6 +130,14 @@
 #                         but if failed, it will try the smaller numbers.
 #                         An administrative privilege might be required to
 #                         use this option.
+#           -L .......... Lock the memory of this command into the RAM
+#                         after pre-faulting the stack, so that no page
+#                         fault delays it in the realtime mode. A large
+#                         enough "ulimit -l" or a privileged user might
+#                         be required.
+#           -C cpu ...... Run this command only on the CPU #cpu (from 0)
+#                         to avoid the migration between CPUs. (for only
+#                         Linux) An isolated CPU gives the best result.
 # Retuen  : Return 0 only when finished successfully
 #
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -pthread -lrt
@@ -98,7 +151,7 @@
 #             follows.
 #               $ gcc -DNOTTY -o valve valve.c
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-01-28
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -119,6 +172,9 @@
 /*=== Initial Setting ==============================================*/
 
 /*--- headers ------------------------------------------------------*/
+#if defined(__linux) || defined(__linux__)
+  #define _GNU_SOURCE /* for sched_setaffinity() */
+#endif
 #include <limits.h>
 #include <errno.h>
 #include <stdio.h>
@@ -131,14 +187,19 @@
 #include <sys/time.h>
 #include <time.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <pthread.h>
 #include <poll.h>
 #include <signal.h>
+#include <setjmp.h>
 #include <locale.h>
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
   #include <sched.h>
   #include <sys/resource.h>
 #endif
+#include "stats.h"
+#include "rtmem.h"
+#include "fpbuf.h"
 
 /*--- macro constants ----------------------------------------------*/
 /* Interval time of looking at the parameter on the control file */
@@ -148,6 +209,13 @@
 #define LINE_BUF 1024
 /* Buffer size for the control file */
 #define CTRL_FILE_BUF 64
+/* Buffer size for each feed in the multi-stream mode */
+#define FEED_BUF 4096
+/* Max delay a feed recovers in the multi-stream mode (in nanosecond) */
+#define FEED_RECOVMAX_NSEC 10000000
+/* State of a feed in the multi-stream mode */
+#define FEED_IDLE 0
+#define FEED_DONE 1
 /* If you set the following definition to 2 or more, recovery mode will be
  * probably more effective. If unnecessary, set 0 to disable this.         */
 #define RECOVMAX_MULTIPLIER 2
@@ -169,6 +237,7 @@ typedef struct _thrcom_t {
   int             iRequested__main; /* Req. received flag (only in mainth)    */
   int             iReceived;        /* Set 1 when the param. has been received*/
   int64_t         i8Param1;         /* int64 variable #1 to sent to the mainth*/
+  int             iParam2;          /* int variable #2 to sent to the mainth  */
 } thcominfo_t;
 typedef struct _thrmain_t {
   pthread_t       tSubth_id;        /* sub thread ID                          */
@@ -176,6 +245,30 @@ typedef struct _thrmain_t {
   int             iCo_isready;      /* Set 1 when co has been initialized     */
   FILE*           fpIn;             /* File handle for the current input file */
 } thmaininfo_t;
+typedef struct _feed_t {
+  char*           pszIn;            /* Input filepath ("-" means stdin)       */
+  char*           pszOut;           /* Output filepath ("-" means stdout)     */
+  char*           pszCtrl;          /* Control filepath (NULL means none)     */
+  int             iFdIn;            /* File descriptor for the input          */
+  int             iFdOut;           /* File descriptor for the output         */
+  int             iFdCtrl;          /* File descriptor for the control file   */
+  int             iCtrltype;        /* 0:none 1:regular 2:FIFO/char-special   */
+  int             iState;           /* FEED_IDLE or FEED_DONE                 */
+  int             iEof;             /* Set 1 when the input reached EOF       */
+  int             iInLine;          /* Set 1 while passing a line through     */
+  int             iHeappos;         /* Position in the heap (-1: not in it)   */
+  int             iWaited;          /* Set 1 if the deadline was in future    */
+  int64_t         i8Peritime;       /* Periodic time (-1 means infinity)      */
+  int             iBurst;           /* Bucket depth (0 means no token-bucket) */
+  tmsp            tsPrev;           /* The time the last unit was released    */
+  tmsp            tsNext;           /* The deadline to release the next unit  */
+  size_t          sizHead;          /* cBuf[sizHead..sizRel) can be written   */
+  size_t          sizRel;           /* cBuf[sizRel..sizTail) is held          */
+  size_t          sizTail;          /* End of the data in cBuf                */
+  char            cBuf[FEED_BUF];   /* Buffer for the data                    */
+  char            szCtrlbuf[CTRL_FILE_BUF]; /* Partial parameter (FIFO ctrl)  */
+  int             iCtrllen;         /* Length of the string in szCtrlbuf      */
+} feed_t;
 
 /*--- prototype functions ------------------------------------------*/
 void* param_updater(void* pvArgs);
@@ -183,17 +276,44 @@ void update_periodic_time_type_r(char* pszCtrlfile);
 #ifndef NOTTY
   void update_periodic_time_type_c(char* pszCtrlfile);
 #endif
-int64_t parse_periodictime(char *pszArg);
+int64_t parse_periodictime(char *pszArg, int *piBurst);
+int64_t parse_periodictime_value(char *pszArg);
 int change_to_rtprocess(int iPrio);
 void spend_my_spare_time(tmsp *ptsPrev);
+void flush_the_blocks(FILE *fpIn);
+void flush_stdout(void);
+int pace_mmapped_lines(FILE *fp, int *piRet_r1l, tmsp *pts1st);
 int read_1line(FILE *fp, tmsp *ptsGet1stchar);
 void do_nothing(int iSig, siginfo_t *siInfo, void *pct);
+void map_truncated(int iSig, siginfo_t *siInfo, void *pct);
 #ifdef __ANDROID__
   void term_this_thread(int iSig, siginfo_t *siInfo, void *pct);
 #endif
 void recv_param_application_req(int iSig, siginfo_t *siInfo, void *pct);
 void mainth_destructor(void* pvMainth);
 void subth_destructor(void *pvFd);
+int run_feeds(char* pszFeedfile, int iUnit, int iMlock);
+int load_feedfile(char* pszFeedfile, feed_t** ppfd);
+void open_feed(feed_t* pf);
+void finish_feed(feed_t* pf, feed_t** ppfHeap, int* piHeapNum);
+void arm_feed(feed_t* pf, feed_t** ppfHeap, int* piHeapNum, tmsp* ptsNow);
+void release_feed_unit(feed_t* pf, int iUnit, tmsp* ptsNow);
+void extend_feed_line(feed_t* pf);
+void set_feed_peritime(feed_t* pf, int64_t i8, int iBurst, feed_t** ppfHeap,
+                       int* piHeapNum, tmsp* ptsNow                         );
+int64_t read_feedctrl_r(feed_t* pf, int* piBurst);
+int64_t read_feedctrl_c(feed_t* pf, int* piBurst);
+void heap_push(feed_t** ppfHeap, int* piHeapNum, feed_t* pf);
+feed_t* heap_pop(feed_t** ppfHeap, int* piHeapNum);
+void heap_remove(feed_t** ppfHeap, int* piHeapNum, int iPos);
+void heap_sift_up(feed_t** ppfHeap, int iPos);
+void heap_sift_down(feed_t** ppfHeap, int iHeapNum, int iPos);
+int tmsp_cmp(const tmsp* pts1, const tmsp* pts2);
+tmsp tmsp_add(tmsp ts, int64_t i8Nsec);
+int64_t tmsp_diff(const tmsp* pts1, const tmsp* pts2);
+size_t count_lf(const char* pc, size_t siz);
+void limit_bucket(tmsp* ptsPrev, tmsp* ptsNow, int64_t i8Peritime, int iBurst);
+void recv_feedctrl_req(int iSig, siginfo_t *siInfo, void *pct);
 
 /*--- global variables ---------------------------------------------*/
 char*    gpszCmdname;     /* The name of this command                        */
@@ -202,10 +322,23 @@ int64_t  gi8Peritime;     /* Periodic time in nanosecond (-1 means infinity)
                            *   sub-th has to write the parameter into the
                            *   gstThCom.i8Param1 instead when the sub-th
                            *   gives the main-th the new parameter.          */
+int      giBurst;         /* Depth of the token-bucket in blocks (0 means the
+                           * token-bucket mode is off). The same as the
+                           * gi8Peritime, the sub-th writes the parameter into
+                           * the gstThCom.iParam2 instead.                   */
 struct stat gstCtrlfile;  /* stat for the control file                       */
 int      giRecovery;      /* 0:normal 1:Recovery mode                        */
 int      giVerbose;       /* speaks more verbosely by the greater number     */
 thcominfo_t gstThCom;     /* Variables for threads communication             */
+const char* volatile gpcMapout; /* Lines in the mmap'd input which have been
+                           * passed but not written yet (only for the main-th)*/
+volatile size_t gsizMapout; /* Size of the above                             */
+sigjmp_buf gjbMapped;     /* Where to go back when the mmap'd input shrinks  */
+volatile sig_atomic_t giMapped; /* 1 while reading the mmap'd input          */
+volatile sig_atomic_t giFeedctrl_req; /* 1 when the ctrlfiles should be read */
+char     gcStdiobuf[3][BUFSIZ]; /* Buffers for the stdio streams (for stdin,
+                           * the other input files and stdout). They are
+                           * static to be pre-faulted/locked by -L.          */
 
 /*=== Define the functions for printing usage and error ============*/
 
@@ -213,11 +346,16 @@ thcominfo_t gstThCom;     /* Variables for threads communication             */
 void print_usage_and_exit(void) {
   fprintf(stderr,
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
-    "USAGE   : %s [-c|-l] [-r|-s] [-p n] periodictime [file [...]]\n"
-    "          %s [-c|-l] [-r|-s] [-p n] controlfile [file [...]]\n"
+    "USAGE   : %s [-c|-l] [-r|-s] [-m statsfile] [-p n] [-L] [-C cpu]\n"
+    "                periodictime [file [...]]\n"
+    "          %s [-c|-l] [-r|-s] [-m statsfile] [-p n] [-L] [-C cpu]\n"
+    "                controlfile [file [...]]\n"
+    "          %s [-c|-l] [-r|-s] [-m statsfile] [-p n] [-L] [-C cpu]\n"
+    "                -f feedfile\n"
 #else
-    "USAGE   : %s [-c|-l] [-r|-s] periodictime [file [...]]\n"
-    "          %s [-c|-l] [-r|-s] controlfile [file [...]]\n"
+    "USAGE   : %s [-c|-l] [-r|-s] [-m statsfile] periodictime [file [...]]\n"
+    "          %s [-c|-l] [-r|-s] [-m statsfile] controlfile [file [...]]\n"
+    "          %s [-c|-l] [-r|-s] [-m statsfile] -f feedfile\n"
 #endif
     "Args    : periodictime  Periodic time from start sending the current\n"
     "                        block (means a character or a line) to start\n"
@@ -232,6 +370,14 @@ void print_usage_and_exit(void) {
     "                        * output : '0%%'   (completely shut the value)\n"
     "                                   '100%%' (completely open the value)\n"
     "                        The maximum value is INT_MAX for all units.\n"
+    "                        * burst  : Append \"/n\" to the above to enable\n"
+    "                                   the token-bucket mode, e.g. \"10ms/50\".\n"
+    "                                   It lets up to n blocks go at once\n"
+    "                                   with a single write when they have\n"
+    "                                   been delayed, and the bucket gets a\n"
+    "                                   token for every periodic time while\n"
+    "                                   no block comes. The recovery and\n"
+    "                                   strict modes mean nothing then.\n"
     "          controlfile . Filepath to specify the periodic time instead\n"
     "                        of by argument. You can change the parameter\n"
     "                        even when this command is running by updating\n"
@@ -266,7 +412,30 @@ void print_usage_and_exit(void) {
     "                            modes. The new parameter will be applied\n"
     "                            immediately just after writing.\n"
     "          file ........ Filepath to be send (\"-\" means STDIN)\n"
-    "Options : -c .......... (Default) Changes the periodic unit to\n"
+    "Options : -f feedfile . Multi-stream mode\n"
+    "                        Serve many feeds in this one process instead of\n"
+    "                        running a valve for each feed. Each line of the\n"
+    "                        feedfile describes a feed with three fields.\n"
+    "                          periodictime|controlfile  inputfile  outputfile\n"
+    "                        * The first field is the same as the argument\n"
+    "                          of the single-stream mode. A controlfile for\n"
+    "                          each feed lets you change the periodic time\n"
+    "                          of the feed individually. (SIGHUP makes this\n"
+    "                          command read all regular controlfiles now.)\n"
+    "                        * \"-\" means STDIN for an inputfile and STDOUT\n"
+    "                          for an outputfile. An outputfile is created\n"
+    "                          or truncated.\n"
+    "                        * Empty lines and lines beginning with \"#\" are\n"
+    "                          ignored.\n"
+    "                        * Files are opened in the order of the lines,\n"
+    "                          so a named pipe waits for its peer there.\n"
+    "                        * The other options are applied to all feeds.\n"
+    "                          In the recovery mode, a feed recovers the\n"
+    "                          lost time up to 10 milliseconds.\n"
+    "                        This mode uses only one thread. It sleeps until\n"
+    "                        the earliest deadline among the feeds with\n"
+    "                        watching all of the files by poll().\n"
+    "          -c .......... (Default) Changes the periodic unit to\n"
     "                        character. This option defines that the\n"
     "                        periodic time is the time from sending the\n"
     "                        current character to sending the next one.\n"
@@ -276,6 +445,8 @@ void print_usage_and_exit(void) {
     "                        time from sending the top character of the\n"
     "                        current line to sending the top character of\n"
     "                        the next line.\n"
+    "                        A line in a regular file is sent from the\n"
+    "                        mmap'd file by one write() with no copying.\n"
     "                        -c option will be disabled by this option.\n"
     "          [The following options are for professional]\n"
     "          -r .......... (Default) Recovery mode \n"
@@ -293,6 +464,14 @@ void print_usage_and_exit(void) {
     "                        keep strictly the maximum instantaneous data-\n"
     "                        transfer rate limit decided by periodictime.\n"
     "                        -r option will be disabled by this option.\n"
+    "          -m statsfile  Write a snapshot of the live counters (bytes,\n"
+    "                        lines, sleeps, oversleeping histogram, etc.)\n"
+    "                        into the file every second, when SIGUSR1\n"
+    "                        comes, and at exit. A regular file always has\n"
+    "                        only the latest one, and a named pipe gets a\n"
+    "                        line for each snapshot.\n"
+    "                        Without this option, a snapshot is written into\n"
+    "                        the stderr only when SIGUSR1 comes.\n"
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
     "          -p n ........ Process priority setting [0-3] (if possible)\n"
     "                         0: Normal process\n"
@@ -304,8 +483,16 @@ void print_usage_and_exit(void) {
     "                        but if failed, it will try the smaller numbers.\n"
     "                        An administrative privilege might be required to\n"
     "                        use this option.\n"
+    "          -L .......... Lock the memory of this command into the RAM\n"
+    "                        after pre-faulting the stack, so that no page\n"
+    "                        fault delays it in the realtime mode. A large\n"
+    "                        enough \"ulimit -l\" or a privileged user might\n"
+    "                        be required.\n"
+    "          -C cpu ...... Run this command only on the CPU #cpu (from 0)\n"
+    "                        to avoid the migration between CPUs. (for only\n"
+    "                        Linux) An isolated CPU gives the best result.\n"
 #endif
-    "Version : 2025-01-28 16:47:55 JST\n"
+    "Version : 2026-10-18 23:03:18 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -313,7 +500,7 @@ void print_usage_and_exit(void) {
     "\n"
     "The latest version is distributed at the following page.\n"
     "https://github.com/ShellShoccar-jpn/tokideli\n"
-    ,gpszCmdname,gpszCmdname);
+    ,gpszCmdname,gpszCmdname,gpszCmdname);
   exit(1);
 }
 
@@ -350,10 +537,14 @@ sigset_t ssMask;          /* blocking signal list for the main thread*/
 struct sigaction saHup;   /* for signal handler definition (action) */
 int      iUnit;           /* 0:character 1:line 2-:undefined        */
 int      iPrio;           /* -p option number (default 1)           */
+int      iCpu;            /* -C option number (-1:not pinned)       */
+int      iMlock;          /* 1 if -L option is given                */
 int      iRet;            /* return code                            */
 int      iRet_r1l;        /* return value by read_1line()           */
 char    *pszPath;         /* filepath on arguments                  */
 char    *pszFilename;     /* filepath (for message)                 */
+char    *pszStatfile;     /* statistics file (for the -m option)    */
+char    *pszFeedfile;     /* feedfile (for the -f option)           */
 int      iFileno;         /* file# of filepath                      */
 int      iFileno_opened;  /* number of the files opened successfully*/
 int      iFd;             /* file descriptor                        */
@@ -377,16 +568,28 @@ setlocale(LC_CTYPE, "");
 /*--- Set default parameters of the arguments ----------------------*/
 iUnit     =0;
 iPrio     =1;
+iCpu      =-1;
+iMlock    =0;
 giVerbose =0;
 giRecovery=1;
+pszStatfile=NULL;
+pszFeedfile=NULL;
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "clp:rsvh")) != -1) {
+while ((i=getopt(argc, argv, "cf:lm:p:LC:rsvh")) != -1) {
   switch (i) {
     case 'c': iUnit = 0;      break;
+    case 'f': pszFeedfile = optarg;
+              break;
     case 'l': iUnit = 1;      break;
+    case 'm': pszStatfile = optarg;
+              break;
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
     case 'p': if (sscanf(optarg,"%d",&iPrio) != 1) {print_usage_and_exit();}
               break;
+    case 'L': iMlock = 1;     break;
+    case 'C': if (sscanf(optarg,"%d",&iCpu) != 1) {print_usage_and_exit();}
+              if (iCpu < 0                       ) {print_usage_and_exit();}
+              break;
 #endif
     case 'r': giRecovery = 1; break;
     case 's': giRecovery = 0; break;
@@ -401,16 +604,27 @@ if (giVerbose>0) {warning("verbose mode (level %d)\n",giVerbose);}
 #if RECOVMAX_MULTIPLIER > 0
   if (giVerbose>0) {warning("RECOVMAX_MULTIPLIER is %d\n",RECOVMAX_MULTIPLIER);}
 #endif
+if (pszFeedfile != NULL) {
+  /*--- Multi-stream mode (This mode makes no other threads) -------*/
+  if (argc != 1) {print_usage_and_exit();}
+  stats_start(gpszCmdname, pszStatfile);
+  if (change_to_rtprocess(iPrio)==-1) {print_usage_and_exit();}
+  if (iCpu >= 0) {rtmem_pin_cpu(iCpu);}
+  return run_feeds(pszFeedfile, iUnit, iMlock);
+}
 if (argc < 2) {print_usage_and_exit();}
+/*--- Start the statistics thread before any other threads ---------*/
+stats_start(gpszCmdname, pszStatfile);
 /*--- Prepare the thread operation ---------------------------------*/
 memset(&gstThCom, 0, sizeof(gstThCom    ));
 memset(&stMainth, 0, sizeof(thmaininfo_t));
 pthread_cleanup_push(mainth_destructor, &stMainth);
 /*--- Parse the periodic time --------------------------------------*/
-gi8Peritime = parse_periodictime(argv[0]);
+gi8Peritime = parse_periodictime(argv[0], &giBurst);
 if (gi8Peritime <= -2) {
   /* Set the initial parameter, which is "0%" */
   gi8Peritime=-1; gstThCom.i8Param1=gi8Peritime;
+  giBurst    = 0; gstThCom.iParam2 =giBurst;
   /* If the argument might be a control file, start the subthread */
   if (stat(argv[0],&gstCtrlfile) < 0) {
     error_exit(errno,"%s: %s\n",argv[0],strerror(errno));
@@ -474,13 +688,14 @@ argv++;
 /*=== Switch buffer mode ===========================================*/
 switch (iUnit) {
   case 0:
-            if (setvbuf(stdout,NULL,_IONBF,0)!=0) {
-              error_exit(255,"Failed to switch to unbuffered mode\n");
-            }
-            break;
   case 1:
-            if (setvbuf(stdout,NULL,_IOLBF,0)!=0) {
-              error_exit(255,"Failed to switch to line-buffered mode\n");
+            /* Every block is flushed by flush_the_blocks() to let the
+               blocks in a burst go out with a single write()           */
+            if (setvbuf(stdout,gcStdiobuf[2],_IOFBF,BUFSIZ)!=0) {
+              error_exit(255,"Failed to switch to fully-buffered mode\n");
+            }
+            if (setvbuf(stdin ,gcStdiobuf[0],_IOFBF,BUFSIZ)!=0) {
+              error_exit(255,"Failed to give stdin the buffer\n");
             }
             break;
   default:
@@ -490,6 +705,9 @@ switch (iUnit) {
 
 /*=== Try to make me a realtime process ============================*/
 if (change_to_rtprocess(iPrio)==-1) {print_usage_and_exit();}
+if (iCpu >= 0) {rtmem_pin_cpu(iCpu);}
+if (iMlock   ) {rtmem_prefault(gcStdiobuf,sizeof(gcStdiobuf));
+                rtmem_lock();                                  }
 
 /*=== Each file loop ===============================================*/
 iRet          =  0;
@@ -519,6 +737,9 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
     if (feof(stdin)) {clearerr(stdin);} /* Reset EOF condition when stdin */
   } else                   {
     stMainth.fpIn = fdopen(iFd, "r");
+    if (setvbuf(stMainth.fpIn,gcStdiobuf[1],_IOFBF,BUFSIZ)!=0) {
+      error_exit(255,"%s: Failed to give the buffer\n",pszFilename);
+    }
   }
   iFileno_opened++;
 
@@ -536,9 +757,14 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
                 while (putchar(i)==EOF) {
                   error_exit(errno,"main() #C1: %s\n",strerror(errno));
                 }
+                stats_pass(1,(i=='\n'));
+                flush_the_blocks(stMainth.fpIn);
               }
               break;
     case 1:
+              if (pace_mmapped_lines(stMainth.fpIn,&iRet_r1l,&ts1st)==0) {
+                break;
+              }
               if (ts1st.tv_nsec == -1) {
                 iRet_r1l = read_1line(stMainth.fpIn,&ts1st);
                 spend_my_spare_time(&ts1st);
@@ -558,6 +784,9 @@ while ((pszPath = argv[iFileno]) != NULL || iFileno == 0) {
   }
 
   /*--- Close the input file ---------------------------------------*/
+  if (fflush(stdout) == EOF) {
+    error_exit(errno,"main() #F1: %s\n",strerror(errno));
+  }
   if (stMainth.fpIn != stdin) {fclose(stMainth.fpIn); stMainth.fpIn=NULL;}
 
   /*--- End loop ---------------------------------------------------*/
@@ -571,6 +800,680 @@ return(iRet);}
 
 
 
+/*####################################################################
+# Multi-stream Mode (-f option)
+####################################################################*/
+
+/*=== Serve all the feeds written in the feedfile ====================
+ * This is the main loop of the multi-stream mode. Only one thread
+ * serves all of the feeds. A min-heap of the next emitting deadlines
+ * decides when the thread wakes up, and poll() waits for the I/O of
+ * all the inputs, outputs and control files in the meantime.
+ * [in]  pszFeedfile : Filepath of the feedfile
+ *       iUnit       : 0:character 1:line
+ *       iMlock      : 1 to lock the memory after allocating the feeds
+ * [ret] 0 only when all feeds finished successfully                */
+int run_feeds(char* pszFeedfile, int iUnit, int iMlock) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct sigaction sa;     /* for signal handler definition (action) */
+  feed_t*  pfd;            /* feed array                             */
+  feed_t*  pf;             /* the current feed                       */
+  feed_t** ppfHeap;        /* min-heap of the deadlines              */
+  struct pollfd* pstPoll;  /* pollfd array                           */
+  feed_t** ppfPoll;        /* feed of each pollfd                    */
+  int*     piPollKind;     /* 0:input 1:output 2:control file        */
+  int      iFeeds;         /* number of the feeds                    */
+  int      iHeapNum;       /* number of the feeds in the heap        */
+  int      iPolls;         /* number of the pollfds                  */
+  int      iAlive;         /* number of the feeds not finished       */
+  int      iRet;           /* return code                            */
+  int      iTimer;         /* 1 if a deadline comes before tsCtrlchk */
+  tmsp     tsNow;          /* the current time                       */
+  tmsp     tsWake;         /* the time to wake up                    */
+  tmsp     tsCtrlchk;      /* the time to read regular ctrl. files   */
+  int64_t  i8;             /* all-purpose int64                      */
+  ssize_t  ssiz;           /* all-purpose ssize_t                    */
+  int      i, j;           /* all-purpose int                        */
+
+  /*--- Load the feedfile and open every file ----------------------*/
+  iFeeds = load_feedfile(pszFeedfile, &pfd);
+  if (iFeeds < 1) {error_exit(1,"%s: No feed is written\n",pszFeedfile);}
+  for (i=0; i<iFeeds; i++) {open_feed(&pfd[i]);}
+  if (giVerbose>0) {warning("%d feed(s) are ready\n",iFeeds);}
+
+  /*--- Prepare the heap and pollfd arrays -------------------------*/
+  ppfHeap    = (feed_t**      )malloc(sizeof(feed_t*      )*iFeeds  );
+  pstPoll    = (struct pollfd*)malloc(sizeof(struct pollfd)*iFeeds*3);
+  ppfPoll    = (feed_t**      )malloc(sizeof(feed_t*      )*iFeeds*3);
+  piPollKind = (int*          )malloc(sizeof(int          )*iFeeds*3);
+  if (!ppfHeap || !pstPoll || !ppfPoll || !piPollKind) {
+    error_exit(1,"Memory is not enough.\n");
+  }
+  iHeapNum = 0;
+
+  /*--- Lock the memory (-L) after the feed buffers are allocated ---*/
+  if (iMlock) {
+    rtmem_prefault(pfd       , sizeof(feed_t       )*iFeeds  );
+    rtmem_prefault(ppfHeap   , sizeof(feed_t*      )*iFeeds  );
+    rtmem_prefault(pstPoll   , sizeof(struct pollfd)*iFeeds*3);
+    rtmem_prefault(ppfPoll   , sizeof(feed_t*      )*iFeeds*3);
+    rtmem_prefault(piPollKind, sizeof(int          )*iFeeds*3);
+    rtmem_lock();
+  }
+
+  /*--- Set signal handlers ----------------------------------------*/
+  /* SIGHUP: Read the regular control files right now */
+  memset(&sa, 0, sizeof(sa));
+  sigemptyset(&sa.sa_mask);
+  sa.sa_sigaction = recv_feedctrl_req;
+  sa.sa_flags     = SA_SIGINFO;
+  if (sigaction(SIGHUP,&sa,NULL) != 0) {
+    error_exit(errno,"sigaction() #1 in run_feeds(): %s\n",strerror(errno));
+  }
+  /* SIGPIPE: A vanished reader must not kill the other feeds */
+  memset(&sa, 0, sizeof(sa));
+  sigemptyset(&sa.sa_mask);
+  sa.sa_handler = SIG_IGN;
+  if (sigaction(SIGPIPE,&sa,NULL) != 0) {
+    error_exit(errno,"sigaction() #2 in run_feeds(): %s\n",strerror(errno));
+  }
+
+  /*--- Serving loop -----------------------------------------------*/
+  iRet              = 0;
+  giFeedctrl_req    = 1;
+  tsCtrlchk.tv_sec  = 0;
+  tsCtrlchk.tv_nsec = 0;
+  while (1) {
+    if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
+      error_exit(errno,"clock_gettime() #1 in run_feeds(): %s\n",
+                 strerror(errno));
+    }
+
+    /* 1) Read the regular control files periodically or by SIGHUP */
+    if (giFeedctrl_req || tmsp_cmp(&tsNow,&tsCtrlchk)>=0) {
+      giFeedctrl_req = 0;
+      for (i=0; i<iFeeds; i++) {
+        pf = &pfd[i];
+        if (pf->iCtrltype==1 && pf->iState!=FEED_DONE) {
+          if ((i8=read_feedctrl_r(pf,&j)) >= -1) {
+            set_feed_peritime(pf, i8, j, ppfHeap, &iHeapNum, &tsNow);
+          }
+        } else if (pf->iCtrltype==2 && pf->iFdCtrl<0) {
+          /* Re-open the FIFO control file which was closed */
+          pf->iFdCtrl = open(pf->pszCtrl, O_RDONLY|O_NONBLOCK);
+        }
+      }
+      tsCtrlchk = tmsp_add(tsNow, (int64_t)FREAD_ITRVL_SEC*1000000000
+                                 +(int64_t)FREAD_ITRVL_USEC*1000      );
+    }
+
+    /* 2) Release the units whose deadlines have come */
+    while (iHeapNum>0 && tmsp_cmp(&ppfHeap[0]->tsNext,&tsNow)<=0) {
+      pf = heap_pop(ppfHeap, &iHeapNum);
+      release_feed_unit(pf, iUnit, &tsNow);
+      arm_feed(pf, ppfHeap, &iHeapNum, &tsNow);
+    }
+
+    /* 3) Build the pollfd array and finish the feeds which are done */
+    iPolls = 0;
+    iAlive = 0;
+    for (i=0; i<iFeeds; i++) {
+      pf = &pfd[i];
+      if (pf->iState == FEED_DONE) {continue;}
+      if (pf->iEof && pf->sizHead==pf->sizTail) {
+        finish_feed(pf, ppfHeap, &iHeapNum);
+        continue;
+      }
+      iAlive++;
+      if (pf->sizHead>0 && pf->sizTail>FEED_BUF/2) {
+        /* Move the data to the top of the buffer to make room */
+        memmove(pf->cBuf, pf->cBuf+pf->sizHead, pf->sizTail-pf->sizHead);
+        pf->sizRel  -= pf->sizHead;
+        pf->sizTail -= pf->sizHead;
+        pf->sizHead  = 0;
+      }
+      if (!pf->iEof && pf->sizTail<FEED_BUF) {
+        pstPoll[iPolls].fd = pf->iFdIn ; pstPoll[iPolls].events = POLLIN ;
+        ppfPoll[iPolls]    = pf        ; piPollKind[iPolls]     = 0      ;
+        iPolls++;
+      }
+      if (pf->sizRel > pf->sizHead) {
+        pstPoll[iPolls].fd = pf->iFdOut; pstPoll[iPolls].events = POLLOUT;
+        ppfPoll[iPolls]    = pf        ; piPollKind[iPolls]     = 1      ;
+        iPolls++;
+      }
+      if (pf->iCtrltype==2 && pf->iFdCtrl>=0) {
+        pstPoll[iPolls].fd = pf->iFdCtrl; pstPoll[iPolls].events = POLLIN;
+        ppfPoll[iPolls]    = pf         ; piPollKind[iPolls]     = 2     ;
+        iPolls++;
+      }
+    }
+    if (iAlive == 0) {break;}
+
+    /* 4) Wait for the I/O until the next deadline */
+    iTimer = (iHeapNum>0 && tmsp_cmp(&ppfHeap[0]->tsNext,&tsCtrlchk)<0);
+    tsWake = (iTimer) ? ppfHeap[0]->tsNext : tsCtrlchk;
+    i8     = tmsp_diff(&tsWake, &tsNow);
+    if (iTimer && i8>0 && i8<1000000) {
+      /* poll() cannot wait for less than 1ms. So, sleep for the rest. */
+      nanosleep(&(tmsp){.tv_sec=0, .tv_nsec=(long)i8}, NULL);
+      continue;
+    }
+    i = poll(pstPoll, iPolls, (i8<=0) ? 0 : (int)(i8/1000000));
+    if (i < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"poll() in run_feeds(): %s\n",strerror(errno));
+    }
+    if (i == 0) {continue;}
+
+    /* 5) Do the I/O for the ready files */
+    if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
+      error_exit(errno,"clock_gettime() #2 in run_feeds(): %s\n",
+                 strerror(errno));
+    }
+    for (j=0; j<iPolls; j++) {
+      if (pstPoll[j].revents == 0) {continue;}
+      pf = ppfPoll[j];
+      if (pf->iState == FEED_DONE) {continue;}
+      switch (piPollKind[j]) {
+        case 0 : /* input */
+                 ssiz = read(pf->iFdIn, pf->cBuf+pf->sizTail,
+                             FEED_BUF-pf->sizTail            );
+                 if (ssiz < 0) {
+                   if (errno==EINTR || errno==EAGAIN) {break;}
+                   warning("%s: %s\n",pf->pszIn,strerror(errno));
+                   iRet = 1; pf->iEof = 1;
+                   break;
+                 }
+                 if (ssiz == 0) {pf->iEof = 1; break;}
+                 pf->sizTail += (size_t)ssiz;
+                 if (pf->iInLine) {extend_feed_line(pf);}
+                 arm_feed(pf, ppfHeap, &iHeapNum, &tsNow);
+                 break;
+        case 1 : /* output */
+                 i8   = (int64_t)(pf->sizRel-pf->sizHead);
+                 if (i8 > PIPE_BUF) {i8 = PIPE_BUF;}
+                 ssiz = write(pf->iFdOut, pf->cBuf+pf->sizHead, (size_t)i8);
+                 if (ssiz < 0) {
+                   if (errno==EINTR || errno==EAGAIN) {break;}
+                   warning("%s: %s\n",pf->pszOut,strerror(errno));
+                   iRet = 1;
+                   finish_feed(pf, ppfHeap, &iHeapNum);
+                   break;
+                 }
+                 pf->sizHead += (size_t)ssiz;
+                 if (pf->sizHead == pf->sizTail) {
+                   pf->sizHead = 0; pf->sizRel = 0; pf->sizTail = 0;
+                 }
+                 break;
+        case 2 : /* FIFO/character-special control file */
+                 if ((i8=read_feedctrl_c(pf,&j)) >= -1) {
+                   set_feed_peritime(pf, i8, j, ppfHeap, &iHeapNum, &tsNow);
+                 }
+                 break;
+      }
+    }
+  }
+
+  /*--- Finish -----------------------------------------------------*/
+  free(ppfHeap); free(pstPoll); free(ppfPoll); free(piPollKind);
+  for (i=0; i<iFeeds; i++) {
+    free(pfd[i].pszIn); free(pfd[i].pszOut); free(pfd[i].pszCtrl);
+  }
+  free(pfd);
+  return iRet;
+}
+
+/*=== Load the feedfile ==============================================
+ * Each line of the feedfile has the following three fields.
+ *   periodictime|controlfile  inputfile  outputfile
+ * Empty lines and lines beginning with '#' are ignored.
+ * [in]  pszFeedfile : Filepath of the feedfile
+ * [out] ppfd        : Allocated feed array
+ * [ret] Number of the feeds                                        */
+int load_feedfile(char* pszFeedfile, feed_t** ppfd) {
+
+  /*--- Variables --------------------------------------------------*/
+  FILE*   fp;
+  char    szLine[LINE_BUF];
+  char    szF[3][LINE_BUF];
+  feed_t* pfd;
+  int     iFeeds, iSize, iLineno;
+  int     iStdin, iStdout;
+  int     i;
+
+  /*--- Open the feedfile ------------------------------------------*/
+  if ((fp=fopen(pszFeedfile,"r")) == NULL) {
+    error_exit(errno,"%s: %s\n",pszFeedfile,strerror(errno));
+  }
+
+  /*--- Read each line ---------------------------------------------*/
+  pfd     = NULL;
+  iFeeds  = 0;
+  iSize   = 0;
+  iLineno = 0;
+  iStdin  = 0;
+  iStdout = 0;
+  while (fgets(szLine, LINE_BUF, fp) != NULL) {
+    iLineno++;
+    i = sscanf(szLine, "%s %s %s", szF[0], szF[1], szF[2]);
+    if (i<1 || szF[0][0]=='#') {continue;}
+    if (i!=3) {
+      error_exit(1,"%s: line %d: 3 fields are required\n",
+                 pszFeedfile,iLineno                     );
+    }
+    if (iFeeds == iSize) {
+      iSize = (iSize==0) ? 16 : iSize*2;
+      if ((pfd=(feed_t*)realloc(pfd,sizeof(feed_t)*iSize)) == NULL) {
+        error_exit(1,"Memory is not enough.\n");
+      }
+    }
+    memset(&pfd[iFeeds], 0, sizeof(feed_t));
+    pfd[iFeeds].i8Peritime = parse_periodictime(szF[0],&pfd[iFeeds].iBurst);
+    if (pfd[iFeeds].i8Peritime <= -2) {
+      /* The first field is a control file. Start with "0%". */
+      pfd[iFeeds].i8Peritime = -1;
+      pfd[iFeeds].pszCtrl    = strdup(szF[0]);
+    }
+    pfd[iFeeds].pszIn  = strdup(szF[1]);
+    pfd[iFeeds].pszOut = strdup(szF[2]);
+    if (!pfd[iFeeds].pszIn || !pfd[iFeeds].pszOut) {
+      error_exit(1,"Memory is not enough.\n");
+    }
+    if (strcmp(szF[1],"-")==0 && iStdin++ ) {
+      error_exit(1,"%s: line %d: stdin is used twice\n",pszFeedfile,iLineno);
+    }
+    if (strcmp(szF[2],"-")==0) {iStdout++;}
+    iFeeds++;
+  }
+  if (ferror(fp)) {error_exit(1,"%s: Reading error\n",pszFeedfile);}
+  fclose(fp);
+  if (iStdout>1 && giVerbose>0) {
+    warning("%d feeds share the stdout\n",iStdout);
+  }
+
+  /*--- Finish -----------------------------------------------------*/
+  *ppfd = pfd;
+  return iFeeds;
+}
+
+/*=== Open the files of a feed =======================================
+ * The files are opened in blocking mode, in the order of the feedfile.
+ * So, a named pipe waits for its peer here.
+ * [in] pf : The feed                                               */
+void open_feed(feed_t* pf) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat st;
+
+  /*--- Input ------------------------------------------------------*/
+  if (strcmp(pf->pszIn,"-") == 0) {
+    pf->iFdIn = STDIN_FILENO;
+  } else {
+    while ((pf->iFdIn=open(pf->pszIn,O_RDONLY)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"%s: %s\n",pf->pszIn,strerror(errno));
+    }
+  }
+
+  /*--- Output -----------------------------------------------------*/
+  if (strcmp(pf->pszOut,"-") == 0) {
+    pf->iFdOut = STDOUT_FILENO;
+  } else {
+    while ((pf->iFdOut=open(pf->pszOut,O_WRONLY|O_CREAT|O_TRUNC,0644)) < 0) {
+      if (errno == EINTR) {continue;}
+      error_exit(errno,"%s: %s\n",pf->pszOut,strerror(errno));
+    }
+  }
+
+  /*--- Control file -----------------------------------------------*/
+  pf->iFdCtrl   = -1;
+  pf->iCtrltype =  0;
+  if (pf->pszCtrl) {
+    if (stat(pf->pszCtrl,&st) < 0) {
+      error_exit(errno,"%s: %s\n",pf->pszCtrl,strerror(errno));
+    }
+    switch (st.st_mode & S_IFMT) {
+      case S_IFREG : pf->iCtrltype = 1; break;
+#ifndef NOTTY
+      case S_IFCHR :
+      case S_IFIFO : pf->iCtrltype = 2; break;
+#endif
+      default      : error_exit(255,"%s: Unsupported file type\n",pf->pszCtrl);
+    }
+    /* A FIFO is opened without blocking not to wait for its writer */
+    pf->iFdCtrl = open(pf->pszCtrl,
+                       (pf->iCtrltype==2) ? O_RDONLY|O_NONBLOCK : O_RDONLY);
+    if (pf->iFdCtrl < 0) {
+      error_exit(errno,"%s: %s\n",pf->pszCtrl,strerror(errno));
+    }
+  }
+
+  /*--- Initialize the state ---------------------------------------*/
+  pf->iHeappos = -1;
+  pf->iState   = FEED_IDLE;
+}
+
+/*=== Finish a feed ==================================================
+ * [in] pf       : The feed
+ *      ppfHeap  : The heap
+ *      piHeapNum: Number of the feeds in the heap                  */
+void finish_feed(feed_t* pf, feed_t** ppfHeap, int* piHeapNum) {
+  if (pf->iHeappos >= 0) {heap_remove(ppfHeap, piHeapNum, pf->iHeappos);}
+  if (pf->iFdIn   > STDERR_FILENO) {close(pf->iFdIn  );}
+  if (pf->iFdOut  > STDERR_FILENO) {close(pf->iFdOut );}
+  if (pf->iFdCtrl >= 0           ) {close(pf->iFdCtrl);}
+  pf->iFdCtrl = -1;
+  pf->iState  = FEED_DONE;
+  if (giVerbose>0) {warning("%s: finished\n",pf->pszIn);}
+}
+
+/*=== Put a feed into the heap if it has a unit to release ===========
+ * [in] pf       : The feed
+ *      ppfHeap  : The heap
+ *      piHeapNum: Number of the feeds in the heap
+ *      ptsNow   : The current time                                 */
+void arm_feed(feed_t* pf, feed_t** ppfHeap, int* piHeapNum, tmsp* ptsNow) {
+  if (pf->iState   == FEED_DONE  ) {return;}
+  if (pf->iHeappos >= 0          ) {return;}
+  if (pf->iInLine                ) {return;}
+  if (pf->sizRel   == pf->sizTail) {return;}
+  if (pf->i8Peritime < 0         ) {return;}
+  if (pf->iBurst   > 0           ) {
+    limit_bucket(&pf->tsPrev, ptsNow, pf->i8Peritime, pf->iBurst);
+  }
+  pf->tsNext  = tmsp_add(pf->tsPrev, pf->i8Peritime);
+  pf->iWaited = (tmsp_cmp(&pf->tsNext,ptsNow) > 0); /* really sleeps? */
+  heap_push(ppfHeap, piHeapNum, pf);
+}
+
+/*=== Release the next unit of a feed ================================
+ * The unit is a character or a line. The released data will be written
+ * into the output as soon as it gets ready. In the token-bucket mode,
+ * all the units the bucket allows are released at once.
+ * [in] pf     : The feed
+ *      iUnit  : 0:character 1:line
+ *      ptsNow : The current time                                   */
+void release_feed_unit(feed_t* pf, int iUnit, tmsp* ptsNow) {
+
+  /*--- Variables --------------------------------------------------*/
+  char*   pc;
+  size_t  siz;
+  int64_t i8Late;
+
+  /*--- Release the unit -------------------------------------------*/
+  if (pf->iWaited) {stats_slept(&pf->tsNext, ptsNow);}
+next_unit:
+  siz = pf->sizTail - pf->sizRel;
+  if (pf->i8Peritime == 0) {
+    /* "100%": release everything */
+    stats_pass(siz, count_lf(pf->cBuf+pf->sizRel, siz));
+    pf->sizRel = pf->sizTail;
+  } else if (iUnit == 0) {
+    stats_pass(1, (pf->cBuf[pf->sizRel]=='\n'));
+    pf->sizRel++;
+  } else {
+    pc = memchr(pf->cBuf+pf->sizRel, '\n', siz);
+    if (pc) {
+      stats_pass((size_t)(pc-(pf->cBuf+pf->sizRel))+1, 1);
+      pf->sizRel = (size_t)(pc-pf->cBuf)+1;
+    } else {
+      /* The rest of the line will pass through as soon as it comes */
+      stats_pass(siz, 0);
+      pf->sizRel  = pf->sizTail;
+      pf->iInLine = 1;
+    }
+  }
+
+  /*--- Decide the base time of the next deadline ------------------*/
+  if (pf->iBurst > 0) {
+    /* The bucket decides it. Release the next unit if a token is left */
+    pf->tsPrev = pf->tsNext;
+    if (pf->iInLine || pf->sizRel==pf->sizTail) {return;}
+    pf->tsNext = tmsp_add(pf->tsPrev, pf->i8Peritime);
+    if (tmsp_cmp(&pf->tsNext,ptsNow) <= 0     ) {goto next_unit;}
+    return;
+  }
+  i8Late = tmsp_diff(ptsNow, &pf->tsNext);
+  if (i8Late>0 && (!giRecovery || i8Late>FEED_RECOVMAX_NSEC)) {
+    /* Too late to recover the lost time, or in the strict mode */
+    if (pf->iWaited && giRecovery) {
+      if (giVerbose>1) {warning("%s: give up recovery this time\n",pf->pszIn);}
+      stats_add(ST_GIVEUPS,1);
+    }
+    pf->tsPrev = *ptsNow;
+  } else {
+    pf->tsPrev = pf->tsNext;
+  }
+}
+
+/*=== Release the rest of the current line which has just come =======
+ * [in] pf : The feed                                               */
+void extend_feed_line(feed_t* pf) {
+  char*  pc;
+  size_t siz;
+
+  siz = pf->sizTail - pf->sizRel;
+  pc  = memchr(pf->cBuf+pf->sizRel, '\n', siz);
+  if (pc) {
+    stats_pass((size_t)(pc-(pf->cBuf+pf->sizRel))+1, 1);
+    pf->sizRel  = (size_t)(pc-pf->cBuf)+1;
+    pf->iInLine = 0;
+  } else {
+    stats_pass(siz, 0);
+    pf->sizRel  = pf->sizTail;
+  }
+}
+
+/*=== Apply a new periodic time to a feed ============================
+ * [in] pf       : The feed
+ *      i8       : The new periodic time
+ *      iBurst   : The new depth of the token-bucket
+ *      ppfHeap  : The heap
+ *      piHeapNum: Number of the feeds in the heap
+ *      ptsNow   : The current time                                 */
+void set_feed_peritime(feed_t* pf, int64_t i8, int iBurst, feed_t** ppfHeap,
+                       int* piHeapNum, tmsp* ptsNow                         ) {
+  if (pf->i8Peritime==i8 && pf->iBurst==iBurst) {return;}
+  if (giVerbose>0) {
+    warning("%s: periodic time=%ld, burst=%d\n",pf->pszIn,i8,iBurst);
+  }
+  pf->i8Peritime    = i8;
+  pf->iBurst        = iBurst;
+  pf->tsPrev.tv_sec = 0; pf->tsPrev.tv_nsec = 0;
+  if (pf->iHeappos >= 0) {heap_remove(ppfHeap, piHeapNum, pf->iHeappos);}
+  arm_feed(pf, ppfHeap, piHeapNum, ptsNow);
+}
+
+/*=== Read the parameter in a regular control file ===================
+ * [in]  pf      : The feed
+ * [out] piBurst : The depth of the token-bucket
+ * [ret] >=-1 : The periodic time
+ *       <=-2 : No valid parameter                                  */
+int64_t read_feedctrl_r(feed_t* pf, int* piBurst) {
+  char    szBuf[CTRL_FILE_BUF];
+  ssize_t ssiz;
+  int     i;
+
+  if ((ssiz=pread(pf->iFdCtrl,szBuf,CTRL_FILE_BUF-1,0)) < 1) {return -2;}
+  for (i=0; i<ssiz; i++) {if (szBuf[i]=='\n') {break;}}
+  szBuf[i] = '\0';
+  return parse_periodictime(szBuf, piBurst);
+}
+
+#ifndef NOTTY
+/*=== Read the parameter in a FIFO/character-special control file ====
+ * As well as the single-stream mode, the last complete line is the new
+ * parameter and a partial line is kept until its LF comes.
+ * [in]  pf      : The feed
+ * [out] piBurst : The depth of the token-bucket
+ * [ret] >=-1 : The periodic time
+ *       <=-2 : No valid parameter                                  */
+int64_t read_feedctrl_c(feed_t* pf, int* piBurst) {
+  char    cBuf[CTRL_FILE_BUF];
+  ssize_t ssiz;
+  int64_t i8Ret;
+  int64_t i8;
+  int     i, j;
+
+  i8Ret = -2;
+  ssiz  = read(pf->iFdCtrl, cBuf, CTRL_FILE_BUF);
+  if (ssiz < 0) {return -2;}
+  if (ssiz == 0) {
+    /* The writer closed it. It'll be re-opened later. */
+    if (giVerbose>0) {
+      warning("%s: Controlfile closed! Please re-open it.\n", pf->pszCtrl);
+    }
+    close(pf->iFdCtrl); pf->iFdCtrl = -1; pf->iCtrllen = 0;
+    return -2;
+  }
+  for (i=0; i<ssiz; i++) {
+    if (cBuf[i] == '\n') {
+      if (pf->iCtrllen < CTRL_FILE_BUF) {
+        pf->szCtrlbuf[pf->iCtrllen] = '\0';
+        i8 = parse_periodictime(pf->szCtrlbuf, &j);
+        if (i8 >= -1) {i8Ret = i8; *piBurst = j;}
+      }
+      pf->iCtrllen = 0;
+      continue;
+    }
+    if (pf->iCtrllen < CTRL_FILE_BUF-1) {
+      pf->szCtrlbuf[pf->iCtrllen++] = (cBuf[i]=='\0') ? ' ' : cBuf[i];
+    } else {
+      pf->iCtrllen = CTRL_FILE_BUF; /* too long */
+    }
+  }
+  return i8Ret;
+}
+#else
+int64_t read_feedctrl_c(feed_t* pf, int* piBurst) {return -2;}
+#endif
+
+/*=== Push a feed into the heap ======================================*/
+void heap_push(feed_t** ppfHeap, int* piHeapNum, feed_t* pf) {
+  ppfHeap[*piHeapNum] = pf;
+  pf->iHeappos        = *piHeapNum;
+  (*piHeapNum)++;
+  heap_sift_up(ppfHeap, pf->iHeappos);
+}
+
+/*=== Pop the feed which has the earliest deadline ===================*/
+feed_t* heap_pop(feed_t** ppfHeap, int* piHeapNum) {
+  feed_t* pf;
+  pf = ppfHeap[0];
+  heap_remove(ppfHeap, piHeapNum, 0);
+  return pf;
+}
+
+/*=== Remove the feed at the position from the heap ==================*/
+void heap_remove(feed_t** ppfHeap, int* piHeapNum, int iPos) {
+  ppfHeap[iPos]->iHeappos = -1;
+  (*piHeapNum)--;
+  if (iPos == *piHeapNum) {return;}
+  ppfHeap[iPos]           = ppfHeap[*piHeapNum];
+  ppfHeap[iPos]->iHeappos = iPos;
+  heap_sift_up(  ppfHeap, iPos);
+  heap_sift_down(ppfHeap, *piHeapNum, ppfHeap[iPos]->iHeappos);
+}
+
+/*=== Move the feed at the position up to the right place ============*/
+void heap_sift_up(feed_t** ppfHeap, int iPos) {
+  feed_t* pf;
+  int     iParent;
+
+  pf = ppfHeap[iPos];
+  while (iPos > 0) {
+    iParent = (iPos-1)/2;
+    if (tmsp_cmp(&ppfHeap[iParent]->tsNext,&pf->tsNext) <= 0) {break;}
+    ppfHeap[iPos]           = ppfHeap[iParent];
+    ppfHeap[iPos]->iHeappos = iPos;
+    iPos                    = iParent;
+  }
+  ppfHeap[iPos] = pf;
+  pf->iHeappos  = iPos;
+}
+
+/*=== Move the feed at the position down to the right place ==========*/
+void heap_sift_down(feed_t** ppfHeap, int iHeapNum, int iPos) {
+  feed_t* pf;
+  int     iChild;
+
+  pf = ppfHeap[iPos];
+  while ((iChild=iPos*2+1) < iHeapNum) {
+    if (iChild+1<iHeapNum &&
+        tmsp_cmp(&ppfHeap[iChild+1]->tsNext,&ppfHeap[iChild]->tsNext)<0) {
+      iChild++;
+    }
+    if (tmsp_cmp(&pf->tsNext,&ppfHeap[iChild]->tsNext) <= 0) {break;}
+    ppfHeap[iPos]           = ppfHeap[iChild];
+    ppfHeap[iPos]->iHeappos = iPos;
+    iPos                    = iChild;
+  }
+  ppfHeap[iPos] = pf;
+  pf->iHeappos  = iPos;
+}
+
+/*=== Compare two times (ret: <0, 0, >0 like strcmp()) ===============*/
+int tmsp_cmp(const tmsp* pts1, const tmsp* pts2) {
+  if (pts1->tv_sec  != pts2->tv_sec ) {
+    return (pts1->tv_sec  < pts2->tv_sec ) ? -1 : 1;
+  }
+  if (pts1->tv_nsec != pts2->tv_nsec) {
+    return (pts1->tv_nsec < pts2->tv_nsec) ? -1 : 1;
+  }
+  return 0;
+}
+
+/*=== Add nanoseconds (can be negative) to a time ====================*/
+tmsp tmsp_add(tmsp ts, int64_t i8Nsec) {
+  i8Nsec    += ts.tv_nsec;
+  ts.tv_sec += (time_t)(i8Nsec/1000000000);
+  ts.tv_nsec = (long  )(i8Nsec%1000000000);
+  if (ts.tv_nsec < 0) {ts.tv_sec--; ts.tv_nsec+=1000000000;}
+  return ts;
+}
+
+/*=== Get the difference of two times (*pts1 - *pts2) in nanosec. ====*/
+int64_t tmsp_diff(const tmsp* pts1, const tmsp* pts2) {
+  return (int64_t)(pts1->tv_sec -pts2->tv_sec )*1000000000
+         +        (pts1->tv_nsec-pts2->tv_nsec);
+}
+
+/*=== Count LFs in the data ==========================================*/
+size_t count_lf(const char* pc, size_t siz) {
+  const char* pcEnd;
+  size_t      sizNum;
+
+  pcEnd  = pc + siz;
+  sizNum = 0;
+  while ((pc=memchr(pc,'\n',(size_t)(pcEnd-pc))) != NULL) {sizNum++; pc++;}
+  return sizNum;
+}
+
+/*=== Keep the token-bucket from holding more than iBurst tokens ======
+ * *ptsPrev is the time when the bucket would have got empty. So, it is
+ * brought forward up to the time the bucket gets full.
+ * [in]     ptsNow     : The current time
+ *          i8Peritime : Periodic time (time to get a token)
+ *          iBurst     : Depth of the token-bucket
+ * [in/out] ptsPrev    : The time when the bucket would have got empty */
+void limit_bucket(tmsp* ptsPrev, tmsp* ptsNow, int64_t i8Peritime, int iBurst) {
+  int64_t i8;
+
+  if (i8Peritime > INT64_MAX/iBurst) {return;} /* can never be full */
+  i8 = i8Peritime * iBurst;
+  if (tmsp_diff(ptsNow,ptsPrev) > i8) {*ptsPrev = tmsp_add(*ptsNow, -i8);}
+}
+
+/*=== SIGNALHANDLER : Read the regular control files right now =======
+ * [out] giFeedctrl_req : set to 1                                  */
+void recv_feedctrl_req(int iSig, siginfo_t *siInfo, void *pct) {
+  giFeedctrl_req = 1;
+}
+
+
+
 /*####################################################################
 # Subthread (Parameter Updater)
 ####################################################################*/
@@ -648,6 +1551,7 @@ void update_periodic_time_type_r(char* pszCtrlfile) {
   char             szBuf[CTRL_FILE_BUF]; /* parameter string buffer    */
   int              iLen                ; /* length of the parameter str*/
   int64_t          i8                  ;
+  int              iBurst              ;
   int              i                   ;
 
   /*--- Set the signal-triggered timer -----------------------------*/
@@ -694,11 +1598,12 @@ void update_periodic_time_type_r(char* pszCtrlfile) {
     if ((iLen=read(iFd_ctrlfile,szBuf,CTRL_FILE_BUF-1)) < 1) {goto pause;}
     for (i=0;i<iLen;i++) {if(szBuf[i]=='\n'){break;}}
     szBuf[i]='\0';
-    i8 = parse_periodictime(szBuf);
+    i8 = parse_periodictime(szBuf, &iBurst);
     if (i8             <= -2                               ) {goto pause;}
-    if (gstThCom.i8Param1 == i8                            ) {goto pause;}
+    if (gstThCom.i8Param1==i8 && gstThCom.iParam2==iBurst  ) {goto pause;}
     /* 2) Update the periodic time */
     gstThCom.i8Param1 = i8;
+    gstThCom.iParam2  = iBurst;
     if (pthread_kill(gstThCom.tMainth_id, SIGHUP) != 0) {
       error_exit(errno,"pthread_kill() in type_r(): %s\n",strerror(errno));
     }
@@ -748,6 +1653,7 @@ void update_periodic_time_type_c(char* pszCtrlfile) {
   struct pollfd fdsPoll[1]         ;
   char*   psz                      ;
   int64_t i8                       ;
+  int     iBurst                   ;
   int     i, j, k                  ;
 
   /*--- Initialize the buffer for the parameter --------------------*/
@@ -828,14 +1734,15 @@ void update_periodic_time_type_c(char* pszCtrlfile) {
       }
     }
     memcpy(szCmdbuf, szBuf1+j, i-j);
-    i8 = parse_periodictime(szCmdbuf);
+    i8 = parse_periodictime(szCmdbuf, &iBurst);
     if (i8                <= -2) {
       szCmdbuf[0]='\0'; continue; /* Invalid periodic time */
     }
-    if (gstThCom.i8Param1 == i8) {
+    if (gstThCom.i8Param1==i8 && gstThCom.iParam2==iBurst) {
       szCmdbuf[0]='\0'; continue; /* Parameter does not change */
     }
     gstThCom.i8Param1 = i8;
+    gstThCom.iParam2  = iBurst;
     if (pthread_kill(gstThCom.tMainth_id, SIGHUP)           != 0) {
       error_exit(errno,"pthread_kill() in type_c(): %s\n",strerror(errno));
     }
@@ -896,18 +1803,50 @@ void update_periodic_time_type_c(char* pszCtrlfile) {
 ####################################################################*/
 
 /*=== Parse the periodic time ========================================
+ * The argument can have "/<burst>" at the end to enable the token-bucket
+ * mode, which lets up to <burst> blocks go at once.
+ * [out] piBurst : Depth of the token-bucket (0 means no token-bucket)
+ *                 It is written only when the argument is valid.
  * [ret] >= 0  : Interval value (in nanosecound)
  *       <=-1  : Means infinity (completely shut the valve)
  *       <=-2  : It is not a value                                  */
-int64_t parse_periodictime(char *pszArg) {
+int64_t parse_periodictime(char *pszArg, int *piBurst) {
 
   /*--- Variables --------------------------------------------------*/
-  char   szUnit[CTRL_FILE_BUF];
-  double dNum;
+  char    szVal[CTRL_FILE_BUF];
+  char*   psz;
+  char    c;
+  int     iBurst;
+  int64_t i8;
 
   /*--- Check the lengths of the argument --------------------------*/
   if (strlen(pszArg)>=CTRL_FILE_BUF) {return -2;}
 
+  /*--- Separate the "/<burst>" part -------------------------------*/
+  strcpy(szVal, pszArg);
+  iBurst = 0;
+  if ((psz=strchr(szVal,'/')) != NULL) {
+    *psz++ = '\0';
+    if (sscanf(psz, "%d %c", &iBurst, &c) != 1) {return -2;}
+    if (iBurst < 1                            ) {return -2;}
+  }
+
+  /*--- Interpret the periodic time --------------------------------*/
+  i8 = parse_periodictime_value(szVal);
+  if (i8 >= -1) {*piBurst = iBurst;}
+  return i8;
+}
+
+/*=== Parse the periodic time without the burst part =================
+ * [ret] >= 0  : Interval value (in nanosecound)
+ *       <=-1  : Means infinity (completely shut the valve)
+ *       <=-2  : It is not a value                                  */
+int64_t parse_periodictime_value(char *pszArg) {
+
+  /*--- Variables --------------------------------------------------*/
+  char   szUnit[CTRL_FILE_BUF];
+  double dNum;
+
   /*--- Try to interpret the argument as "<value>"[+"unit"] --------*/
   switch (sscanf(pszArg, "%lf%s", &dNum, szUnit)) {
     case   2:                      break;
@@ -1071,6 +2010,8 @@ int read_1line(FILE *fp, tmsp *ptsGet1stchar) {
                   while (putchar('\n' )==EOF) {
                     error_exit(errno,"putchar() #R1L-1: %s\n",strerror(errno));
                   }
+                  stats_pass(1,1);
+                  flush_the_blocks(fp);
                   iChar=getc(fp);
                   if (iChar==EOF) {return 1;}
                   if (ungetc(iChar,fp)==EOF) {
@@ -1081,6 +2022,7 @@ int read_1line(FILE *fp, tmsp *ptsGet1stchar) {
                   while (putchar(iChar)==EOF) {
                     error_exit(errno,"putchar() #R1L-2: %s\n",strerror(errno));
                   }
+                  stats_pass(1,0);
     }
   }
 
@@ -1090,7 +2032,9 @@ int read_1line(FILE *fp, tmsp *ptsGet1stchar) {
       error_exit(errno,"fputs() #R1L-1: %s\n",strerror(errno));
     }
     iLen = strnlen(szBuf, LINE_BUF);
+    stats_pass(iLen,(szBuf[iLen-1]=='\n'));
     if (szBuf[iLen-1] == '\n') {
+      flush_the_blocks(fp);
       iChar=getc(fp);
       if (iChar==EOF) {return 1;}
       if (ungetc(iChar,fp)==EOF) {
@@ -1104,11 +2048,133 @@ int read_1line(FILE *fp, tmsp *ptsGet1stchar) {
       while (putchar(iChar)==EOF) {
         error_exit(errno,"putchar() #R1L-3: %s\n",strerror(errno));
       }
+      stats_pass(1,(iChar=='\n'));
     }
   }
   return EOF;
 }
 
+/*=== Read and write lines in a regular file by mmap() ===============
+ * This is the zero-copy version of the line-by-line loop with
+ * read_1line(). Each line is written from the mapping directly with
+ * a single write() instead of through the stdio buffers. If the file
+ * grows while sending it, the new part is mapped again. If the file
+ * shrinks while sending it (e.g. "copytruncate" of logrotate), reading
+ * the mapping beyond the new end raises SIGBUS (or write() fails with
+ * EFAULT). Then, it comes back here by siglongjmp() and leaves the rest
+ * to the stdio, which just sees the new end as the EOF.
+ * [in]     fp        : Filehandle for read (its fd is read directly)
+ * [in/out] piRet_r1l : The same value read_1line() would return for the
+ *                      last line
+ *          pts1st    : The time of the 1st line (tv_nsec is -1 until
+ *                      the 1st line comes)
+ * [ret] 0  : Finished reading the file
+ *       -1 : Could not do it for the (rest of the) file. The offset of
+ *            the file has been set where the stdio should begin.   */
+int pace_mmapped_lines(FILE *fp, int *piRet_r1l, tmsp *pts1st) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct stat stFile;  /* stat of the file                          */
+  int         iFd;     /* file descriptor of the file               */
+  off_t       otPos;   /* the current offset in the file            */
+  off_t       otMap;   /* the offset the mapping begins at          */
+  char*       pcMap;   /* the mapping                               */
+  size_t      sizMap;  /* size of the mapping                       */
+  const char* pc;      /* the top of the current line               */
+  const char* pcEnd;   /* the end of the mapped data                */
+  const char* pcLf;    /* the LF at the end of the current line     */
+  size_t      siz;     /* size of the current line                  */
+  long        lPgsiz;  /* page size                                 */
+  struct sigaction sa; /* for signal handler definition (action)   */
+  static int  iSigbus_isready = 0; /* 1 when the handler has been set */
+
+  /*--- Is it possible? --------------------------------------------*/
+  iFd = fileno(fp);
+  if (fstat(iFd,&stFile)  < 0                ) {return -1;}
+  if (! S_ISREG(stFile.st_mode)              ) {return -1;}
+  if (FP_HAS_RBUF(fp)                        ) {return -1;}
+  if ((otPos=lseek(iFd,0,SEEK_CUR)) < 0      ) {return -1;}
+  if ((lPgsiz=sysconf(_SC_PAGESIZE)) < 1     ) {return -1;}
+  if (! iSigbus_isready) {
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = map_truncated;
+    sa.sa_flags     = SA_SIGINFO;
+    if (sigaction(SIGBUS,&sa,NULL) != 0) {return -1;}
+    iSigbus_isready = 1;
+  }
+
+  /*--- An empty file gives the same result as read_1line() --------*/
+  if (stFile.st_size <= otPos) {*piRet_r1l=EOF; return 0;}
+
+  /*--- Map the rest of the file and send its lines (loop) ---------*/
+  while (stFile.st_size > otPos) {
+    /* 1) Map the new part */
+    otMap  = otPos - otPos%lPgsiz;
+    if ((uintmax_t)(stFile.st_size-otMap) > (uintmax_t)SIZE_MAX) {break;}
+    sizMap = (size_t)(stFile.st_size-otMap);
+    pcMap  = mmap(NULL,sizMap,PROT_READ,MAP_SHARED,iFd,otMap);
+    if (pcMap == MAP_FAILED) {
+      if (giVerbose>0) {warning("mmap(): %s\n",strerror(errno));}
+      break;
+    }
+    posix_madvise(pcMap, sizMap, POSIX_MADV_SEQUENTIAL);
+    /* 2) Send the lines */
+    pc         = pcMap + (otPos-otMap);
+    pcEnd      = pcMap + sizMap;
+    gpcMapout  = pc; /* (The top of what has not been written yet) */
+    gsizMapout = 0;
+    if (sigsetjmp(gjbMapped,1) != 0) {
+      /* The file has shrunk. Give the stdio the rest from the top of
+         what has not been written yet. (pc may be lost by the jump)  */
+      giMapped   = 0;
+      otPos      = otMap + (gpcMapout-pcMap);
+      gsizMapout = 0;
+      munmap(pcMap, sizMap);
+      if (giVerbose>0) {warning("the input file has shrunk\n");}
+      if (lseek(iFd,otPos,SEEK_SET) < 0) {
+        error_exit(errno,"lseek() in pace_mmapped_lines(): %s\n",
+                   strerror(errno));
+      }
+      return -1;
+    }
+    giMapped = 1;
+    while (pc < pcEnd) {
+      pcLf = memchr(pc, '\n', (size_t)(pcEnd-pc));
+      siz  = (pcLf) ? (size_t)(pcLf-pc)+1 : (size_t)(pcEnd-pc);
+      if (pts1st->tv_nsec == -1) {
+        if (clock_gettime(CLOCK_FOR_ME,pts1st) != 0) {
+          error_exit(errno,"clock_gettime() in pace_mmapped_lines(): %s\n",
+                     strerror(errno));
+        }
+        spend_my_spare_time(pts1st);
+      } else if (*piRet_r1l != EOF) {
+        spend_my_spare_time(NULL);
+      }
+      /* The lines are contiguous. So a burst is also written at once. */
+      if (gsizMapout == 0) {gpcMapout = pc;}
+      gsizMapout += siz;
+      stats_pass(siz, (pcLf!=NULL));
+      if (giBurst<1 || gi8Peritime<1) {flush_stdout();}
+      pc += siz;
+      *piRet_r1l = (pcLf==NULL) ? EOF : ((pc<pcEnd) ? 0 : 1);
+    }
+    /* 3) Unmap it after writing all the lines in it */
+    flush_stdout();
+    giMapped = 0;
+    munmap(pcMap, sizMap);
+    otPos = stFile.st_size;
+    /* 4) Check whether the file has grown */
+    if (fstat(iFd,&stFile) < 0) {break;}
+  }
+
+  /*--- Leave the offset where the rest begins ---------------------*/
+  if (lseek(iFd,otPos,SEEK_SET) < 0) {
+    error_exit(errno,"lseek() in pace_mmapped_lines(): %s\n",strerror(errno));
+  }
+  return (stFile.st_size > otPos) ? -1 : 0;
+}
+
 /*=== Sleep until the next interval period ===========================
  * [in]  gi8Peritime    : Periodic time (-1 means infinity)
  *       ptsPrev        : If not null, set it to tsPrev and exit immediately
@@ -1130,6 +2196,7 @@ void spend_my_spare_time(tmsp *ptsPrev) {
   tmsp           tsDiff              ;
 
   static int64_t i8LastPeritime  = -1;
+  static int     iLastBurst      =  0;
 
   uint64_t       ui8                 ;
   int            i                   ;
@@ -1140,6 +2207,15 @@ void spend_my_spare_time(tmsp *ptsPrev) {
     tsPrev.tv_sec  = ptsPrev->tv_sec ;
     tsPrev.tv_nsec = ptsPrev->tv_nsec;
     i8LastPeritime = gi8Peritime;
+    iLastBurst     = giBurst;
+    /* The token-bucket starts with full of tokens, but the block which
+       has just gone took one of them                                 */
+    if (giBurst>0 && gi8Peritime>0) {
+      tsNow  = *ptsPrev;
+      tsPrev = (tmsp){0,0};
+      limit_bucket(&tsPrev, &tsNow, gi8Peritime, giBurst);
+      tsPrev = tmsp_add(tsPrev, gi8Peritime);
+    }
     return;
   }
 
@@ -1165,14 +2241,16 @@ top:
   }
 
   /*--- Reset tsPrev if gi8Peritime was changed --------------------*/
-  if (gi8Peritime != i8LastPeritime) {
+  if (gi8Peritime != i8LastPeritime || giBurst != iLastBurst) {
     tsPrev.tv_sec  = 0;
     tsPrev.tv_nsec = 0;
     i8LastPeritime = gi8Peritime;
+    iLastBurst     = giBurst;
   }
 
   /*--- If "gi8Peritime" is neg., sleep until a signal comes -----*/
   if (gi8Peritime<0) {
+    flush_stdout();
     tsDiff.tv_sec  = 86400;
     tsDiff.tv_nsec =     0;
     while (1) {
@@ -1188,6 +2266,30 @@ top:
     }
   }
 
+  /*--- Token-bucket mode: go without sleep while a token is left ---*/
+  if (giBurst>0 && gi8Peritime>0) {
+    if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
+      error_exit(errno,"clock_gettime() #4: %s\n",strerror(errno));
+    }
+    limit_bucket(&tsPrev, &tsNow, gi8Peritime, giBurst);
+    tsTo = tmsp_add(tsPrev, gi8Peritime);
+    if (tmsp_cmp(&tsTo,&tsNow) > 0) {
+      /* The bucket is empty. Send the blocks so far and wait a token */
+      flush_stdout();
+      tsDiff = tmsp_add((tmsp){0,0}, tmsp_diff(&tsTo,&tsNow));
+      if (nanosleep(&tsDiff,NULL) != 0) {
+        if (errno == EINTR) {goto top;}
+        error_exit(errno,"nanosleep() #3: %s\n",strerror(errno));
+      }
+      if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
+        error_exit(errno,"clock_gettime() #5: %s\n",strerror(errno));
+      }
+      stats_slept(&tsTo,&tsNow);
+    }
+    tsPrev = tsTo;
+    return;
+  }
+
   /*--- Calculate "tsTo", the time until which I have to wait ------*/
   ui8 = (uint64_t)tsPrev.tv_nsec + gi8Peritime;
   tsTo.tv_sec  = tsPrev.tv_sec + (time_t)(ui8/1000000000);
@@ -1219,6 +2321,7 @@ top:
     } else {
       /* Otherwise, reset tsPrev by the current time */
       if (giVerbose>1) {warning("give up recovery this time\n");}
+      stats_add(ST_GIVEUPS,1);
       tsPrev.tv_sec  = tsNow.tv_sec ;
       tsPrev.tv_nsec = tsNow.tv_nsec;
     }
@@ -1234,12 +2337,14 @@ top:
     error_exit(errno,"nanosleep() #2: %s\n",strerror(errno));
   }
 
+  /*--- Count the sleep with how late I woke up --------------------*/
+  if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
+    error_exit(errno,"clock_gettime() #3: %s\n",strerror(errno));
+  }
+  stats_slept(&tsTo,&tsNow);
+
   /*--- Update the amount of threshold time for recovery -----------*/
   if (giRecovery) {
-    /* investigate the current time again */
-    if (clock_gettime(CLOCK_FOR_ME,&tsNow) != 0) {
-      error_exit(errno,"clock_gettime() #3: %s\n",strerror(errno));
-    }
     /* calculate the oversleeping time */
     if ((tsTo.tv_nsec - tsNow.tv_nsec) < 0) {
       tsDiff.tv_sec  = tsTo.tv_sec  - tsNow.tv_sec  -          1;
@@ -1281,11 +2386,70 @@ top:
   return;
 }
 
+/*=== Flush the blocks written into the stdout buffer ================
+ * In the token-bucket mode, the blocks are kept in the buffer as long
+ * as the next one is ready to read, and spend_my_spare_time() flushes
+ * them before sleeping. So a burst goes out with a single write().
+ * Otherwise, every block is flushed immediately. This function has to
+ * be called before every reading which may block.
+ * [in] fpIn : Filehandle of the current input                      */
+void flush_the_blocks(FILE *fpIn) {
+
+  /*--- Variables --------------------------------------------------*/
+  struct pollfd fdsPoll[1];
+
+  /*--- Keep the blocks if the next one has already come -----------*/
+  if (giBurst>0 && gi8Peritime>0) {
+    if (FP_HAS_RBUF(fpIn)) {return;}
+    fdsPoll[0].fd     = fileno(fpIn);
+    fdsPoll[0].events = POLLIN      ;
+    if (poll(fdsPoll,1,0) > 0) {return;}
+  }
+
+  /*--- Flush them -------------------------------------------------*/
+  if (fflush(stdout) == EOF) {
+    error_exit(errno,"fflush() in flush_the_blocks(): %s\n",strerror(errno));
+  }
+}
+
+/*=== Write all the data waiting in the stdout buffer now ============
+ * [in] gpcMapout,gsizMapout : Lines in the mmap'd input to write   */
+void flush_stdout(void) {
+
+  /*--- Variables --------------------------------------------------*/
+  ssize_t ssiz;
+
+  /*--- Flush the stdio buffer -------------------------------------*/
+  if (fflush(stdout) == EOF) {
+    error_exit(errno,"fflush() in flush_stdout(): %s\n",strerror(errno));
+  }
+
+  /*--- Write the lines in the mmap'd input ------------------------*/
+  while (gsizMapout > 0) {
+    if ((ssiz=write(STDOUT_FILENO,gpcMapout,gsizMapout)) < 0) {
+      if (errno == EINTR) {continue;}
+      /* the mmap'd input has shrunk (see pace_mmapped_lines()) */
+      if (errno == EFAULT && giMapped) {siglongjmp(gjbMapped,1);}
+      error_exit(errno,"write() in flush_stdout(): %s\n",strerror(errno));
+    }
+    gpcMapout  += ssiz;
+    gsizMapout -= (size_t)ssiz;
+  }
+}
+
 /*=== SIGNALHANDLER : Do nothing =====================================
  * This function does nothing, but it is helpful to break a thread
  * sleeping by using me as a signal handler.                        */
 void do_nothing(int iSig, siginfo_t *siInfo, void *pct) {return;}
 
+/*=== SIGNALHANDLER : Go back when the mmap'd input has shrunk =======
+ * A SIGBUS out of reading the mapping is done by the default action.*/
+void map_truncated(int iSig, siginfo_t *siInfo, void *pct) {
+  if (giMapped) {siglongjmp(gjbMapped,1);}
+  signal(iSig, SIG_DFL);
+  raise(iSig);
+}
+
 #ifdef __ANDROID__
 /*=== SIGNALHANDLER : Terminate this thread ==========================
  * This function just terminates itself.                            */
@@ -1298,10 +2462,13 @@ void term_this_thread(int iSig, siginfo_t *siInfo, void *pct) {pthread_exit(0);}
  * wake myself (the main thread) up even while sleeping with the
  * nanosleep().
  * [in]  stTh.i8Param1       : The new parameter the sub-th gave
+ *       stTh.iParam2        : The new burst depth the sub-th gave
  * [out] gi8Peritime         : The new parameter the sub-th gave
+ *       giBurst             : The new burst depth the sub-th gave
  * [out] gstThCom.iRequested : set to 1 to notify the main-th of the request */
 void recv_param_application_req(int iSig, siginfo_t *siInfo, void *pct) {
   gi8Peritime               = gstThCom.i8Param1;
+  giBurst                   = gstThCom.iParam2;
   gstThCom.iRequested__main = 1;
   return;
 }
@@ -2,8 +2,8 @@
 #
 # WAITILL - Wait till the Specified Absolute Time
 #
-# USAGE   : waitill [-lu] [-p n] abstime
-#           waitill [-lu] [-p n] -e length
+# USAGE   : waitill [-lu] [-s [-m margin]] [-r] [-p n] [-L] [-C cpu] abstime
+#           waitill [-lu] [-s [-m margin]] [-r] [-p n] [-L] [-C cpu] -e length
 # Args    : abstime ..... * Absolute time (time point) to wait till.
 #                         * This command will wait for the specified
 #                           time to arrive. And then exit.
@@ -80,7 +80,24 @@
 #                         * This option works when the abstime you gave
 #                           is a calendar time or ISO 8601 format without
 #                           a timezone.
-#           [The following option is for professional]
+#           [The following options are for professional]
+#           -s .......... * Precision mode (spin-tail)
+#                         * This command sleeps till a little before the
+#                           abstime (the margin), and then busy-waits the
+#                           rest so that it can wake up within a few
+#                           microseconds after the abstime.
+#                         * It burns the CPU during the margin, so it
+#                           works best with the -p option.
+#           -m margin ... * Margin for the -s option in seconds
+#                         * The format is "n[.d]" as well as "length."
+#                         * If you omit this option, the margin will be
+#                           calibrated automatically by measuring how
+#                           late this process wakes up from short sleeps
+#                           with the current priority.
+#           -r .......... * Report the achieved lateness
+#                         * After waking up, this command prints the
+#                           time it was late from the abstime in seconds
+#                           as "lateness +n.ddddddddd."
 #           -p n ........ Process priority setting [0-3] (if possible)
 #                          0: Normal process
 #                          1: Weakest realtime process (default)
@@ -89,6 +106,14 @@
 #                          3: Strongest realtime process of this host
 #                         Larger numbers maybe require a privileged user,
 #                         but if failed, it will try the smaller numbers.
+#           -L .......... Lock the memory of this command into the RAM
+#                         after pre-faulting the stack, so that no page
+#                         fault delays it in the realtime mode. A large
+#                         enough "ulimit -l" or a privileged user might
+#                         be required.
+#           -C cpu ...... Run this command only on the CPU #cpu (from 0)
+#                         to avoid the migration between CPUs. (for only
+#                         Linux) An isolated CPU gives the best result.
 # Env-vars: WT_EPOCH .... * Absolute time for the "epoch mode" (See the
 #                           modes section for details)
 #                         * The formats for the time you can use are
@@ -147,7 +172,7 @@
 #                  (if it doesn't work)
 # How to compile : cc -O3 -o __CMDNAME__ __SRCNAME__ -lrt
 #
-# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2025-06-05
+# Written by Shell-Shoccar Japan (@shellshoccarjpn) on 2026-10-18
 #
 # This is a public-domain software (CC0). It means that all of the
 # people can use this for any purposes with no restrictions at all.
@@ -169,8 +194,7 @@
 
 /*--- headers ------------------------------------------------------*/
 #if defined(__linux) || defined(__linux__)
-  /* This definition is for strptime() on Linux */
-  #define _XOPEN_SOURCE 700
+  #define _GNU_SOURCE /* for sched_setaffinity() */
 #endif
 #include <errno.h>
 #include <inttypes.h>
@@ -185,9 +209,16 @@
   #include <sched.h>
   #include <sys/resource.h>
 #endif
+#include "timeio.h"
+#include "rtmem.h"
 
 /*--- macro constants ----------------------------------------------*/
 #define ENV_NAME "WT_EPOCH"
+/* Parameters for calibrating the margin of the precision mode (-s) */
+#define CALIB_TIMES   8         /* number of trial sleeps             */
+#define CALIB_NSEC    1000000L  /* length of each trial sleep (1ms)   */
+#define MARGIN_MIN    20000L    /* lower limit of the margin (20us)   */
+#define MARGIN_MAX    10000000L /* upper limit of the margin (10ms)   */
 
 /*--- data type definitions ----------------------------------------*/
 typedef struct timespec tmsp;
@@ -195,10 +226,10 @@ typedef struct timespec tmsp;
 /*--- prototype functions ------------------------------------------*/
 void parse_abstime_env(char* pszTime, tmsp *ptsTime);
 void parse_abstime(char* pszTime, tmsp *ptsTime);
-int  parse_calendartime(char* pszTime, tmsp *ptsTime);
-int  parse_unixtime(char* pszTime, tmsp *ptsTime);
-int  parse_iso8601time(char* pszTime, tmsp *ptsTime);
 int  change_to_rtprocess(int iPrio);
+void calibrate_margin(tmsp *ptsMargin);
+void sleep_till(tmsp *ptsTo);
+void spin_till(tmsp *ptsTo);
 
 /*--- global variables ---------------------------------------------*/
 char* gpszCmdname;  /* The name of this command                    */
@@ -210,11 +241,11 @@ int   giVerbose;    /* speaks more verbosely by the greater number */
 void print_usage_and_exit(void) {
   fprintf(stderr,
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
-    "USAGE   : %s [-lu] [-p n] abstime\n"
-    "          %s [-lu] [-p n] -e length\n"
+    "USAGE   : %s [-lu] [-s [-m margin]] [-r] [-p n] [-L] [-C cpu] abstime\n"
+    "          %s [-lu] [-s [-m margin]] [-r] [-p n] [-L] [-C cpu] -e length\n"
 #else
-    "USAGE   : %s [-lu] abstime\n"
-    "          %s [-lu] -e length\n"
+    "USAGE   : %s [-lu] [-s [-m margin]] [-r] abstime\n"
+    "          %s [-lu] [-s [-m margin]] [-r] -e length\n"
 #endif
     "Args    : abstime ..... * Absolute time (time point) to wait till.\n"
     "                        * This command will wait for the specified\n"
@@ -292,8 +323,25 @@ void print_usage_and_exit(void) {
     "                        * This option works when the abstime you gave\n"
     "                          is a calendar time or ISO 8601 format without\n"
     "                          a timezone.\n"
+    "          [The following options are for professional]\n"
+    "          -s .......... * Precision mode (spin-tail)\n"
+    "                        * This command sleeps till a little before the\n"
+    "                          abstime (the margin), and then busy-waits the\n"
+    "                          rest so that it can wake up within a few\n"
+    "                          microseconds after the abstime.\n"
+    "                        * It burns the CPU during the margin, so it\n"
+    "                          works best with the -p option.\n"
+    "          -m margin ... * Margin for the -s option in seconds\n"
+    "                        * The format is \"n[.d]\" as well as \"length.\"\n"
+    "                        * If you omit this option, the margin will be\n"
+    "                          calibrated automatically by measuring how\n"
+    "                          late this process wakes up from short sleeps\n"
+    "                          with the current priority.\n"
+    "          -r .......... * Report the achieved lateness\n"
+    "                        * After waking up, this command prints the\n"
+    "                          time it was late from the abstime in seconds\n"
+    "                          as \"lateness +n.ddddddddd.\"\n"
 #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
-    "          [The following option is for professional]\n"
     "          -p n ........ Process priority setting [0-3] (if possible)\n"
     "                         0: Normal process\n"
     "                         1: Weakest realtime process (default)\n"
@@ -302,6 +350,14 @@ void print_usage_and_exit(void) {
     "                         3: Strongest realtime process of this host\n"
     "                        Larger numbers maybe require a privileged user,\n"
     "                        but if failed, it will try the smaller numbers.\n"
+    "          -L .......... Lock the memory of this command into the RAM\n"
+    "                        after pre-faulting the stack, so that no page\n"
+    "                        fault delays it in the realtime mode. A large\n"
+    "                        enough \"ulimit -l\" or a privileged user might\n"
+    "                        be required.\n"
+    "          -C cpu ...... Run this command only on the CPU #cpu (from 0)\n"
+    "                        to avoid the migration between CPUs. (for only\n"
+    "                        Linux) An isolated CPU gives the best result.\n"
 #endif
     "Env-vars: WT_EPOCH .... * Reference time for the \"epoch mode\" (See the\n"
     "                          modes section for details)\n"
@@ -352,7 +408,7 @@ void print_usage_and_exit(void) {
     "                 time of the wait as a time relative to another time,\n"
     "                 and gives your program a simpler look.\n"
     "Return  : Return 0 only when finished successfully\n"
-    "Version : 2025-06-05 14:48:04 JST\n"
+    "Version : 2026-10-18 23:03:18 JST\n"
     "          (POSIX C language)\n"
     "\n"
     "Shell-Shoccar Japan (@shellshoccarjpn), No rights reserved.\n"
@@ -395,11 +451,15 @@ int main(int argc, char *argv[]) {
 /*--- Variables ----------------------------------------------------*/
 int        iOpt_e;     /* -e option flag                            */
 int        iOpt_l;     /* -l option flag                            */
+int        iOpt_s;     /* -s option flag                            */
+int        iOpt_r;     /* -r option flag                            */
 int        iPrio;      /* -p option number (default 1)              */
+int        iCpu;       /* -C option number (-1:not pinned)          */
+int        iMlock;     /* 1 if -L option is given                   */
 tmsp       tsAbstime;  /* Parsed abstime                            */
-#ifndef CLOCK_NANOSLEEP_SUPPORT
+tmsp       tsMargin;   /* Margin for -s (tv_sec<0 means "calibrate")*/
+tmsp       tsWake;     /* The time to wake up in the -s mode        */
 tmsp       tsNow;      /* Current time                              */
-#endif
 tmsp       tsLength;   /* Length of time from the abstime Length of time from the abstime           */
 struct tm* ptmAbstime; /* Parsed abstime                            */
 char       szTmz[7];   /* timezone string                           */
@@ -420,16 +480,30 @@ setlocale(LC_CTYPE, "");
 /*--- Set default parameters of the arguments ----------------------*/
 iOpt_e=0;
 iOpt_l=0;
+iOpt_s=0;
+iOpt_r=0;
 iPrio =1;
+iCpu  =-1;
+iMlock=0;
+tsMargin.tv_sec=-1; tsMargin.tv_nsec=0;
 /*--- Parse options which start by "-" -----------------------------*/
-while ((i=getopt(argc, argv, "elup:vh")) != -1) {
+while ((i=getopt(argc, argv, "elum:rsp:LC:vh")) != -1) {
   switch (i) {
     case 'e': iOpt_e=1;                     break;
     case 'l': iOpt_l=1;                     break;
     case 'u': (void)setenv("TZ", "UTC", 1); break;
+    case 'm': if (optarg[0]=='+' || optarg[0]=='-'   ) {print_usage_and_exit();}
+              if (! parse_unixtime(optarg, &tsMargin)) {print_usage_and_exit();}
+                                            break;
+    case 'r': iOpt_r=1;                     break;
+    case 's': iOpt_s=1;                     break;
     #if defined(_POSIX_PRIORITY_SCHEDULING) && !defined(__OpenBSD__) && !defined(__APPLE__)
       case 'p': if (sscanf(optarg,"%d",&iPrio) != 1) {print_usage_and_exit();}
                                               break;
+      case 'L': iMlock=1;                     break;
+      case 'C': if (sscanf(optarg,"%d",&iCpu) != 1) {print_usage_and_exit();}
+                if (iCpu < 0                       ) {print_usage_and_exit();}
+                                              break;
     #endif
     case 'v': giVerbose++;                  break;
     case 'h': print_usage_and_exit();
@@ -486,21 +560,45 @@ if (iOpt_l) {
 
 /*=== Wait for the abstime to arrive ===============================*/
 if (change_to_rtprocess(iPrio)==-1) {print_usage_and_exit();}
-#ifdef CLOCK_NANOSLEEP_SUPPORT
-clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &tsAbstime, NULL);
-#else
-if (clock_gettime(CLOCK_REALTIME, &tsNow) != 0) {
-  error_exit(errno, "clock_gettime() failed at %d\n", __LINE__);
+if (iCpu >= 0) {rtmem_pin_cpu(iCpu);}
+if (iMlock   ) {rtmem_lock();       }
+if (iOpt_s==0) {
+  sleep_till(&tsAbstime);
+} else         {
+  /* The margin has to be calibrated after changing the priority
+     because the wakeup latency depends on it.                    */
+  if (tsMargin.tv_sec < 0) {calibrate_margin(&tsMargin);}
+  if (giVerbose>0) {
+    warning("margin for the spin-tail: %jd.%09ld\n",
+            (intmax_t)tsMargin.tv_sec, tsMargin.tv_nsec);
+  }
+  tsWake.tv_sec  = tsAbstime.tv_sec  - tsMargin.tv_sec ;
+  tsWake.tv_nsec = tsAbstime.tv_nsec - tsMargin.tv_nsec;
+  if (tsWake.tv_nsec<0) {tsWake.tv_nsec+=1000000000L; tsWake.tv_sec--;}
+  sleep_till(&tsWake   );
+  spin_till( &tsAbstime);
 }
-tsLength.tv_sec  = tsAbstime.tv_sec  - tsNow.tv_sec ;
-tsLength.tv_nsec = tsAbstime.tv_nsec - tsNow.tv_nsec;
-if (tsLength.tv_nsec<0) {tsLength.tv_nsec+=1000000000L; tsLength.tv_sec--;}
-if (nanosleep(&tsLength, NULL) != 0) {
-  if (errno != EINVAL) {
-    error_exit(errno, "nanosleep() failed at %d\n", __LINE__);
+
+/*=== Report the lateness (only when -r is set) ====================*/
+if (iOpt_r) {
+  if (clock_gettime(CLOCK_REALTIME, &tsNow) != 0) {
+    error_exit(errno, "clock_gettime() failed at %d\n", __LINE__);
+  }
+  tsLength.tv_sec  = tsNow.tv_sec  - tsAbstime.tv_sec ;
+  tsLength.tv_nsec = tsNow.tv_nsec - tsAbstime.tv_nsec;
+  if (tsLength.tv_nsec<0) {tsLength.tv_nsec+=1000000000L; tsLength.tv_sec--;}
+  if (tsLength.tv_sec >= 0) {
+    printf("lateness +%jd.%09ld\n",
+           (intmax_t)tsLength.tv_sec, tsLength.tv_nsec);
+  } else {
+    /* woke up too early (e.g. the clock was set back while sleeping) */
+    if (tsLength.tv_nsec>0) {
+      tsLength.tv_nsec = 1000000000L - tsLength.tv_nsec; tsLength.tv_sec++;
+    }
+    printf("lateness -%jd.%09ld\n",
+           (intmax_t)(-tsLength.tv_sec), tsLength.tv_nsec);
   }
 }
-#endif
 
 /*=== Finish normally ==============================================*/
 return 0;}
@@ -873,313 +971,6 @@ void parse_abstime(char* pszTime, tmsp *ptsTime) {
   }
 }
 
-/*=== Parse a local calendar time ====================================
- * [in]  pszTime : calendar-time string in the localtime
- *                 (/[0-9]{11,20}(\.[0-9]{1,9})?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_calendartime(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szDate[21], szNsec[10], szDate2[26];
-  int  i, j, k;            /* +-- 0:(reading integer part)          */
-  char c;                  /* +-- 1:finish reading without_decimals */
-  int  iStatus = 0; /* <--------- 2:to_be_started reading decimals  */
-  struct tm tmDate;
-
-  /*--- Separate pszTime into date and nanoseconds -----------------*/
-  for (i=0; i<20; i++) {
-    c = pszTime[i];
-    if      ('0'<=c && c<='9'         ) {szDate[i]=c;                       }
-    else if (c=='.'                   ) {szDate[i]=0; iStatus=2; i++; break;}
-    else if (c==0 || c=='\t' || c==' ') {szDate[i]=0; iStatus=1;      break;}
-    else                           {if (giVerbose>0) {
-                                      warning("%c: Unexpected chr. in "
-                                              "the integer part\n",c);
-                                    }
-                                    return 0;
-                                   }
-  }
-  if ((iStatus==0) && (i==20)) {
-    switch (pszTime[20]) {
-      case '.': szDate[20]=0; iStatus=2; i++; break;
-      case  0 : szDate[20]=0; iStatus=1;      break;
-      default : warning("The integer part of the timestamp is too big "
-                        "as a calendar-time\n",c);
-                return 0;
-    }
-  }
-  switch (iStatus) {
-    case 1 : strcpy(szNsec,"000000000");
-             break;
-    case 2 : j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      ('0'<=c && c<='9'         ) {szNsec[k]=c; k++;}
-               else if (c==0 || c=='\t' || c==' ') {break;           }
-               else                           {
-                 if (giVerbose>0) {
-                   warning("%c: Unexpected chr. in the decimal part\n",c);
-                 }
-                 return 0;
-               }
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    default: warning("Unexpected error in parse_calendartime(), "
-                     "maybe a bug?\n");
-             return 0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  i = strlen(szDate)-10;
-  if (i<=0) {return 0;}
-  k =0; for (j=0; j<i; j++) {szDate2[k]=szDate[j];k++;} /* Y */
-  szDate2[k]='-'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* m */
-  szDate2[k]='-'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* d */
-  szDate2[k]='T'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* H */
-  szDate2[k]=':'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* M */
-  szDate2[k]=':'; k++;
-  i+=2; for (   ; j<i; j++) {szDate2[k]=szDate[j];k++;} /* S */
-  szDate2[k]=  0;
-  memset(&tmDate, 0, sizeof(tmDate));
-  if(! strptime(szDate2, "%Y-%m-%dT%H:%M:%S", &tmDate)) {
-    if (giVerbose>1) {
-      warning("Unexpect error at strptime() in parse_calendartime()\n");
-    }
-    return 0;
-  }
-  errno=0;
-  ptsTime->tv_sec  = mktime(&tmDate);
-  if (errno) {
-    if (giVerbose>1) {
-      warning("%s: Invalid calendartime string: %s\n", pszTime,strerror(errno));
-    }
-    return 0;
-  }
-  ptsTime->tv_nsec = atol(szNsec);
-
-  return 1;
-}
-
-/*=== Parse a UNIX-time ==============================================
- * [in]  pszTime : UNIX-time string (/[0-9]{1,19}(\.[0-9]{1,9})?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_unixtime(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szSec[21], szNsec[10];
-  int  i, j, k;            /* +-- 0:(reading integer part)          */
-  char c;                  /* +-- 1:finish reading without_decimals */
-  int  iStatus = 0; /* <--------- 2:to_be_started reading decimals  */
-
-  /*--- Separate pszTime into seconds and nanoseconds --------------*/
-  i=0; j=19;
-  if (pszTime[i]=='+'||pszTime[i]=='-') {szSec[i]=pszTime[i];i++;j++;}
-  for (   ; i<j; i++) {
-    c = pszTime[i];
-    if      ('0'<=c && c<='9'         ) {szSec[i]=c;                       }
-    else if (c=='.'                   ) {szSec[i]=0; iStatus=2; i++; break;}
-    else if (c==0 || c=='\t' || c==' ') {szSec[i]=0; iStatus=1;      break;}
-    else                           {if (giVerbose>0) {
-                                      warning("%c: Unexpected chr. in "
-                                              "the integer part\n",c);
-                                    }
-                                    return 0;
-                                   }
-  }
-  if ((iStatus==0) && (i==j)) {
-    switch (pszTime[j]) {
-      case '.': szSec[j]=0; iStatus=2; i++; break;
-      case  0 : szSec[j]=0; iStatus=1;      break;
-      default : warning("The integer part of the timestamp is too big "
-                        "as a UNIX-time\n");
-                return 0;
-    }
-  }
-  switch (iStatus) {
-    case 1 : strcpy(szNsec,"000000000");
-             break;
-    case 2 : j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      ('0'<=c && c<='9'         ) {szNsec[k]=c; k++;}
-               else if (c==0 || c=='\t' || c==' ') {break;           }
-               else                           {
-                 if (giVerbose>0) {
-                   warning("%c: Unexpected chr. in the decimal part\n",c);
-                 }
-                 return 0;
-               }
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    default: warning("Unexpected error in parse_unixtime(), maybe a bug?\n");
-             return 0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  ptsTime->tv_sec  = (time_t)atoll(szSec);
-  ptsTime->tv_nsec =         atol(szNsec);
-
-  return 1;
-}
-
-/*=== Parse an extended ISO 8601 time ================================
- * [in]  pszTime : ISO 8601 (ext.) string in the localtime
-   (/[0-9]{1,10}-[0-9]{2}-[0-9]{2}T[0-9]{2}:[0-9]{2}:[0-9]{2}([,.][0-9]{1,9})?([+-][0-9]{2}:?[0-9]{2}|Z)?/)
- *       ptsTime : To be set the parsed time ("timespec" structure)
- * [ret] > 0 : success
- *       ==0 : error (failure to parse)                             */
-int parse_iso8601time(char* pszTime, tmsp *ptsTime) {
-
-  /*--- Variables --------------------------------------------------*/
-  char szDate[26], szNsec[10];
-  int  iTZoffs;            /* +-- 0:now reading integer part or invalid string*/
-  int  i, j, k;            /* +-- 1:to_be_started reading decimals  */
-  char c;                  /* +-- 2:to_be_started reading timezone  */
-  int  iStatus = 0; /* <--------- 3:finished reading                */
-  struct tm tmDate;
-
-  /*--- Read the string (integer part) -----------------------------*/
-  iStatus=0;
-  while (1) {
-    i=0;
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* Y     */
-    while ('0'<=pszTime[i] && pszTime[i]<='9' && i<10 ) {i++;} /* Y{,9} */
-    if (pszTime[i] != '-'               ) {break;} else {i++;} /* -     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* M     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* M     */
-    if (pszTime[i] != '-'               ) {break;} else {i++;} /* -     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* D     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* D     */
-    if (pszTime[i] != 'T'               ) {break;} else {i++;} /* T     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* h     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* h     */
-    if (pszTime[i] != ':'               ) {break;} else {i++;} /* :     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* m     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* m     */
-    if (pszTime[i] != ':'               ) {break;} else {i++;} /* :     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* s     */
-    if (pszTime[i]<'0' || '9'<pszTime[i]) {break;} else {i++;} /* s     */
-    switch (pszTime[i]) {
-      case ',' :
-      case '.' : iStatus = 1; break;
-      case 'Z' :
-      case '+' :
-      case '-' : iStatus = 2; break;
-      case 0   :
-      case ' ' :
-      case '\t': iStatus = 3; break;
-      default  : break;
-    }
-    break;
-  }
-  if (iStatus==0) {
-    if (giVerbose>0) {warning("%s: Invalid ISO 8601 string\n",pszTime);}
-    return 0;
-  }
-  memcpy(szDate, pszTime, i); szDate[i]=0;
-
-  /*--- Read the string (decimal part) -----------------------------*/
-  switch (iStatus) {
-    case 1 : i++;
-             j=i+9;
-             k=0;
-             for (; i<j; i++) {
-               c = pszTime[i];
-               if      ('0'<=c  && c<='9'          ) {szNsec[k]=c; k++;}
-               else if (c=='+'  || c=='-' || c=='Z') {iStatus=2; break;}
-               else if (c=='\t' || c==' ' || c==0  ) {iStatus=3; break;}
-               else                                  {
-                 if (giVerbose>0) {
-                   warning("%s: Invalid ISO 8601 string (decimal part)\n",
-                           pszTime                                        );
-                 }
-                 return 0;
-               }
-             }
-             if (i==j) {
-               c = pszTime[i];
-               if (c=='+'  || c=='-'        ) {iStatus=2; break;}
-               if (c=='\t' || c==' ' || c==0) {iStatus=3; break;}
-             }
-             for (; k<9; k++) {szNsec[k]='0';}
-             szNsec[9]=0;
-             break;
-    case 2 :
-    case 3 : strcpy(szNsec,"000000000");
-             break;
-  }
-
-  /*--- Read the string (timezone part) ----------------------------*/
-  if (iStatus==2) {
-    k=0;
-    while (k==0) {
-      iTZoffs  = 0;
-      if (pszTime[i]=='Z') {j=1; k=1; break;}                    /* Z    */
-      j = (pszTime[i]=='+') ? 1 : -1; i++;                       /* [+-] */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')*36000; i++;                    /* h    */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')* 3600; i++;                    /* h    */
-      if (pszTime[i]==':'                 ) {i++;  }             /* :    */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')*  600; i++;                    /* m    */
-      if (pszTime[i]<'0' || '9'<pszTime[i]) {break;}
-      iTZoffs += (pszTime[i]-'0')*   60; i++;                    /* m    */
-      if (pszTime[i]!=' ' && pszTime[i]!='\t' && pszTime[i]!=0) {break;}
-      iTZoffs *= j;
-      k=1;
-    }
-    if (k==0) {
-      if (iStatus==0) {
-        warning("%s: Invalid ISO 8601 string (timezone part)\n",
-                pszTime                                         );
-        return 0;
-      }
-    }
-  } else          {
-    j=0;
-  }
-
-  /*--- Pack the time-string into the timespec structure -----------*/
-  if (! strptime(szDate, "%Y-%m-%dT%H:%M:%S", &tmDate)) {
-    if (giVerbose>1) {
-      warning("Unexpect error at strptime() #1 in parse_iso8601time()\n");
-    }
-    return 0;
-  }
-  errno=0;
-  ptsTime->tv_sec  = mktime(&tmDate);
-  if (errno) {
-    if (giVerbose>1) {
-      warning("%s: Invalid ISO 8601 string: %s\n", pszTime, strerror(errno));
-    }
-    return 0;
-  }
-  ptsTime->tv_nsec = atol(szNsec);
-  if (j!=0) {
-    i = (int)difftime(mktime(localtime((time_t[]){0})),
-                      mktime(   gmtime((time_t[]){0})) );
-    ptsTime->tv_sec = ptsTime->tv_sec + i - iTZoffs;
-  }
-
-  return 1;
-}
-
-
 /*=== Try to make me a realtime process ==============================
  * [in]  iPrio : 0:will not change (just return normally)
  *               1:minimum priority
@@ -1247,3 +1038,97 @@ int change_to_rtprocess(int iPrio) {
   /*--- Return successfully ----------------------------------------*/
   return 0;
 }
+
+/*=== Calibrate the margin for the spin-tail =========================
+ * This function sleeps for CALIB_NSEC several times and measures how
+ * late the process wakes up with the current priority. The margin is
+ * the twice of the worst lateness, and limited between MARGIN_MIN and
+ * MARGIN_MAX.
+ * [out] ptsMargin : calibrated margin
+ * [ret] Return only when success (exit when some error occurs)     */
+void calibrate_margin(tmsp *ptsMargin) {
+
+  /*--- Variables --------------------------------------------------*/
+  tmsp    tsBefore;  /* the time before a trial sleep              */
+  tmsp    tsAfter;   /* the time after a trial sleep               */
+  tmsp    tsTrial;   /* length of a trial sleep                    */
+  int64_t i8Late;    /* lateness of a trial sleep in nanoseconds   */
+  int64_t i8Worst;   /* the worst lateness in nanoseconds          */
+  int     i;         /* all-purpose int                            */
+
+  /*--- Measure the lateness ---------------------------------------*/
+  tsTrial.tv_sec  = 0;
+  tsTrial.tv_nsec = CALIB_NSEC;
+  i8Worst         = 0;
+  for (i=0; i<CALIB_TIMES; i++) {
+    if (clock_gettime(CLOCK_REALTIME, &tsBefore) != 0) {
+      error_exit(errno, "clock_gettime() failed at %d\n", __LINE__);
+    }
+    if (nanosleep(&tsTrial, NULL) != 0) {
+      error_exit(errno, "nanosleep() failed at %d\n", __LINE__);
+    }
+    if (clock_gettime(CLOCK_REALTIME, &tsAfter ) != 0) {
+      error_exit(errno, "clock_gettime() failed at %d\n", __LINE__);
+    }
+    i8Late = ((int64_t)tsAfter.tv_sec  - (int64_t)tsBefore.tv_sec)*1000000000
+           + ((int64_t)tsAfter.tv_nsec - (int64_t)tsBefore.tv_nsec)
+           - CALIB_NSEC;
+    if (giVerbose>1) {warning("calibration #%d: %" PRId64 " ns\n",i,i8Late);}
+    if (i8Late > i8Worst) {i8Worst=i8Late;}
+  }
+
+  /*--- Decide the margin ------------------------------------------*/
+  i8Worst *= 2;
+  if (i8Worst < MARGIN_MIN) {i8Worst=MARGIN_MIN;}
+  if (i8Worst > MARGIN_MAX) {i8Worst=MARGIN_MAX;}
+  ptsMargin->tv_sec  = (time_t)(i8Worst/1000000000);
+  ptsMargin->tv_nsec = (long  )(i8Worst%1000000000);
+  return;
+}
+
+/*=== Sleep till the specified time ==================================
+ * [in]  ptsTo : The absolute time (CLOCK_REALTIME) to sleep till
+ * [ret] Return only when success (exit when some error occurs)     */
+void sleep_till(tmsp *ptsTo) {
+
+#ifdef CLOCK_NANOSLEEP_SUPPORT
+  clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, ptsTo, NULL);
+#else
+  /*--- Variables --------------------------------------------------*/
+  tmsp tsNow;    /* current time                                    */
+  tmsp tsLength; /* length of time to sleep                         */
+
+  /*--- Sleep ------------------------------------------------------*/
+  if (clock_gettime(CLOCK_REALTIME, &tsNow) != 0) {
+    error_exit(errno, "clock_gettime() failed at %d\n", __LINE__);
+  }
+  tsLength.tv_sec  = ptsTo->tv_sec  - tsNow.tv_sec ;
+  tsLength.tv_nsec = ptsTo->tv_nsec - tsNow.tv_nsec;
+  if (tsLength.tv_nsec<0) {tsLength.tv_nsec+=1000000000L; tsLength.tv_sec--;}
+  if (nanosleep(&tsLength, NULL) != 0) {
+    if (errno != EINVAL) {
+      error_exit(errno, "nanosleep() failed at %d\n", __LINE__);
+    }
+  }
+#endif
+  return;
+}
+
+/*=== Busy-wait till the specified time ==============================
+ * [in]  ptsTo : The absolute time (CLOCK_REALTIME) to wait till
+ * [ret] Return only when success (exit when some error occurs)     */
+void spin_till(tmsp *ptsTo) {
+
+  /*--- Variables --------------------------------------------------*/
+  tmsp tsNow;    /* current time                                    */
+
+  /*--- Spin -------------------------------------------------------*/
+  while (1) {
+    if (clock_gettime(CLOCK_REALTIME, &tsNow) != 0) {
+      error_exit(errno, "clock_gettime() failed at %d\n", __LINE__);
+    }
+    if (tsNow.tv_sec  > ptsTo->tv_sec                                   ) {break;}
+    if (tsNow.tv_sec == ptsTo->tv_sec && tsNow.tv_nsec >= ptsTo->tv_nsec) {break;}
+  }
+  return;
+}